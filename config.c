@@ -115,6 +115,7 @@ void initModules(void)
 	chsnprintf(config[5].name, 13, "IMG 2GFSK 2m");			// Instance name
 	config[5].power = 20;									// Power 20 dBm
 	config[5].protocol = PROT_APRS_2GFSK;					// Protocol APRS SSDV, modulation 2GFSK
+	config[5].gfsk_config.speed = 9600;						// 2GFSK data rate 9600 bps (19200 and 38400 possible)
 	config[5].frequency.type = FREQ_STATIC;					// Static frequency allocation
 	config[5].frequency.hz = 144860000;						// Transmission frequency 144.860 MHz
 	config[5].frequency.method = APRS_REGION_FREQ_2M;		// Determine local APRS frequency on 2m
@@ -130,6 +131,7 @@ void initModules(void)
 	config[5].ssdv_config.ram_buffer = ssdv2_buffer;		// Camera buffer
 	config[5].ssdv_config.ram_size = sizeof(ssdv2_buffer);	// Buffer size
 	config[5].ssdv_config.res = RES_XGA;					// Resolution XGA
+	config[5].ssdv_config.stream = true;					// Encode while capturing
 	MODULE_IMAGE(&config[5]);
 
 	// Module IMAGE, SSDV 2m 2FSK
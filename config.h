@@ -22,6 +22,8 @@ extern module_conf_t config[9];
 #define TRACE_TIME				TRUE			/* Enables time tracing on serial connection */
 #define TRACE_FILE				TRUE			/* Enables file and line tracing on serial connection */
 
+#define SSDV_CRC_HW				TRUE			/* Calculates the SSDV packet CRC in the STM32 CRC unit */
+
 void initModules(void);
 
 #endif
@@ -0,0 +1,260 @@
+# Geofence compiler. Compiles the region definitions (GeoJSON) into the region
+# tables of the software (math/geofence_data.h, math/geofence_data.c):
+#  - Polygons simplified by Douglas-Peucker within the tolerance
+#  - Vertices as int16 lat/lon differences in GEOFENCE_UNIT (long edges split)
+#  - Bounding boxes of the polygons
+#  - Region grid (nibbles), cells touched by a polygon edge marked as edge cells
+#
+# Each feature needs a "region" property, a "name" property is optional. The
+# "layer" property (default "aprs") puts regions which overlap the regions of
+# other layers (e.g. ITU regions) into a separate layer with its own polygons
+# and grid, a location has one region per layer. Within a layer, features
+# further down take precedence where regions overlap. Only the outer ring of a
+# polygon is used.
+#
+# Usage: python3 compile.py [-t tolerance] [regions.geojson] [output directory]
+
+import argparse
+import json
+import math
+import random
+import re
+import sys
+
+CELL = 50000000		# Grid cell size in deg*10000000 (5 deg)
+UNIT = 10000		# Vertex resolution in deg*10000000 (0.001 deg)
+EDGE = 0xF			# Grid cell touched by a polygon edge
+ROWS = 1800000000 // CELL
+COLS = 3600000000 // CELL
+DELTA_MAX = 32767
+
+parser = argparse.ArgumentParser(description='Compiles GeoJSON regions into the geofence tables')
+parser.add_argument('-t', '--tolerance', type=float, default=0.01, help='Simplification tolerance in deg (default 0.01)')
+parser.add_argument('geojson', nargs='?', default='regions.geojson')
+parser.add_argument('output', nargs='?', default='../../math')
+args = parser.parse_args()
+
+# Parse
+print('Parsing %s' % args.geojson)
+with open(args.geojson, 'r') as f:
+	collection = json.load(f)
+
+regions = ['other']
+names = {'other': 'Rest of the world'}
+layers = [] # Layer names
+layer_regions = {} # Regions of a layer, 'other' first (grid cell values)
+layer_rings = {} # (region, original vertices [(lat, lon)]) of a layer
+for feature in collection['features']:
+	layer = re.sub('[^a-z0-9]', '_', feature['properties'].get('layer', 'aprs').lower())
+	if layer not in layers:
+		layers.append(layer)
+		layer_regions[layer] = ['other']
+		layer_rings[layer] = []
+	rings = layer_rings[layer]
+
+	region = re.sub('[^a-z0-9]', '_', feature['properties']['region'].lower())
+	if region not in regions:
+		regions.append(region)
+		names[region] = feature['properties'].get('name', region.title())
+	if region not in layer_regions[layer]:
+		layer_regions[layer].append(region)
+
+	geometry = feature['geometry']
+	if geometry['type'] == 'Polygon':
+		polygons = [geometry['coordinates']]
+	elif geometry['type'] == 'MultiPolygon':
+		polygons = geometry['coordinates']
+	else:
+		sys.exit('Unsupported geometry %s of region %s' % (geometry['type'], region))
+
+	for polygon in polygons:
+		if len(polygon) > 1:
+			print('> %s: holes ignored' % region)
+		ring = [(int(round(lat * 10000000)), int(round(lon * 10000000))) for lon, lat in polygon[0]]
+		if ring[0] == ring[-1]:
+			ring.pop()
+		rings.append((region, ring))
+
+for layer in layers:
+	if len(layer_regions[layer]) > EDGE:
+		sys.exit('Too many regions in layer %s (%d), the grid keeps %d' % (layer, len(layer_regions[layer]), EDGE))
+
+def distance(p, a, b):
+	dlat, dlon = b[0] - a[0], b[1] - a[1]
+	if not dlat and not dlon:
+		return math.hypot(p[0] - a[0], p[1] - a[1])
+	return abs(dlat * (p[1] - a[1]) - dlon * (p[0] - a[0])) / math.hypot(dlat, dlon)
+
+def douglasPeucker(points, tolerance):
+	keep = [False] * len(points)
+	keep[0] = keep[-1] = True
+	stack = [(0, len(points) - 1)]
+	while stack:
+		first, last = stack.pop()
+		index, dmax = None, tolerance
+		for i in range(first + 1, last):
+			d = distance(points[i], points[first], points[last])
+			if d > dmax:
+				index, dmax = i, d
+		if index is not None:
+			keep[index] = True
+			stack += [(first, index), (index, last)]
+	return [p for p, k in zip(points, keep) if k]
+
+def simplify(ring, tolerance):
+	# Closed ring split at the vertex farthest from the first one
+	far = max(range(len(ring)), key=lambda i: math.hypot(ring[i][0] - ring[0][0], ring[i][1] - ring[0][1]))
+	ring = douglasPeucker(ring[:far + 1], tolerance)[:-1] + douglasPeucker(ring[far:] + [ring[0]], tolerance)[:-1]
+
+	# Vertices quantized to the unit, long edges split
+	ring = [(int(round(lat / UNIT)) * UNIT, int(round(lon / UNIT)) * UNIT) for lat, lon in ring]
+	out = []
+	for i in range(len(ring)):
+		a, b = ring[i], ring[(i + 1) % len(ring)]
+		n = max(1, -(-max(abs(b[0] - a[0]), abs(b[1] - a[1])) // (UNIT * (DELTA_MAX - 1))))
+		for k in range(n):
+			v = (a[0] + int(round((b[0] - a[0]) * k / n / UNIT)) * UNIT, a[1] + int(round((b[1] - a[1]) * k / n / UNIT)) * UNIT)
+			if not out or out[-1] != v:
+				out.append(v)
+	while len(out) > 1 and out[-1] == out[0]:
+		out.pop()
+	return out
+
+# Same arithmetic as isPointInPolygon() (exact)
+def inPolygon(ring, lat, lon):
+	c = False
+	for i in range(len(ring)):
+		a, b = ring[i], ring[(i + 1) % len(ring)]
+		if (a[0] <= lat) != (b[0] <= lat):
+			dlat = b[0] - a[0]
+			left = (lon - a[1]) * dlat
+			right = (b[1] - a[1]) * (lat - a[0])
+			if left < right if dlat > 0 else left > right:
+				c = not c
+	return c
+
+def getRegion(rings, lat, lon):
+	for region, ring in reversed(rings):
+		if inPolygon(ring, lat, lon):
+			return region
+	return 'other'
+
+def row(lat):
+	return min((lat + 900000000) // CELL, ROWS - 1)
+def col(lon):
+	return min((lon + 1800000000) // CELL, COLS - 1)
+
+def compile(layer):
+	rings = layer_rings[layer]
+
+	# Simplify
+	print('Simplify layer %s (tolerance %.4f deg)' % (layer, args.tolerance))
+	compiled = []
+	for region, ring in rings:
+		simplified = simplify(ring, args.tolerance * 10000000)
+		if len(simplified) < 3:
+			sys.exit('Polygon of region %s vanishes at this tolerance' % region)
+		print('> %-16s %4d -> %4d vertices' % (region, len(ring), len(simplified)))
+		compiled.append((region, simplified))
+
+	# Grid
+	grid = [[None] * COLS for r in range(ROWS)]
+	for region, ring in compiled:
+		for i in range(len(ring)):
+			a, b = ring[i], ring[(i + 1) % len(ring)]
+			for r in range(row(min(a[0], b[0])), row(max(a[0], b[0])) + 1):
+				for c in range(col(min(a[1], b[1])), col(max(a[1], b[1])) + 1):
+					grid[r][c] = EDGE
+	for r in range(ROWS):
+		for c in range(COLS):
+			if grid[r][c] is None:
+				grid[r][c] = layer_regions[layer].index(getRegion(compiled, r * CELL + CELL // 2 - 900000000, c * CELL + CELL // 2 - 1800000000))
+
+	# Regions changed by the simplification, on random points close to the vertices
+	random.seed(1)
+	changed = 0
+	for n in range(2000):
+		v = random.choice(random.choice(rings)[1])
+		lat = max(-900000000, min(900000000, v[0] + random.randint(-1000000, 1000000)))
+		lon = max(-1800000000, min(1800000000, v[1] + random.randint(-1000000, 1000000)))
+		changed += getRegion(rings, lat, lon) != getRegion(compiled, lat, lon)
+	print('Region changed on %d of 2000 points within 0.1 deg of the vertices' % changed)
+
+	vertices = sum(len(ring) for region, ring in rings)
+	deltas = sum(len(ring) for region, ring in compiled)
+	edges = sum(row.count(EDGE) for row in grid)
+	print('Vertices %d bytes (int32), compiled %d bytes (int16 differences), grid %d bytes, %d of %d cells on edges' % (vertices * 8, deltas * 4, ROWS * COLS // 2, edges, ROWS * COLS))
+
+	return compiled, grid
+
+compiled = {}
+grids = {}
+for layer in layers:
+	compiled[layer], grids[layer] = compile(layer)
+
+# Write header
+source = args.geojson.split('/')[-1]
+print('Write %s/geofence_data.h' % args.output)
+with open(args.output + '/geofence_data.h', 'w') as f:
+	f.write('/* Generated by doc/geofence/compile.py from %s, do not edit */\n\n' % source)
+	f.write('#ifndef __GEOFENCE_DATA_H__\n')
+	f.write('#define __GEOFENCE_DATA_H__\n\n')
+	f.write('#define GEOFENCE_CELL\t%d\t\t/* Grid cell size in deg*10000000 (%g deg) */\n' % (CELL, CELL / 10000000))
+	f.write('#define GEOFENCE_UNIT\t%d\t\t\t/* Vertex resolution in deg*10000000 (%g deg) */\n' % (UNIT, UNIT / 10000000))
+	f.write('#define GEOFENCE_EDGE\t0x%X\t\t\t/* Grid cell touched by a polygon edge */\n\n' % EDGE)
+	f.write('typedef enum {\n')
+	for layer in layers:
+		f.write('\tLAYER_%s,\n' % layer.upper())
+	f.write('\tLAYERS\n')
+	f.write('} layer_t;\n\n')
+	f.write('typedef enum {\n')
+	for region in regions:
+		f.write('\tREGION_%s,%s// %s\n' % (region.upper(), '\t' * max(1, (18 - len(region)) // 4), names[region]))
+	f.write('\tREGIONS\n')
+	f.write('} region_t;\n\n')
+	f.write('#endif\n')
+
+# Write source
+print('Write %s/geofence_data.c' % args.output)
+with open(args.output + '/geofence_data.c', 'w') as f:
+	f.write('/* Generated by doc/geofence/compile.py from %s (tolerance %g deg), do not edit */\n\n' % (source, args.tolerance))
+	f.write('#include "ch.h"\n')
+	f.write('#include "hal.h"\n')
+	f.write('#include "geofence.h"\n')
+
+	for layer in layers:
+		f.write('\n/*\n * Layer %s\n */\n\n' % layer)
+		for n, (region, ring) in enumerate(compiled[layer]):
+			f.write('static const int16_t %s_poly%d[] = { // %s\n' % (layer, n, names[region]))
+			f.write('\t// Latitude, longitude differences\n')
+			for i in range(0, len(ring), 8):
+				pairs = []
+				for k in range(i, min(i + 8, len(ring))):
+					a, b = ring[k], ring[(k + 1) % len(ring)]
+					d = ((b[0] - a[0]) // UNIT, (b[1] - a[1]) // UNIT)
+					assert -DELTA_MAX <= d[0] <= DELTA_MAX and -DELTA_MAX <= d[1] <= DELTA_MAX
+					pairs.append('%6d,%6d' % d)
+				f.write('\t' + ', '.join(pairs) + ',\n')
+			f.write('};\n')
+
+		f.write('\nstatic const polygon_t %s_polygons[] = {\n' % layer)
+		f.write('\t// Region, bounding box, first vertex, differences, edges\n')
+		for n, (region, ring) in enumerate(compiled[layer]):
+			lats = [v[0] for v in ring]
+			lons = [v[1] for v in ring]
+			f.write('\t{REGION_%s, {%d, %d}, {%d, %d}, {%d, %d}, %s_poly%d, %d},\n' % (region.upper(),
+					min(lats), min(lons), max(lats), max(lons), ring[0][0], ring[0][1], layer, n, len(ring)))
+		f.write('};\n\n')
+
+		f.write('static const region_t %s_regions[] = {%s};\n\n' % (layer, ', '.join('REGION_' + r.upper() for r in layer_regions[layer])))
+
+		f.write('static const uint8_t %s_grid[GEOFENCE_ROWS][GEOFENCE_COLS/2] = {\n' % layer)
+		f.write('\t// Two cells per byte, low nibble first, row 0 at 90 deg south\n')
+		for r in range(ROWS):
+			f.write('\t{' + ','.join('0x%X%X' % (grids[layer][r][c + 1], grids[layer][r][c]) for c in range(0, COLS, 2)) + '},\n')
+		f.write('};\n')
+
+	f.write('\nconst geofence_layer_t geofence_layers[LAYERS] = {\n')
+	for layer in layers:
+		f.write('\t{%s_polygons, sizeof(%s_polygons)/sizeof(polygon_t), %s_regions, %s_grid},\n' % (layer, layer, layer, layer))
+	f.write('};\n')
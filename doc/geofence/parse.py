@@ -1,13 +1,11 @@
-# This is an updating script which parses the current geofencing from the software
-# into a KML file (geofencing.kml) which can be displayed by geofencing.html.
+# This is an updating script which parses the current geofencing (regions.geojson,
+# compiled into the software by compile.py) into a KML file (geofencing.kml)
+# which can be displayed by geofencing.html.
 
+import json
 import re
 import webbrowser
 
-_open = re.compile('^(.*?)coord_t (.*?)\[\] = \{(.*?)$')
-_close = re.compile('^\};$')
-_value = re.compile('^(.*?)\{(.*?),(.*?)\}(.*?)$')
-
 region = {}
 colorId = 0
 colors = {
@@ -15,7 +13,7 @@ colors = {
 	'china':		'0xff 0x00 0x00',
 	'southkorea':	'0x00 0xff 0x00',
 	'japan':		'0x00 0x00 0xff',
-	'southeastAsia':'0xff 0xff 0x33',
+	'southeastasia':'0xff 0xff 0x33',
 	'australia':	'0x00 0xff 0x00',
 	'newzealand':	'0x00 0x00 0xff',
 	'argentina':	'0x00 0x00 0xff',
@@ -26,31 +24,27 @@ remInts = lambda x: ''.join([i for i in x if not i.isdigit()]) # Remove integers
 
 # Parse
 print('Parsing')
-with open("../../math/geofence.c", "r") as f:
-	for line in f:
-		m = _open.match(line)
-		if m: # Found region start
-			region[m.group(2)] = []
-			currRegion = m.group(2)
+with open("regions.geojson", "r") as f:
+	for feature in json.load(f)['features']:
+		if feature['properties'].get('layer', 'aprs') != 'aprs': # APRS regions only
+			continue
+		currRegion = feature['properties']['region']
+		geometry = feature['geometry']
+		polygons = [geometry['coordinates']] if geometry['type'] == 'Polygon' else geometry['coordinates']
 
-			# Parse frequency
-			with open("../../modules/radio.h", "r") as fb:
-				_freq = re.compile('^(.*?)APRS_FREQ_' + currRegion.upper() + '(.*?)$')
-				for lineb in fb:
-					m = _freq.match(lineb)
-					if m:
-						freq[currRegion] = float(m.group(2))/1000000
+		# Parse frequency
+		with open("../../radio.h", "r") as fb:
+			_freq = re.compile('^(.*?)APRS_FREQ_' + currRegion.upper() + '(.*?)$')
+			for lineb in fb:
+				m = _freq.match(lineb)
+				if m:
+					freq[currRegion] = float(m.group(2))/1000000
 
-			print('> %s, %.3f MHz' % (currRegion.title(), freq[remInts(currRegion)]))
-			continue
-		
-		if _close.match(line): # Found region end
-			currRegion = None
-			continue
+		print('> %s, %.3f MHz' % (currRegion.title(), freq[currRegion]))
 
-		m = _value.match(line)
-		if m and currRegion is not None: # Found region data
-			region[currRegion].append((float(m.group(3)), float(m.group(2))))
+		for n, polygon in enumerate(polygons): # Found region data
+			name = currRegion + (str(n+1) if n else '')
+			region[name] = [(lon*10000000, lat*10000000) for lon, lat in polygon[0]]
 
 # Write to KML
 print('Write to KML')
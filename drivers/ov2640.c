@@ -34,6 +34,7 @@
 #define DCMI_BASE_ADR			((uint32_t)0x50050000)
 #define DCMI_REG_DR_OFFSET		0x28
 #define DCMI_REG_DR_ADDRESS		(DCMI_BASE_ADR | DCMI_REG_DR_OFFSET)
+#define OV2640_FRAME_TIMEOUT	2000	/* Max. capture time of a frame in ms */
 
 
 #define VAL_SET(x, mask, rshift, lshift)  \
@@ -637,74 +638,287 @@ static const struct regval_list ov2640_jpeg_regs[] = {
 };
 
 
-bool ov2640_samplingFinished;
 ssdv_config_t *ov2640_config;
 
+// Snapshot capture
+static binary_semaphore_t capture_sem;	// Signaled by the DMA when the buffer is full
+static volatile bool capture_full;		// DMA filled the whole buffer
+static uint32_t capture_len;			// JPEG length of the last snapshot
+static bool capture_overflow;			// Last snapshot didn't fit into the buffer
+
+static void OV2640_StartDMA(void);
+
+// Streaming capture, the DMA writes the frame into ram_buffer used as ring buffer
+static binary_semaphore_t stream_sem;	// Signaled by the DMA after each half of the ring
+static volatile uint32_t stream_wraps;	// Completed passes of the DMA over the ring
+static uint32_t stream_read;			// Bytes handed out by OV2640_StreamRead()
+static uint32_t stream_chunk;			// Start of the last chunk handed out
+static uint32_t stream_end;				// Bytes captured (0: frame not finished yet)
+static systime_t stream_start;
+static bool stream_overrun;
+
 /**
-  * Captures an image from the camera.
+  * Returns the length of the JPEG image up to the EOI marker (FFD9), 0 if
+  * there is none
+  */
+static uint32_t OV2640_FindEOI(const uint8_t *buffer, uint32_t len)
+{
+	for(uint32_t i=len; i>=2; i--)
+		if(buffer[i-2] == 0xFF && buffer[i-1] == 0xD9)
+			return i;
+	return 0;
+}
+
+/**
+  * Captures an image from the camera. Waits for the end of the frame (DCMI
+  * clears CAPTURE in snapshot mode) or the DMA transfer complete interrupt
+  * (buffer full). The image length is taken from the DMA counter and the EOI
+  * marker.
   */
 bool OV2640_Snapshot2RAM(void)
 {
+	const stm32_dma_stream_t *stream = STM32_DMA2_STREAM1;
+
 	palClearPad(PORT(LED_2YELLOW), PIN(LED_2YELLOW)); // Yellow LED shows when image is captured
 
+	// (Re)start DMA for the whole buffer
+	capture_full = false;
+	capture_len = 0;
+	capture_overflow = false;
+	OV2640_StartDMA();
+
 	// Capture enable
 	TRACE_INFO("CAM  > Capture image");
+	systime_t start = chVTGetSystemTimeX();
 	OV2640_CaptureDCMI();
-	chThdSleepMilliseconds(1000);
 
+	while((DCMI->CR & DCMI_CR_CAPTURE) && !capture_full) {
+		if(chVTTimeElapsedSinceX(start) > MS2ST(OV2640_FRAME_TIMEOUT)) {
+			TRACE_ERROR("CAM  > Capture timeout");
+			DCMI->CR &= ~DCMI_CR_CAPTURE;
+			dmaStreamDisable(stream);
+			palSetPad(PORT(LED_2YELLOW), PIN(LED_2YELLOW));
+			return false;
+		}
+		chBSemWaitTimeout(&capture_sem, MS2ST(1));
+	}
+
+	// Disabling the stream flushes the DMA FIFO, then the counter is final
+	dmaStreamDisable(stream);
+	uint32_t written = ov2640_config->ram_size - dmaStreamGetTransactionSize(stream) * sizeof(uint32_t);
+
+	capture_len = OV2640_FindEOI(ov2640_config->ram_buffer, written);
+	capture_overflow = capture_full || !capture_len;
+	if(!capture_len)
+		capture_len = written;
+
+	TRACE_INFO("CAM  > Captured %d bytes in %d ms%s", capture_len, ST2MS(chVTGetSystemTimeX() - start),
+				capture_overflow ? " (buffer overflow)" : "");
 	palSetPad(PORT(LED_2YELLOW), PIN(LED_2YELLOW));
 
 	return true;
 }
 
+/**
+  * Returns true if the last image didn't fit into the buffer
+  */
 bool OV2640_BufferOverflow(void)
 {
-	return OV2640_getBuffer(NULL) > ov2640_config->ram_size-3;
+	return capture_overflow;
 }
 
 uint32_t OV2640_getBuffer(uint8_t** buffer) {
 	*buffer = ov2640_config->ram_buffer;
+	return capture_len;
+}
+
+/**
+  * DMA interrupt in streaming mode (half and full ring)
+  */
+static void OV2640_dma_stream(void *p, uint32_t flags)
+{
+	(void)p;
+
+	if(flags & STM32_DMA_ISR_TCIF)
+		stream_wraps++;
+
+	chSysLockFromISR();
+	chBSemSignalI(&stream_sem);
+	chSysUnlockFromISR();
+}
+
+/**
+  * Returns the number of bytes written by the DMA since the capture started
+  */
+static uint32_t OV2640_StreamWritten(void)
+{
+	if(stream_end)
+		return stream_end;
+
+	const stm32_dma_stream_t *stream = STM32_DMA2_STREAM1;
+	uint32_t wraps, ndtr;
+	do {
+		wraps = stream_wraps;
+		ndtr = dmaStreamGetTransactionSize(stream);
+	} while(wraps != stream_wraps);
+
+	return (wraps + 1) * ov2640_config->ram_size - ndtr * sizeof(uint32_t);
+}
+
+/**
+  * Starts capturing a frame in streaming mode. The image is read with
+  * OV2640_StreamRead() while the DMA is still writing it.
+  */
+void OV2640_StreamStart(void)
+{
+	palClearPad(PORT(LED_2YELLOW), PIN(LED_2YELLOW)); // Yellow LED shows when image is captured
+
+	stream_read = 0;
+	stream_chunk = 0;
+	stream_end = 0;
+	stream_overrun = false;
+	stream_start = chVTGetSystemTimeX();
+
+	TRACE_INFO("CAM  > Capture image (streaming)");
+	OV2640_CaptureDCMI();
+}
+
+/**
+  * Returns true when the frame has been captured completely
+  */
+bool OV2640_StreamCaptured(void)
+{
+	if(!stream_end && !(DCMI->CR & DCMI_CR_CAPTURE)) { // Snapshot mode clears CAPTURE after the frame
+		stream_end = OV2640_StreamWritten();
+		palSetPad(PORT(LED_2YELLOW), PIN(LED_2YELLOW));
+		TRACE_INFO("CAM  > Captured %d bytes in %d ms", stream_end, ST2MS(chVTGetSystemTimeX() - stream_start));
+	}
+	return stream_end != 0;
+}
+
+/**
+  * Waits for the end of the frame. Returns false on timeout.
+  */
+bool OV2640_StreamWait(void)
+{
+	while(!OV2640_StreamCaptured()) {
+		if(chVTTimeElapsedSinceX(stream_start) > MS2ST(OV2640_FRAME_TIMEOUT)) {
+			TRACE_ERROR("CAM  > Capture timeout");
+			return false;
+		}
+		chBSemWaitTimeout(&stream_sem, MS2ST(1));
+	}
+	return true;
+}
 
-	// Detect size
+/**
+  * Returns the next chunk (max bytes) of the frame being captured. Waits for
+  * the DMA if all captured bytes have been read. The chunk stays valid until
+  * the next call. Returns 0 at the end of the frame, on timeout or if the
+  * DMA overwrote data not read yet (see OV2640_StreamOverrun()).
+  */
+uint32_t OV2640_StreamRead(uint8_t **data, uint32_t max)
+{
 	uint32_t size = ov2640_config->ram_size;
-	while(!ov2640_config->ram_buffer[size-1])
-		size--;
+	uint32_t written;
+
+	while(true) {
+		bool captured = OV2640_StreamCaptured();
+		written = OV2640_StreamWritten();
+
+		if(written - stream_chunk > size) {
+			if(!stream_overrun)
+				TRACE_ERROR("CAM  > Stream overrun, image not read fast enough");
+			stream_overrun = true;
+			return 0;
+		}
+		if(written > stream_read)
+			break;
+		if(captured || !OV2640_StreamWait())
+			return 0; // End of frame
+	}
 
-	return size;
+	uint32_t pos = stream_read % size;
+	uint32_t n = written - stream_read;
+	if(n > size - pos)
+		n = size - pos;
+	if(n > max)
+		n = max;
+
+	*data = &ov2640_config->ram_buffer[pos];
+	stream_chunk = stream_read;
+	stream_read += n;
+	return n;
 }
 
-void OV2640_dma_avail(uint32_t flags)
+bool OV2640_StreamOverrun(void)
 {
-	(void)flags;
-	TRACE_DEBUG("DMA Interrupt");
-	ov2640_samplingFinished = true;
-	dmaStreamDisable(STM32_DMA2_STREAM1);
+	return stream_overrun;
 }
 
 /**
-  * Initializes DMA
+  * DMA transfer complete interrupt in snapshot mode (buffer full)
   */
-void OV2640_InitDMA(void)
+static void OV2640_dma_full(void *p, uint32_t flags)
+{
+	(void)p;
+
+	if(flags & STM32_DMA_ISR_TCIF) {
+		capture_full = true;
+
+		chSysLockFromISR();
+		chBSemSignalI(&capture_sem);
+		chSysUnlockFromISR();
+	}
+}
+
+/**
+  * Starts the DMA transfer from the DCMI into the whole buffer
+  */
+static void OV2640_StartDMA(void)
 {
-	TRACE_INFO("CAM  > Available buffer %d byte", ov2640_config->ram_size);
 	const stm32_dma_stream_t *stream = STM32_DMA2_STREAM1;
-	dmaStreamAllocate(stream, 2, (stm32_dmaisr_t)OV2640_dma_avail, NULL);
+	uint32_t mode = STM32_DMA_CR_CHSEL(1) | STM32_DMA_CR_DIR_P2M |
+					STM32_DMA_CR_MINC | STM32_DMA_CR_PSIZE_WORD |
+					STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_MBURST_SINGLE |
+					STM32_DMA_CR_PBURST_SINGLE | STM32_DMA_CR_TEIE |
+					STM32_DMA_CR_TCIE | STM32_DMA_CR_PL(3);
+	if(ov2640_config->stream) // Circular, interrupt at each half of the ring
+		mode |= STM32_DMA_CR_CIRC | STM32_DMA_CR_HTIE;
+
+	dmaStreamDisable(stream);
 	dmaStreamSetPeripheral(stream, ((uint32_t*)DCMI_REG_DR_ADDRESS));
 	dmaStreamSetMemory0(stream, (uint32_t)ov2640_config->ram_buffer);
 	dmaStreamSetTransactionSize(stream, ov2640_config->ram_size / sizeof(uint32_t));
-	dmaStreamSetMode(stream, STM32_DMA_CR_CHSEL(1) | STM32_DMA_CR_DIR_P2M |
-							 STM32_DMA_CR_MINC | STM32_DMA_CR_PSIZE_WORD |
-							 STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_MBURST_SINGLE |
-							 STM32_DMA_CR_PBURST_SINGLE | STM32_DMA_CR_TEIE |
-							 STM32_DMA_CR_PL(3));
+	dmaStreamSetMode(stream, mode);
 	dmaStreamSetFIFO(stream, STM32_DMA_FCR_FTH_FULL);
 	dmaStreamEnable(stream);
 }
 
+/**
+  * Initializes DMA
+  */
+void OV2640_InitDMA(void)
+{
+	TRACE_INFO("CAM  > Available buffer %d byte", ov2640_config->ram_size);
+	const stm32_dma_stream_t *stream = STM32_DMA2_STREAM1;
+
+	if(ov2640_config->stream) {
+		stream_wraps = 0;
+		chBSemObjectInit(&stream_sem, true);
+		dmaStreamAllocate(stream, 2, OV2640_dma_stream, NULL);
+		OV2640_StartDMA();
+	} else { // Started by OV2640_Snapshot2RAM()
+		chBSemObjectInit(&capture_sem, true);
+		dmaStreamAllocate(stream, 2, OV2640_dma_full, NULL);
+	}
+}
+
 void OV2640_DeinitDMA(void)
 {
 	const stm32_dma_stream_t *stream = STM32_DMA2_STREAM1;
 	dmaStreamDisable(stream);
+	dmaStreamRelease(stream);
 }
 
 /**
@@ -810,6 +1024,12 @@ void OV2640_TransmitConfig(void)
 
 	for(uint32_t i=0; (ov2640_jpeg_regs[i].reg != 0xff) || (ov2640_jpeg_regs[i].val != 0xff); i++)
 		I2C_write8_locked(OV2640_I2C_ADR, ov2640_jpeg_regs[i].reg, ov2640_jpeg_regs[i].val);
+
+	// JPEG quality (quantization scale)
+	if(ov2640_config->qs) {
+		I2C_write8_locked(OV2640_I2C_ADR, BANK_SEL, BANK_SEL_DSP);
+		I2C_write8_locked(OV2640_I2C_ADR, QS, ov2640_config->qs);
+	}
 }
 
 void OV2640_init(ssdv_config_t *config) {
@@ -818,11 +1038,6 @@ void OV2640_init(ssdv_config_t *config) {
 	// Take I2C (due to silicon bug of OV2640, it interferes if byte 0x30 transmitted on I2C bus)
 	I2C_lock();
 
-	// Clearing buffer
-	uint32_t i;
-	for(i=0; i<ov2640_config->ram_size; i++)
-		ov2640_config->ram_buffer[i] = 0;
-
 	TRACE_INFO("CAM  > Init pins");
 	OV2640_InitGPIO();
 
@@ -22,5 +22,10 @@ void OV2640_TransmitConfig(void);
 void OV2640_init(ssdv_config_t *config);
 void OV2640_deinit(void);
 bool OV2640_isAvailable(void);
+void OV2640_StreamStart(void);
+uint32_t OV2640_StreamRead(uint8_t **data, uint32_t max);
+bool OV2640_StreamCaptured(void);
+bool OV2640_StreamWait(void);
+bool OV2640_StreamOverrun(void);
 
 #endif
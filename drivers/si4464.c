@@ -24,8 +24,17 @@ static const SPIConfig ls_spicfg2 = {
 };
 #define getSPIDriver(radio) (radio == RADIO_2M ? &ls_spicfg1 : &ls_spicfg2)
 
-uint32_t outdiv;
-bool initialized[2];
+static uint32_t outdiv[3];		// Output divider of the synthesizer, indexed by radio
+static bool initialized[3];		// Chip powered up and modem configured
+static bool transmitting[3];	// Chip in TX state (START_TX issued)
+static mod_t modem[3];			// Modulation the modem is configured for
+static uint32_t tuned_freq[3];	// Frequency programmed into the synthesizer
+static uint16_t tuned_shift[3];	// Shift programmed into the synthesizer
+static int8_t tuned_power[3];	// Power level programmed into the PA
+static bool no_cts_pin[3];		// GPIO1 didn't signal CTS, poll the chip instead
+static uint32_t fifo_rate[3];	// Data rate of the packet handler (FIFO mode, 0: unknown)
+
+static void Si4464_powerUp(radio_t radio, uint8_t* txData, uint32_t len);
 
 /**
  * Initializes Si4464 transceiver chip. Adjustes the frequency which is shifted by variable
@@ -33,6 +42,17 @@ bool initialized[2];
  * @param mv Oscillator voltage in mv
  */
 void Si4464_Init(radio_t radio, mod_t modulation) {
+	// Chip already running, only reconfigure the modem if the modulation changed
+	if(initialized[radio]) {
+		if(modem[radio] != modulation) {
+			TRACE_INFO("SI %d > Switch modem %s > %s", radio, VAL2MOULATION(modem[radio]), VAL2MOULATION(modulation));
+			if(transmitting[radio])
+				stopTx(radio);
+			setModem(radio, modulation);
+		}
+		return;
+	}
+
 	// Initialize SPI
 	palSetPadMode(PORT(SPI_SCK), PIN(SPI_SCK), PAL_MODE_ALTERNATE(5) | PAL_STM32_OSPEED_HIGHEST);			// SCK
 	palSetPadMode(PORT(SPI_MISO), PIN(SPI_MISO), PAL_MODE_ALTERNATE(5) | PAL_STM32_OSPEED_HIGHEST);			// MISO
@@ -46,15 +66,13 @@ void Si4464_Init(radio_t radio, mod_t modulation) {
 
 		// Configure pins
 		palSetPadMode(PORT(RADIO1_SDN), PIN(RADIO1_SDN), PAL_MODE_OUTPUT_PUSHPULL);		// RADIO1 SDN
-		palSetPadMode(PORT(RADIO1_GPIO0), PIN(RADIO1_GPIO0), PAL_MODE_OUTPUT_PUSHPULL);	// RADIO1 GPIO0
-		palSetPadMode(PORT(RADIO1_GPIO1), PIN(RADIO1_GPIO1), PAL_MODE_OUTPUT_PUSHPULL);	// RADIO1 GPIO1
+		palSetPadMode(PORT(RADIO1_GPIO1), PIN(RADIO1_GPIO1), PAL_MODE_INPUT_PULLDOWN);		// RADIO1 GPIO1 (CTS)
 
 	} else if (radio == RADIO_70CM) {
 
 		// Configure pins
 		palSetPadMode(PORT(RADIO2_SDN), PIN(RADIO2_SDN), PAL_MODE_OUTPUT_PUSHPULL);		// RADIO2 SDN
-		palSetPadMode(PORT(RADIO2_GPIO0), PIN(RADIO2_GPIO0), PAL_MODE_OUTPUT_PUSHPULL);	// RADIO2 GPIO0
-		palSetPadMode(PORT(RADIO2_GPIO1), PIN(RADIO2_GPIO1), PAL_MODE_OUTPUT_PUSHPULL);	// RADIO2 GPIO1
+		palSetPadMode(PORT(RADIO2_GPIO1), PIN(RADIO2_GPIO1), PAL_MODE_INPUT_PULLDOWN);		// RADIO2 GPIO1 (CTS)
 
 	}
 
@@ -68,22 +86,49 @@ void Si4464_Init(radio_t radio, mod_t modulation) {
 	uint8_t x1 = (OSC_FREQ >>  8) & 0x0FF;
 	uint8_t x0 = (OSC_FREQ >>  0) & 0x0FF;
 	uint8_t init_command[] = {0x02, 0x01, 0x01, x3, x2, x1, x0};
-	Si4464_write(radio, init_command, 7);
+	Si4464_powerUp(radio, init_command, 7);
+
+	// Set modem (and transmitter GPIOs)
+	setModem(radio, modulation);
 
-	// Set transmitter GPIOs
+	// Temperature readout
+	TRACE_INFO("SI %d > Transmitter temperature %d degC", radio, Si4464_getTemperature(radio));
+	initialized[radio] = true;
+	tuned_freq[radio] = 0; // Synthesizer and PA not programmed yet
+}
+
+/**
+  * Sets the transmitter GPIOs. GPIO0 is the modulation input in async modes
+  * and signals the TX FIFO almost empty condition in FIFO mode. GPIO1
+  * signals CTS.
+  */
+static void setGPIO(radio_t radio, bool fifo) {
 	uint8_t gpio_pin_cfg_command[] = {
-		0x13,	// Command type = GPIO settings
-		0x44,	// GPIO0        0 - PULL_CTL[1bit] - GPIO_MODE[6bit]
-		0x00,	// GPIO1        0 - PULL_CTL[1bit] - GPIO_MODE[6bit]
-		0x00,	// GPIO2        0 - PULL_CTL[1bit] - GPIO_MODE[6bit]
-		0x00,	// GPIO3        0 - PULL_CTL[1bit] - GPIO_MODE[6bit]
-		0x00,	// NIRQ
-		0x00,	// SDO
-		0x00	// GEN_CONFIG
+		0x13,				// Command type = GPIO settings
+		fifo ? 0x23 : 0x44,	// GPIO0        0 - PULL_CTL[1bit] - GPIO_MODE[6bit] (TX_FIFO_EMPTY or INPUT)
+		0x08,				// GPIO1        0 - PULL_CTL[1bit] - GPIO_MODE[6bit] (CTS)
+		0x00,				// GPIO2        0 - PULL_CTL[1bit] - GPIO_MODE[6bit]
+		0x00,				// GPIO3        0 - PULL_CTL[1bit] - GPIO_MODE[6bit]
+		0x00,				// NIRQ
+		0x00,				// SDO
+		0x00				// GEN_CONFIG
 	};
 	Si4464_write(radio, gpio_pin_cfg_command, 8);
 
-	// Set modem
+	iomode_t mode = fifo ? PAL_MODE_INPUT : PAL_MODE_OUTPUT_PUSHPULL;
+	if(radio == RADIO_2M)
+		palSetPadMode(PORT(RADIO1_GPIO0), PIN(RADIO1_GPIO0), mode);	// RADIO1 GPIO0
+	else
+		palSetPadMode(PORT(RADIO2_GPIO0), PIN(RADIO2_GPIO0), mode);	// RADIO2 GPIO0
+}
+
+/**
+  * Configures the modem for the modulation
+  */
+void setModem(radio_t radio, mod_t modulation) {
+	setGPIO(radio, SI4464_FIFO_MODE(modulation));
+	fifo_rate[radio] = 0;
+
 	switch(modulation)
 	{
 		case MOD_AFSK:
@@ -101,40 +146,98 @@ void Si4464_Init(radio_t radio, mod_t modulation) {
 		case MOD_DOMINOEX16:
 			TRACE_WARN("SI %d > Unimplemented modulation %s", radio, VAL2MOULATION(modulation)); // TODO: Implement DominoEX16
 	}
-
-	// Temperature readout
-	TRACE_INFO("SI %d > Transmitter temperature %d degC", radio, Si4464_getTemperature(radio));
-	initialized[radio] = true;
+	modem[radio] = modulation;
 }
 
-void Si4464_write(radio_t radio, uint8_t* txData, uint32_t len) {
-	// Transmit data by SPI
-	uint8_t rxData[len];
-	
-	// SPI transfer
+/**
+  * Single SPI transaction (chip select cycle)
+  */
+static void Si4464_exchange(radio_t radio, uint8_t* txData, uint8_t* rxData, uint32_t len) {
 	spiAcquireBus(&SPID2);
 	spiStart(&SPID2, getSPIDriver(radio));
 	spiSelect(&SPID2);
 	spiExchange(&SPID2, len, txData, rxData);
 	spiUnselect(&SPID2);
 	spiReleaseBus(&SPID2);
+}
 
-	// Reqest ACK by Si4464
-	uint32_t counter = 0; // FIXME: Sometimes CTS is not returned by Si4464 correctly
-	rxData[1] = 0x00;
-	while(rxData[1] != 0xFF && ++counter < 2000) {
-
-		// Request ACK by Si4464
-		uint8_t rx_ready[] = {0x44};
-
-		// SPI transfer
-		spiAcquireBus(&SPID2);
-		spiStart(&SPID2, getSPIDriver(radio));
-		spiSelect(&SPID2);
-		spiExchange(&SPID2, 3, rx_ready, rxData);
-		spiUnselect(&SPID2);
-		spiReleaseBus(&SPID2);
+/**
+  * Waits for the CTS signal on GPIO1. The pin is polled SI4464_CTS_SPIN times
+  * before the thread sleeps between polls. Returns false on timeout, the pin
+  * isn't used anymore afterwards.
+  */
+static bool Si4464_waitCTSPin(radio_t radio) {
+	if(no_cts_pin[radio])
+		return false;
+
+	for(uint32_t i=0; i<SI4464_CTS_SPIN; i++)
+		if(RF_GPIO1_GET(radio))
+			return true;
+
+	systime_t start = chVTGetSystemTimeX();
+	while(!RF_GPIO1_GET(radio)) {
+		if(chVTTimeElapsedSinceX(start) > MS2ST(SI4464_CTS_TIMEOUT)) {
+			TRACE_WARN("SI %d > No CTS on GPIO1, polling CTS by SPI", radio);
+			no_cts_pin[radio] = true;
+			return false;
+		}
+		chThdSleep(1);
 	}
+	return true;
+}
+
+/**
+  * Reads the command buffer (READ_CMD_BUFF) until the chip reports CTS. The
+  * first SI4464_CTS_SPIN polls are sent back-to-back, then the delay between
+  * polls is doubled up to 1 ms. Returns false on timeout.
+  */
+static bool Si4464_readCmdBuff(radio_t radio, uint8_t* rxData, uint32_t rxlen) {
+	uint8_t rx_ready[rxlen];
+	memset(rx_ready, 0x00, rxlen);
+	rx_ready[0] = 0x44;
+
+	systime_t start = chVTGetSystemTimeX();
+	systime_t delay = 1;
+	for(uint32_t i=0; true; i++) {
+		Si4464_exchange(radio, rx_ready, rxData, rxlen);
+		if(rxData[1] == 0xFF)
+			return true;
+		if(chVTTimeElapsedSinceX(start) > MS2ST(SI4464_CTS_TIMEOUT))
+			return false;
+		if(i >= SI4464_CTS_SPIN) {
+			chThdSleep(delay);
+			if(delay < MS2ST(1))
+				delay *= 2;
+		}
+	}
+}
+
+/**
+  * Sends POWER_UP and checks GPIO1 against the CTS read by SPI. The pin must
+  * be low while the chip boots and high once it reports CTS, otherwise it's
+  * floating or stuck and CTS is polled by SPI instead.
+  */
+static void Si4464_powerUp(radio_t radio, uint8_t* txData, uint32_t len) {
+	uint8_t rxData[len];
+	Si4464_exchange(radio, txData, rxData, len);
+
+	bool busy_pin = RF_GPIO1_GET(radio);		// Chip boots, CTS low
+	if(!Si4464_readCmdBuff(radio, rxData, 2))
+		TRACE_WARN("SI %d > No CTS after command 0x%02x", radio, txData[0]);
+	bool no_pin = busy_pin || !RF_GPIO1_GET(radio);
+	if(no_pin && !no_cts_pin[radio])
+		TRACE_WARN("SI %d > GPIO1 doesn't follow CTS, polling CTS by SPI", radio);
+	no_cts_pin[radio] = no_pin;
+}
+
+void Si4464_write(radio_t radio, uint8_t* txData, uint32_t len) {
+	// Transmit data by SPI
+	uint8_t rxData[len];
+	Si4464_exchange(radio, txData, rxData, len);
+
+	// Wait for CTS, poll the chip if the pin doesn't signal it
+	if(!Si4464_waitCTSPin(radio) && !Si4464_readCmdBuff(radio, rxData, 2))
+		TRACE_WARN("SI %d > No CTS after command 0x%02x", radio, txData[0]);
 }
 
 /**
@@ -143,49 +246,65 @@ void Si4464_write(radio_t radio, uint8_t* txData, uint32_t len) {
 void Si4464_read(radio_t radio, uint8_t* txData, uint32_t txlen, uint8_t* rxData, uint32_t rxlen) {
 	// Transmit data by SPI
 	uint8_t null_spi[txlen];
-	// SPI transfer
-	spiAcquireBus(&SPID2);
-	spiStart(&SPID2, getSPIDriver(radio));
-	spiSelect(&SPID2);
-	spiExchange(&SPID2, txlen, txData, null_spi);
-	spiUnselect(&SPID2);
-	spiReleaseBus(&SPID2);
+	Si4464_exchange(radio, txData, null_spi, txlen);
 
-	// Reqest ACK by Si4464
-	uint32_t counter = 0; // FIXME: Sometimes CTS is not returned by Si4464 correctly
-	rxData[1] = 0x00;
-	while(rxData[1] != 0xFF && ++counter < 2000) {
-
-		// Request ACK by Si4464
-		uint16_t rx_ready[rxlen];
-		rx_ready[0] = 0x44;
-
-		// SPI transfer
-		spiAcquireBus(&SPID2);
-		spiStart(&SPID2, getSPIDriver(radio));
-		spiSelect(&SPID2);
-		spiExchange(&SPID2, rxlen, rx_ready, rxData);
-		spiUnselect(&SPID2);
-		spiReleaseBus(&SPID2);
+	// Read response once the chip signals CTS
+	Si4464_waitCTSPin(radio);
+	if(!Si4464_readCmdBuff(radio, rxData, rxlen))
+		TRACE_WARN("SI %d > No CTS after command 0x%02x", radio, txData[0]);
+}
+
+/**
+  * Starts a batch of property writes. Consecutive properties of a group are
+  * sent in one SET_PROPERTY command (up to SI4464_MAX_PROPS).
+  */
+void Si4464_beginProperties(si4464_props_t *props, radio_t radio) {
+	props->radio = radio;
+	props->cmd[0] = 0x11;	// SET_PROPERTY
+	props->cmd[2] = 0;		// Number of properties
+}
+
+void Si4464_setProperty(si4464_props_t *props, uint8_t group, uint8_t prop, uint8_t value) {
+	uint8_t n = props->cmd[2];
+	if(n && (props->cmd[1] != group || (uint8_t)(props->cmd[3] + n) != prop || n == SI4464_MAX_PROPS)) {
+		Si4464_flushProperties(props);
+		n = 0;
+	}
+	if(!n) {
+		props->cmd[1] = group;
+		props->cmd[3] = prop;
 	}
+	props->cmd[4 + n] = value;
+	props->cmd[2] = n + 1;
+}
+
+/**
+  * Writes the properties collected since the last flush
+  */
+void Si4464_flushProperties(si4464_props_t *props) {
+	if(props->cmd[2])
+		Si4464_write(props->radio, props->cmd, 4 + props->cmd[2]);
+	props->cmd[2] = 0;
 }
 
 void setFrequency(radio_t radio, uint32_t freq, uint16_t shift) {
+	si4464_props_t props;
+	Si4464_beginProperties(&props, radio);
+
 	// Set the output divider according to recommended ranges given in Si4464 datasheet
 	uint32_t band = 0;
-	if(freq < 705000000UL) {outdiv = 6;  band = 1;};
-	if(freq < 525000000UL) {outdiv = 8;  band = 2;};
-	if(freq < 353000000UL) {outdiv = 12; band = 3;};
-	if(freq < 239000000UL) {outdiv = 16; band = 4;};
-	if(freq < 177000000UL) {outdiv = 24; band = 5;};
+	if(freq < 705000000UL) {outdiv[radio] = 6;  band = 1;};
+	if(freq < 525000000UL) {outdiv[radio] = 8;  band = 2;};
+	if(freq < 353000000UL) {outdiv[radio] = 12; band = 3;};
+	if(freq < 239000000UL) {outdiv[radio] = 16; band = 4;};
+	if(freq < 177000000UL) {outdiv[radio] = 24; band = 5;};
 
 	// Set the band parameter
 	uint32_t sy_sel = 8;
-	uint8_t set_band_property_command[] = {0x11, 0x20, 0x01, 0x51, (band + sy_sel)};
-	Si4464_write(radio, set_band_property_command, 5);
+	Si4464_setProperty(&props, 0x20, 0x51, band + sy_sel);
 
 	// Set the PLL parameters
-	uint32_t f_pfd = 2 * OSC_FREQ / outdiv;
+	uint32_t f_pfd = 2 * OSC_FREQ / outdiv[radio];
 	uint32_t n = ((uint32_t)(freq / f_pfd)) - 1;
 	float ratio = (float)freq / (float)f_pfd;
 	float rest  = ratio - (float)n;
@@ -195,26 +314,29 @@ void setFrequency(radio_t radio, uint32_t freq, uint16_t shift) {
 	uint32_t m1 = (m - m2 * 0x10000) >> 8;
 	uint32_t m0 = (m - m2 * 0x10000 - (m1 << 8));
 
-	uint32_t channel_increment = 524288 * outdiv * shift / (2 * OSC_FREQ);
+	uint32_t channel_increment = 524288 * outdiv[radio] * shift / (2 * OSC_FREQ);
 	uint8_t c1 = channel_increment / 0x100;
 	uint8_t c0 = channel_increment - (0x100 * c1);
 
-	uint8_t set_frequency_property_command[] = {0x11, 0x40, 0x04, 0x00, n, m2, m1, m0, c1, c0};
-	Si4464_write(radio, set_frequency_property_command, 10);
+	uint8_t freq_control[] = {n, m2, m1, m0, c1, c0};
+	for(uint8_t i=0; i<sizeof(freq_control); i++)
+		Si4464_setProperty(&props, 0x40, 0x00+i, freq_control[i]);
+
+	uint32_t x = ((((uint32_t)1 << 19) * outdiv[radio] * 1300.0)/(2*OSC_FREQ))*2;
+	Si4464_setProperty(&props, 0x20, 0x0A, (x >> 16) & 0xFF);
+	Si4464_setProperty(&props, 0x20, 0x0B, (x >>  8) & 0xFF);
+	Si4464_setProperty(&props, 0x20, 0x0C, (x >>  0) & 0xFF);
 
-	uint32_t x = ((((uint32_t)1 << 19) * outdiv * 1300.0)/(2*OSC_FREQ))*2;
-	uint8_t x2 = (x >> 16) & 0xFF;
-	uint8_t x1 = (x >>  8) & 0xFF;
-	uint8_t x0 = (x >>  0) & 0xFF;
-	uint8_t set_deviation[] = {0x11, 0x20, 0x03, 0x0a, x2, x1, x0};
-	Si4464_write(radio, set_deviation, 7);
+	Si4464_flushProperties(&props);
+	if(fifo_rate[radio] != SI4464_2GFSK_RATE)
+		fifo_rate[radio] = 0; // Deviation doesn't match the data rate anymore
 }
 
 void setShift(radio_t radio, uint16_t shift) {
 	if(!shift)
 		return;
 
-	float units_per_hz = (( 0x40000 * outdiv ) / (float)OSC_FREQ);
+	float units_per_hz = (( 0x40000 * outdiv[radio] ) / (float)OSC_FREQ);
 
 	// Set deviation for 2FSK
 	uint32_t modem_freq_dev = (uint32_t)(units_per_hz * shift / 2.0 );
@@ -226,39 +348,44 @@ void setShift(radio_t radio, uint16_t shift) {
 	Si4464_write(radio, set_modem_freq_dev_command, 7);
 }
 
-void setModemAFSK(radio_t radio) {
+/**
+  * Sets up the NCO (10x oversampling, data rate in bps) and the modulation
+  * type, preamble and sync word disabled
+  */
+static void setModemNCO(si4464_props_t *props, uint32_t data_rate, uint8_t mod_type) {
 	// Disable preamble
-	uint8_t disable_preamble[] = {0x11, 0x10, 0x01, 0x00, 0x00};
-	Si4464_write(radio, disable_preamble, 5);
+	Si4464_setProperty(props, 0x10, 0x00, 0x00);
 
 	// Do not transmit sync word
-	uint8_t no_sync_word[] = {0x11, 0x11, 0x01, 0x00, (0x01 << 7)};
-	Si4464_write(radio, no_sync_word, 5);
+	Si4464_setProperty(props, 0x11, 0x00, (0x01 << 7));
 
-	// Setup the NCO modulo and oversampling mode
+	// Setup the NCO data rate (MODEM_DATA_RATE, 0x2003) and the NCO modulo
+	// and oversampling mode (MODEM_TX_NCO_MODE, 0x2006) in one command
 	uint32_t s = OSC_FREQ / 10;
-	uint8_t f3 = (s >> 24) & 0xFF;
-	uint8_t f2 = (s >> 16) & 0xFF;
-	uint8_t f1 = (s >>  8) & 0xFF;
-	uint8_t f0 = (s >>  0) & 0xFF;
-	uint8_t setup_oversampling[] = {0x11, 0x20, 0x04, 0x06, f3, f2, f1, f0};
-	Si4464_write(radio, setup_oversampling, 8);
-
-	// Setup the NCO data rate for APRS
-	uint8_t setup_data_rate[] = {0x11, 0x20, 0x03, 0x03, 0x00, 0x11, 0x30};
-	Si4464_write(radio, setup_data_rate, 7);
-
-	// Use 2GFSK from async GPIO0
-	uint8_t use_2gfsk[] = {0x11, 0x20, 0x01, 0x00, 0x0B};
-	Si4464_write(radio, use_2gfsk, 5);
-
-	// Set AFSK filter
+	uint8_t nco[] = {
+		(data_rate >> 16) & 0xFF, (data_rate >> 8) & 0xFF, data_rate & 0xFF,
+		(s >> 24) & 0xFF, (s >> 16) & 0xFF, (s >> 8) & 0xFF, s & 0xFF
+	};
+	for(uint8_t i=0; i<sizeof(nco); i++)
+		Si4464_setProperty(props, 0x20, 0x03+i, nco[i]);
+
+	// Modulation type and source
+	Si4464_setProperty(props, 0x20, 0x00, mod_type);
+}
+
+void setModemAFSK(radio_t radio) {
+	si4464_props_t props;
+	Si4464_beginProperties(&props, radio);
+
+	// Setup the NCO data rate for APRS, use 2GFSK from async GPIO0
+	setModemNCO(&props, 0x001130, 0x0B);
+
+	// Set AFSK filter (coefficients from 0x2017 down to 0x200F)
 	uint8_t coeff[] = {0x81, 0x9f, 0xc4, 0xee, 0x18, 0x3e, 0x5c, 0x70, 0x76};
-	uint8_t i;
-	for(i=0; i<sizeof(coeff); i++) {
-		uint8_t msg[] = {0x11, 0x20, 0x01, 0x17-i, coeff[i]};
-		Si4464_write(radio, msg, 5);
-	}
+	for(uint8_t i=0; i<sizeof(coeff); i++)
+		Si4464_setProperty(&props, 0x20, 0x0F+i, coeff[sizeof(coeff)-1-i]);
+
+	Si4464_flushProperties(&props);
 }
 
 void setModemOOK(radio_t radio) {
@@ -274,30 +401,44 @@ void setModem2FSK(radio_t radio) {
 }
 
 void setModem2GFSK(radio_t radio) {
-	// Disable preamble
-	uint8_t disable_preamble[] = {0x11, 0x10, 0x01, 0x00, 0x00};
-	Si4464_write(radio, disable_preamble, 5);
+	si4464_props_t props;
+	Si4464_beginProperties(&props, radio);
 
-	// Do not transmit sync word
-	uint8_t no_sync_word[] = {0x11, 0x11, 0x01, 0x00, (0x01 << 7)};
-	Si4464_write(radio, no_sync_word, 5);
+	// Setup the NCO data rate for 2GFSK, use 2GFSK from the packet handler
+	setModemNCO(&props, SI4464_2GFSK_RATE, 0x03);
+	fifo_rate[radio] = SI4464_2GFSK_RATE;
 
-	// Setup the NCO modulo and oversampling mode
-	uint32_t s = OSC_FREQ / 10;
-	uint8_t f3 = (s >> 24) & 0xFF;
-	uint8_t f2 = (s >> 16) & 0xFF;
-	uint8_t f1 = (s >>  8) & 0xFF;
-	uint8_t f0 = (s >>  0) & 0xFF;
-	uint8_t setup_oversampling[] = {0x11, 0x20, 0x04, 0x06, f3, f2, f1, f0};
-	Si4464_write(radio, setup_oversampling, 8);
+	// Send the data LSB first, no CRC (PKT_CONFIG1)
+	Si4464_setProperty(&props, 0x12, 0x06, 0x01);
 
-	// Setup the NCO data rate for 2GFSK
-	uint8_t setup_data_rate[] = {0x11, 0x20, 0x03, 0x03, 0x00, 0x25, 0x80};
-	Si4464_write(radio, setup_data_rate, 7);
+	// TX FIFO almost empty threshold (PKT_TX_THRESHOLD)
+	Si4464_setProperty(&props, 0x12, 0x0B, SI4464_FIFO_THRESHOLD);
 
-	// Use 2GFSK from async GPIO0
-	uint8_t use_2gfsk[] = {0x11, 0x20, 0x01, 0x00, 0x0B};
-	Si4464_write(radio, use_2gfsk, 5);
+	Si4464_flushProperties(&props);
+}
+
+/**
+  * Sets the data rate of the packet handler in bps. The deviation is scaled
+  * with the data rate (2600 Hz at 9600 bps).
+  */
+void setDataRate(radio_t radio, uint32_t rate) {
+	if(fifo_rate[radio] == rate)
+		return;
+
+	si4464_props_t props;
+	Si4464_beginProperties(&props, radio);
+
+	Si4464_setProperty(&props, 0x20, 0x03, (rate >> 16) & 0xFF);
+	Si4464_setProperty(&props, 0x20, 0x04, (rate >>  8) & 0xFF);
+	Si4464_setProperty(&props, 0x20, 0x05, (rate >>  0) & 0xFF);
+
+	uint32_t x = ((((uint32_t)1 << 19) * outdiv[radio] * 1300.0 * rate / SI4464_2GFSK_RATE)/(2*OSC_FREQ))*2;
+	Si4464_setProperty(&props, 0x20, 0x0A, (x >> 16) & 0xFF);
+	Si4464_setProperty(&props, 0x20, 0x0B, (x >>  8) & 0xFF);
+	Si4464_setProperty(&props, 0x20, 0x0C, (x >>  0) & 0xFF);
+
+	Si4464_flushProperties(&props);
+	fifo_rate[radio] = rate;
 }
 
 void setPowerLevel(radio_t radio, int8_t level) {
@@ -306,24 +447,31 @@ void setPowerLevel(radio_t radio, int8_t level) {
 	Si4464_write(radio, set_pa_pwr_lvl_property_command, 5);
 }
 
+/**
+  * Starts transmission. Size 0 transmits until stopTx() (async modes), packets
+  * of size bytes are sent from the TX FIFO and the chip returns to READY.
+  */
 void startTx(radio_t radio, uint16_t size) {
 	uint8_t change_state_command[] = {0x31, 0x00, 0x30, (size >> 8) & 0x1F, size & 0xFF};
 	Si4464_write(radio, change_state_command, 5);
+	transmitting[radio] = !size;
 }
 
 void stopTx(radio_t radio) {
 	uint8_t change_state_command[] = {0x34, 0x03};
 	Si4464_write(radio, change_state_command, 2);
+	transmitting[radio] = false;
 }
 
 void radioShutdown(radio_t radio) {
 	RADIO_SDN_SET(radio, true);	// Power down chip
-	RF_GPIO1_SET(radio, false);	// Set GPIO1 low
 	initialized[radio] = false;
+	transmitting[radio] = false;
 }
 
 /**
- * Tunes the radio and activates transmission.
+ * Tunes the radio and activates transmission. Only the settings which differ
+ * from the last tuning are written to the chip.
  * @param frequency Transmission frequency in Hz
  * @param shift Shift of FSK in Hz
  * @param level Transmission power level in dBm
@@ -344,11 +492,28 @@ bool radioTune(radio_t radio, uint32_t frequency, uint16_t shift, int8_t level,
 		TRACE_WARN("SI %d > continue transmission", radio);
 	}
 
-	setFrequency(radio, frequency, shift);	// Set frequency
-	setShift(radio, shift);					// Set shift
-	setPowerLevel(radio, level);			// Set power level
+	bool retune = tuned_freq[radio] != frequency || tuned_shift[radio] != shift;
+	bool repower = retune || tuned_power[radio] != level;
+	bool fifo = SI4464_FIFO_MODE(modem[radio]);
+	if((transmitting[radio] || fifo) && !retune && !repower)
+		return true; // Already transmitting (or ready to) with these settings
 
-	startTx(radio, size);
+	if(transmitting[radio])
+		stopTx(radio);
+
+	if(retune) {
+		setFrequency(radio, frequency, shift);	// Set frequency
+		setShift(radio, shift);					// Set shift
+		tuned_freq[radio] = frequency;
+		tuned_shift[radio] = shift;
+	}
+	if(repower) {
+		setPowerLevel(radio, level);			// Set power level
+		tuned_power[radio] = level;
+	}
+
+	if(!fifo) // Packets are started by the sender
+		startTx(radio, size);
 	return true;
 }
 
@@ -359,6 +524,14 @@ void Si4464_writeFIFO(radio_t radio, uint8_t *msg, uint8_t size) {
 	Si4464_write(radio, write_fifo, size+1);
 }
 
+/**
+  * Clears the TX FIFO of Si4464 (remainders of an aborted packet)
+  */
+void Si4464_resetFIFO(radio_t radio) {
+	uint8_t fifo_info[2] = {0x15, 0x01};
+	Si4464_write(radio, fifo_info, 2);
+}
+
 /**
   * Returns free space in FIFO of Si4464
   */
@@ -414,3 +587,12 @@ bool isRadioInitialized(radio_t radio) {
 	return initialized[radio];
 }
 
+/**
+  * Returns true if the radio is transmitting (FIFO mode: ready) with the given
+  * settings, so a message can be sent without reprogramming the chip.
+  */
+bool isRadioTuned(radio_t radio, mod_t modulation, uint32_t frequency, uint16_t shift, int8_t level) {
+	return initialized[radio] && (transmitting[radio] || SI4464_FIFO_MODE(modulation)) && modem[radio] == modulation
+		&& tuned_freq[radio] == frequency && tuned_shift[radio] == shift && tuned_power[radio] == level;
+}
+
@@ -12,23 +12,46 @@
 #define RADIO_SDN_SET(radio, state)			(radio == RADIO_2M ? palWritePad(PORT(RADIO1_SDN), PIN(RADIO1_SDN), state) : palWritePad(PORT(RADIO2_SDN), PIN(RADIO2_SDN), state))
 #define RADIO_CS_SET(radio, state)			(radio == RADIO_2M ? palWritePad(PORT(RADIO1_CS), PIN(RADIO1_CS), state) : palWritePad(PORT(RADIO2_CS), PIN(RADIO2_CS), state))
 #define RF_GPIO0_SET(radio, state)			(radio == RADIO_2M ? palWritePad(PORT(RADIO1_GPIO0), PIN(RADIO1_GPIO0), state) : palWritePad(PORT(RADIO2_GPIO0), PIN(RADIO2_GPIO0), state))
+#define RF_GPIO1_GET(radio)					(radio == RADIO_2M ? palReadPad(PORT(RADIO1_GPIO1), PIN(RADIO1_GPIO1)) : palReadPad(PORT(RADIO2_GPIO1), PIN(RADIO2_GPIO1)))
 #define RF_GPIO1_SET(radio, state)			(radio == RADIO_2M ? palWritePad(PORT(RADIO1_GPIO1), PIN(RADIO1_GPIO1), state) : palWritePad(PORT(RADIO2_GPIO1), PIN(RADIO2_GPIO1), state))
 #define MOD_GPIO_SET(radio, state)			RF_GPIO0_SET(radio, state)
 #define RADIO_WITHIN_MAX_PWR(radio, dBm)	(radio == RADIO_2M ? (dBm) <= RADIO1_MAX_PWR : (dBm) <= RADIO2_MAX_PWR)
 #define RADIO_WITHIN_FREQ_RANGE(frequ)		((frequ) >= 119000000 && (frequ) <= 1050000000)
 #define RADIO_MAX_PWR(radio)				(radio == RADIO_2M ? RADIO1_MAX_PWR : RADIO2_MAX_PWR)
 
+#define SI4464_MAX_PROPS		12		/* Max. number of properties written by one SET_PROPERTY */
+#define SI4464_CTS_SPIN			16		/* CTS polls before the driver sleeps between polls */
+#define SI4464_CTS_TIMEOUT		100		/* CTS timeout in ms */
+#define SI4464_FIFO_SIZE		64		/* TX FIFO size in bytes */
+#define SI4464_FIFO_THRESHOLD	32		/* TX FIFO almost empty threshold (free bytes) */
+#define SI4464_2GFSK_RATE		9600	/* Default 2GFSK data rate in bps */
+
+#define SI4464_FIFO_MODE(mod)	((mod) == MOD_2GFSK)	/* Modulations sent from the TX FIFO */
+
 #define inRadio1band(freq) (RADIO1_MIN_FREQ <= (freq) && (freq) <= RADIO1_MAX_FREQ)
 #define inRadio2band(freq) (RADIO2_MIN_FREQ <= (freq) && (freq) <= RADIO2_MAX_FREQ)
 
+/**
+  * Batch of consecutive properties (SET_PROPERTY command)
+  */
+typedef struct {
+	radio_t radio;
+	uint8_t cmd[4 + SI4464_MAX_PROPS];	// 0x11, group, number of properties, start property, values
+} si4464_props_t;
+
 void Si4464_Init(radio_t radio, mod_t modulation);
 void Si4464_write(radio_t radio, uint8_t* txData, uint32_t len);
+void Si4464_beginProperties(si4464_props_t *props, radio_t radio);
+void Si4464_setProperty(si4464_props_t *props, uint8_t group, uint8_t prop, uint8_t value);
+void Si4464_flushProperties(si4464_props_t *props);
 void setFrequency(radio_t radio, uint32_t freq, uint16_t shift);
 void setShift(radio_t radio, uint16_t shift);
+void setModem(radio_t radio, mod_t modulation);
 void setModemAFSK(radio_t radio);
 void setModemOOK(radio_t radio);
 void setModem2FSK(radio_t radio);
 void setModem2GFSK(radio_t radio);
+void setDataRate(radio_t radio, uint32_t rate);
 void setDeviation(radio_t radio, uint32_t deviation);
 void setPowerLevel(radio_t radio, int8_t level);
 void startTx(radio_t radio, uint16_t size);
@@ -36,11 +59,13 @@ void stopTx(radio_t radio);
 void radioShutdown(radio_t radio);
 bool radioTune(radio_t radio, uint32_t frequency, uint16_t shift, int8_t level, uint16_t size);
 void Si4464_writeFIFO(radio_t radio, uint8_t *msg, uint8_t size);
+void Si4464_resetFIFO(radio_t radio);
 uint8_t Si4464_freeFIFO(radio_t radio);
 uint8_t Si4464_getState(radio_t radio);
 int8_t Si4464_getTemperature(radio_t radio);
 uint8_t dBm2powerLvl(int32_t dBm);
 bool isRadioInitialized(radio_t radio);
+bool isRadioTuned(radio_t radio, mod_t modulation, uint32_t frequency, uint16_t shift, int8_t level);
 
 #endif
 
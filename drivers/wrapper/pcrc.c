@@ -0,0 +1,27 @@
+#include "ch.h"
+#include "hal.h"
+#include "pcrc.h"
+
+static MUTEX_DECL(crc_mtx);
+
+/**
+  * Runs whole words through the STM32 CRC unit and returns the register of
+  * a reflected CRC-32 (initial value 0xFFFFFFFF, without final XOR). The
+  * unit calculates CRC-32/MPEG-2 (not reflected, MSB first), so the input
+  * words and the result are bit reversed.
+  */
+uint32_t pcrc_crc32(const uint8_t *data, size_t words)
+{
+	chMtxLock(&crc_mtx);
+	rccEnableAHB1(RCC_AHB1ENR_CRCEN, FALSE);
+
+	CRC->CR = CRC_CR_RESET;
+	for(; words; words--, data += 4)
+		CRC->DR = __RBIT(data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24);
+	uint32_t crc = __RBIT(CRC->DR);
+
+	rccDisableAHB1(RCC_AHB1ENR_CRCEN, FALSE);
+	chMtxUnlock(&crc_mtx);
+
+	return crc;
+}
@@ -0,0 +1,10 @@
+#ifndef __PCRC_H__
+#define __PCRC_H__
+
+#include "ch.h"
+#include "hal.h"
+
+uint32_t pcrc_crc32(const uint8_t *data, size_t words);
+
+#endif
+
@@ -0,0 +1,174 @@
+/**
+  * AFSK sample generator check. Generates the sample stream of random frames
+  * with afsk_fill() in chunks of different sizes and compares it with the
+  * former per-sample interrupt handler (phase accumulation per TIM7 update).
+  * Checks that the waveform is phase continuous: every half period must be
+  * within the half periods of 1200 Hz and 2200 Hz, a phase jump at a bit or
+  * buffer boundary would produce a shorter or longer one.
+  *
+  * Usage: afsk_bench [frames]
+  */
+
+#include "ch.h"
+#include "afsk.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_BITS		8192
+#define SET				0x00002000	/* BSRR words of pin 13 */
+#define RESET			0x20000000
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+  * Former TIM7 interrupt handler, one call per sample. Returns the pin level
+  * or -1 after the last bit.
+  */
+typedef struct {
+	const uint8_t *msg;
+	uint32_t bin_len;
+	uint32_t phase_delta;
+	uint32_t phase;
+	uint32_t packet_pos;
+	uint32_t current_sample_in_baud;
+	uint8_t current_byte;
+} ref_t;
+
+static int ref_sample(ref_t *r)
+{
+	if(r->packet_pos == r->bin_len)
+		return -1;
+
+	if(r->current_sample_in_baud == 0) {
+		if((r->packet_pos & 7) == 0) {
+			r->current_byte = r->msg[r->packet_pos >> 3];
+		} else {
+			r->current_byte = r->current_byte / 2;
+		}
+	}
+
+	r->phase_delta = (r->current_byte & 1) ? AFSK_PHASE_DELTA_1200 : AFSK_PHASE_DELTA_2200;
+	r->phase += r->phase_delta;
+	int level = (r->phase >> 16) & 1;
+
+	if(++r->current_sample_in_baud == AFSK_SAMPLES_PER_BAUD) {
+		r->current_sample_in_baud = 0;
+		r->packet_pos++;
+	}
+	return level;
+}
+
+/**
+  * Generates a frame with afsk_fill() in chunks of the given number of bits,
+  * returns the number of samples
+  */
+static uint32_t generate(const uint8_t *data, uint32_t bits, uint32_t chunk, uint32_t *samples)
+{
+	static uint32_t buf[MAX_BITS * AFSK_SAMPLES_PER_BAUD];
+	afsk_t afsk;
+	uint32_t n = 0;
+
+	afsk_init(&afsk, data, bits, SET, RESET);
+	while(afsk.bit < bits) {
+		uint32_t b = afsk_fill(&afsk, buf, chunk);
+		memcpy(&samples[n], buf, b * AFSK_SAMPLES_PER_BAUD * sizeof(uint32_t));
+		n += b * AFSK_SAMPLES_PER_BAUD;
+
+		// Padding after the last bit must hold the pin level
+		for(uint32_t i=b*AFSK_SAMPLES_PER_BAUD; i<chunk*AFSK_SAMPLES_PER_BAUD; i++) {
+			if(buf[i] != samples[n-1]) {
+				printf("Padding changes the pin level\n");
+				return 0;
+			}
+		}
+	}
+	return n;
+}
+
+static bool check(const uint8_t *data, uint32_t bits)
+{
+	static uint32_t samples[MAX_BITS * AFSK_SAMPLES_PER_BAUD];
+	const uint32_t chunks[] = {1, 3, 8, 64};
+
+	// Half periods of the tones in samples (rounded down and up)
+	uint32_t min_run = (1 << 16) / AFSK_PHASE_DELTA_2200;
+	uint32_t max_run = (1 << 16) / AFSK_PHASE_DELTA_1200 + 1;
+
+	for(uint32_t c=0; c<sizeof(chunks)/sizeof(uint32_t); c++) {
+		uint32_t n = generate(data, bits, chunks[c], samples);
+		if(n != bits * AFSK_SAMPLES_PER_BAUD) {
+			printf("Wrong number of samples: %u bits, chunk %u, %u samples\n", bits, chunks[c], n);
+			return false;
+		}
+
+		ref_t ref = {.msg = data, .bin_len = bits};
+		uint32_t run = 0, runs = 0;
+		for(uint32_t i=0; i<n; i++) {
+			int level = ref_sample(&ref);
+			uint32_t word = level ? SET : RESET;
+			if(samples[i] != word) {
+				printf("Sample mismatch: %u bits, chunk %u, sample %u (bit %u)\n", bits, chunks[c], i, i / AFSK_SAMPLES_PER_BAUD);
+				return false;
+			}
+
+			// Length of the half periods (the first one starts at an arbitrary phase)
+			run++;
+			if(i+1 < n && samples[i+1] != samples[i]) {
+				if(runs++ && (run < min_run || run > max_run)) {
+					printf("Phase discontinuity: %u bits, chunk %u, sample %u, half period %u samples\n",
+						   bits, chunks[c], i, run);
+					return false;
+				}
+				run = 0;
+			}
+		}
+		if(ref_sample(&ref) != -1) {
+			printf("Reference has more samples: %u bits\n", bits);
+			return false;
+		}
+	}
+	return true;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t frames = argc > 1 ? atoi(argv[1]) : 200;
+	static uint8_t data[MAX_BITS / 8];
+
+	srand(1);
+	bool ok = true;
+	uint64_t bits_total = 0;
+	for(uint32_t f=0; f<frames && ok; f++) {
+		uint32_t bits = 1 + rand() % (MAX_BITS - 1);
+		for(uint32_t i=0; i<sizeof(data); i++)
+			data[i] = f % 4 == 0 ? 0x00 : f % 4 == 1 ? 0xFF : rand(); // Single tones and random
+		ok &= check(data, bits);
+		bits_total += bits;
+	}
+	printf("Phase continuity  %s (%u frames, %lu bits)\n", ok ? "OK" : "FAILED", frames, (unsigned long)bits_total);
+
+	// Generator cost
+	static uint32_t buf[8 * AFSK_SAMPLES_PER_BAUD];
+	afsk_t afsk;
+	uint32_t iterations = 20000;
+	uint64_t start = now_ns();
+	for(uint32_t i=0; i<iterations; i++) {
+		afsk_init(&afsk, data, 1024, SET, RESET);
+		while(afsk_fill(&afsk, buf, 8) == 8);
+	}
+	double ns_per_bit = (double)(now_ns() - start) / iterations / 1024;
+
+	printf("Generator         %.1f ns/bit on this host\n", ns_per_bit);
+	printf("Interrupts        %u/s per sample (TIM7) vs. %u/s per 8 bit half buffer (DMA)\n",
+		   AFSK_PLAYBACK_RATE, AFSK_BAUD_RATE / 8);
+
+	return ok ? 0 : 1;
+}
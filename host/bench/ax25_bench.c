@@ -0,0 +1,161 @@
+/**
+  * AX.25 encoder benchmark. Encodes APRS frames with the fused encoder in
+  * ax25.c and with the former three-pass encoder (ax25_ref.c: per-bit
+  * stuffing, scrambling, NRZ-I), checks that both produce the same bits and
+  * compares the time needed per frame.
+  *
+  * Usage: ax25_bench [iterations]
+  */
+
+#include "ch.h"
+#include "ax25.h"
+#include "ax25_ref.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define PAYLOAD_BYTES	256
+#define BUFFER_BYTES	1024
+
+typedef struct {
+	const char *name;
+	uint8_t data[PAYLOAD_BYTES];
+	uint32_t len;
+} payload_t;
+
+static const char *paths[] = {"", "WIDE1-1", "WIDE1-1,WIDE2-1"};
+static const mod_t mods[] = {MOD_AFSK, MOD_2GFSK};
+static bool overflow;		// Overflow reported by the last encode()
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static uint32_t encode(uint8_t *buf, uint16_t max_size, mod_t mod, const char *path, const payload_t *pl)
+{
+	ax25_t packet;
+	packet.data = buf;
+	packet.max_size = max_size;
+	packet.mod = mod;
+
+	ax25_send_header(&packet, "DL7AD", 12, path, 200);
+	for(uint32_t i=0; i<pl->len; i++)
+		ax25_send_byte(&packet, pl->data[i]);
+	ax25_send_footer(&packet);
+
+	overflow = packet.overflow;
+	return packet.size;
+}
+
+static uint32_t encode_ref(uint8_t *buf, uint16_t max_size, mod_t mod, const char *path, const payload_t *pl)
+{
+	ax25_t packet;
+	packet.data = buf;
+	packet.max_size = max_size;
+	packet.mod = mod;
+
+	ref_ax25_send_header(&packet, "DL7AD", 12, path, 200);
+	for(uint32_t i=0; i<pl->len; i++)
+		ref_ax25_send_byte(&packet, pl->data[i]);
+	ref_ax25_send_footer(&packet);
+	ref_scramble(&packet);
+	ref_nrzi_encode(&packet);
+
+	return packet.size;
+}
+
+/**
+  * Compares the first bits of two buffers
+  */
+static bool same_bits(const uint8_t *a, const uint8_t *b, uint32_t bits)
+{
+	if(memcmp(a, b, bits / 8))
+		return false;
+	uint8_t mask = (1 << (bits & 7)) - 1;
+	return !(bits & 7) || !((a[bits / 8] ^ b[bits / 8]) & mask);
+}
+
+/**
+  * Encodes the payload with both encoders for all modulations and paths, in
+  * buffers large enough and buffers which end inside the frame. Frames which
+  * don't fit must be reported as overflow.
+  */
+static bool check(const payload_t *pl)
+{
+	static uint8_t buf[BUFFER_BYTES], ref[BUFFER_BYTES];
+	const uint16_t sizes[] = {BUFFER_BYTES, 512, 301, 100, 37};
+
+	for(uint32_t m=0; m<sizeof(mods)/sizeof(mod_t); m++) {
+		mod_t mod = mods[m];
+		for(uint32_t p=0; p<sizeof(paths)/sizeof(char*); p++) {
+			uint32_t full = encode(buf, BUFFER_BYTES, mod, paths[p], pl);
+			for(uint32_t s=0; s<sizeof(sizes)/sizeof(uint16_t); s++) {
+				memset(buf, 0x5a, sizeof(buf));
+				memset(ref, 0xa5, sizeof(ref));
+				uint32_t n = encode(buf, sizes[s], mod, paths[p], pl);
+				uint32_t r = encode_ref(ref, sizes[s], mod, paths[p], pl);
+				if(n != r || !same_bits(buf, ref, n)) {
+					printf("Mismatch: %s, mod %d, path '%s', max_size %u (%u/%u bits)\n",
+						   pl->name, mod, paths[p], sizes[s], n, r);
+					return false;
+				}
+				if(overflow != (full > sizes[s] * 8u)) {
+					printf("Overflow not reported: %s, mod %d, path '%s', max_size %u\n",
+						   pl->name, mod, paths[p], sizes[s]);
+					return false;
+				}
+			}
+		}
+	}
+	return true;
+}
+
+static double bench(uint32_t (*enc)(uint8_t*, uint16_t, mod_t, const char*, const payload_t*), mod_t mod, const payload_t *pl, uint32_t iterations)
+{
+	static uint8_t buf[BUFFER_BYTES];
+
+	uint64_t start = now_ns();
+	for(uint32_t n=0; n<iterations; n++)
+		enc(buf, BUFFER_BYTES, mod, "WIDE1-1", pl);
+	return (double)(now_ns() - start) / iterations / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t iterations = argc > 1 ? atoi(argv[1]) : 20000;
+	payload_t payloads[3] = {{.name = "APRS text"}, {.name = "random"}, {.name = "0xFF heavy"}};
+
+	// Typical APRS/SSDV base91 payload, random binary data and worst case for stuffing
+	const char *aprs = "{{IK!!!\"L1#+U<lJ%N6`;^9pQ)O%h0~/9=&Zq*8e]m2Eb3zy>jd:Wfe7M!c|!!!!!!!!!!!!!!!!!!|";
+	srand(1);
+	for(uint32_t i=0; i<PAYLOAD_BYTES; i++) {
+		payloads[0].data[i] = aprs[i % strlen(aprs)];
+		payloads[1].data[i] = rand();
+		payloads[2].data[i] = rand() & 1 ? 0xff : rand();
+	}
+	for(uint32_t f=0; f<3; f++)
+		payloads[f].len = PAYLOAD_BYTES;
+
+	bool ok = true;
+	for(uint32_t f=0; f<3; f++)
+		ok &= check(&payloads[f]);
+	printf("Bit exactness     %s\n", ok ? "OK" : "FAILED");
+
+	printf("%-12s %-6s %14s %14s %8s\n", "Payload", "Mod", "three-pass", "fused", "speedup");
+	for(uint32_t f=0; f<3; f++) {
+		for(uint32_t m=0; m<sizeof(mods)/sizeof(mod_t); m++) {
+			mod_t mod = mods[m];
+			double ref = bench(encode_ref, mod, &payloads[f], iterations);
+			double opt = bench(encode, mod, &payloads[f], iterations);
+			printf("%-12s %-6s %9.2f us/fr %9.2f us/fr %7.2fx\n", payloads[f].name,
+				   mod == MOD_AFSK ? "AFSK" : "2GFSK", ref, opt, ref / opt);
+		}
+	}
+
+	return ok ? 0 : 1;
+}
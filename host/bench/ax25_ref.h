@@ -0,0 +1,20 @@
+/**
+  * Reference (three-pass) AX.25 encoder, see ax25_ref.c
+  */
+
+#ifndef __AX25_REF_H__
+#define __AX25_REF_H__
+
+#include "ax25.h"
+
+void ref_ax25_send_header(ax25_t *packet, const char *callsign, uint8_t ssid, const char *path, uint16_t preamble);
+void ref_ax25_send_path(ax25_t *packet, const char *callsign, uint8_t ssid, bool last);
+void ref_ax25_send_byte(ax25_t *packet, char byte);
+void ref_ax25_send_sync(ax25_t *packet);
+void ref_ax25_send_flag(ax25_t *packet);
+void ref_ax25_send_string(ax25_t *packet, const char *string);
+void ref_ax25_send_footer(ax25_t *packet);
+void ref_scramble(ax25_t *packet);
+void ref_nrzi_encode(ax25_t *packet);
+
+#endif
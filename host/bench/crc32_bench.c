@@ -0,0 +1,225 @@
+/**
+  * SSDV CRC-32 benchmark. Compares the former bitwise CRC-32 with the
+  * slice-by-4 tables and the CRC unit path (SSDV_CRC_HW, modelled by the host
+  * stub) on random data, then encodes the sample pictures to SSDV packets
+  * with each implementation and compares the time needed per packet.
+  * The encoder's calls to crc32() are redirected with --wrap=crc32.
+  *
+  * Usage: crc32_bench [iterations] [image.jpg ...]
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "crc32.h"
+#include "ssdv.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_IMAGES	"doc/sample_pictures/test%d.jpg"
+#define MAX_IMAGES		8
+#define PKT_CRCDATA		(SSDV_PKT_SIZE - SSDV_PKT_SIZE_CRC - SSDV_PKT_SIZE_RSCODES - 1)
+
+typedef enum {
+	CRC_BITWISE,
+	CRC_TABLE,
+	CRC_UNIT
+} crc_impl_t;
+
+// Referenced by ssdv.c (tracing)
+SerialDriver SD4;
+mutex_t trace_mtx;
+void log_error(const char *file, uint16_t line);
+void log_error(const char *file, uint16_t line)
+{
+	(void)file;
+	(void)line;
+}
+
+uint32_t __real_crc32(void *data, size_t length);
+uint32_t __wrap_crc32(void *data, size_t length);
+
+static crc_impl_t impl;
+static struct {
+	uint8_t *data;
+	size_t len;
+} images[MAX_IMAGES];
+static uint32_t image_cnt;
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+  * Former bitwise implementation of ssdv.c
+  */
+static uint32_t crc32_bitwise(void *data, size_t length)
+{
+	uint32_t crc, x;
+	uint8_t i, *d;
+
+	for(d = data, crc = 0xFFFFFFFF; length; length--)
+	{
+		x = (crc ^ *(d++)) & 0xFF;
+		for(i = 8; i > 0; i--)
+		{
+			if(x & 1) x = (x >> 1) ^ 0xEDB88320;
+			else x >>= 1;
+		}
+		crc = (crc >> 8) ^ x;
+	}
+
+	return(crc ^ 0xFFFFFFFF);
+}
+
+static uint32_t crc32_table(void *data, size_t length)
+{
+	return crc32_update(0xFFFFFFFF, data, length) ^ 0xFFFFFFFF;
+}
+
+uint32_t __wrap_crc32(void *data, size_t length)
+{
+	switch(impl) {
+		case CRC_BITWISE:	return crc32_bitwise(data, length);
+		case CRC_TABLE:		return crc32_table(data, length);
+		default:			return __real_crc32(data, length);
+	}
+}
+
+static bool check(void)
+{
+	static uint8_t buf[1024];
+
+	if(crc32_table("123456789", 9) != 0xCBF43926 || __real_crc32("123456789", 9) != 0xCBF43926)
+		return false;
+
+	srand(1);
+	for(uint32_t n=0; n<2000; n++) {
+		size_t len = rand() % (sizeof(buf) - 4);
+		size_t off = rand() % 4; // Unaligned starts
+		for(size_t i=0; i<len+off; i++)
+			buf[i] = rand();
+		uint32_t ref = crc32_bitwise(&buf[off], len);
+		if(crc32_table(&buf[off], len) != ref || __real_crc32(&buf[off], len) != ref) {
+			printf("Mismatch at length %zu, offset %zu\n", len, off);
+			return false;
+		}
+	}
+	return true;
+}
+
+static bool load(const char *filename)
+{
+	FILE *f = fopen(filename, "rb");
+	if(!f || image_cnt == MAX_IMAGES)
+		return false;
+	static uint8_t buf[1024*1024];
+	size_t len = fread(buf, 1, sizeof(buf), f);
+	fclose(f);
+
+	images[image_cnt].data = malloc(len);
+	memcpy(images[image_cnt].data, buf, len);
+	images[image_cnt++].len = len;
+	return true;
+}
+
+/**
+  * Encodes all images to SSDV packets, returns the number of packets and
+  * the sum of all packet bytes in *sum (compared between implementations)
+  */
+static uint32_t encode(uint32_t *sum)
+{
+	uint32_t packets = 0;
+	*sum = 0;
+
+	for(uint32_t n=0; n<image_cnt; n++) {
+		ssdv_t ssdv;
+		uint8_t pkt[SSDV_PKT_SIZE];
+		size_t pos = 0;
+		char c;
+
+		ssdv_enc_init(&ssdv, SSDV_TYPE_NORMAL, "DL7AD", n);
+		ssdv_enc_set_buffer(&ssdv, pkt);
+		while(true) {
+			while((c = ssdv_enc_get_packet(&ssdv)) == SSDV_FEED_ME) {
+				size_t r = images[n].len - pos < 128 ? images[n].len - pos : 128;
+				if(!r)
+					break;
+				ssdv_enc_feed(&ssdv, &images[n].data[pos], r);
+				pos += r;
+			}
+			if(c != SSDV_OK)
+				break;
+			for(uint32_t i=0; i<sizeof(pkt); i++)
+				*sum = *sum * 31 + pkt[i];
+			packets++;
+		}
+	}
+	return packets;
+}
+
+static double bench_encode(crc_impl_t i, uint32_t iterations, uint32_t *packets, uint32_t *sum)
+{
+	impl = i;
+	uint64_t start = now_ns();
+	for(uint32_t n=0; n<iterations; n++)
+		*packets = encode(sum);
+	return (double)(now_ns() - start) / iterations / *packets / 1000.0;
+}
+
+static double bench_crc(uint32_t (*crc)(void*, size_t), uint32_t iterations)
+{
+	static uint8_t pkt[SSDV_PKT_SIZE];
+	volatile uint32_t sink = 0;
+
+	for(uint32_t i=0; i<sizeof(pkt); i++)
+		pkt[i] = i * 7;
+	uint64_t start = now_ns();
+	for(uint32_t n=0; n<iterations * 100; n++)
+		sink ^= crc(&pkt[1], PKT_CRCDATA);
+	(void)sink;
+	return (double)(now_ns() - start) / iterations / 100 / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t iterations = argc > 1 ? atoi(argv[1]) : 20;
+
+	chMtxObjectInit(&trace_mtx);
+	SD4.fp = NULL; // No tracing
+
+	for(int i=2; i<argc; i++)
+		if(!load(argv[i]))
+			fprintf(stderr, "Could not load image %s\n", argv[i]);
+	for(int i=1; argc<=2; i++) {
+		char filename[64];
+		snprintf(filename, sizeof(filename), DEFAULT_IMAGES, i);
+		if(!load(filename))
+			break;
+	}
+
+	bool ok = check();
+	printf("CRC-32 check      %s\n", ok ? "OK" : "FAILED");
+
+	double crc_ref = bench_crc(crc32_bitwise, iterations * 100);
+	double crc_tab = bench_crc(crc32_table, iterations * 100);
+	printf("CRC of a packet   %.3f us bitwise, %.3f us slice-by-4 (%.1fx)\n", crc_ref, crc_tab, crc_ref / crc_tab);
+
+	if(image_cnt) {
+		uint32_t packets, sum_ref, sum_tab, sum_unit;
+		double enc_ref = bench_encode(CRC_BITWISE, iterations, &packets, &sum_ref);
+		double enc_tab = bench_encode(CRC_TABLE, iterations, &packets, &sum_tab);
+		bench_encode(CRC_UNIT, 1, &packets, &sum_unit);
+		ok &= sum_ref == sum_tab && sum_ref == sum_unit;
+		printf("SSDV packets      %u of %u images %s\n", packets, image_cnt,
+			   sum_ref == sum_tab && sum_ref == sum_unit ? "identical" : "DIFFER");
+		printf("Encode per packet %.2f us bitwise, %.2f us slice-by-4 (%.2fx)\n", enc_ref, enc_tab, enc_ref / enc_tab);
+	}
+
+	return ok ? 0 : 1;
+}
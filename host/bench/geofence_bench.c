@@ -0,0 +1,264 @@
+/**
+  * APRS region lookup benchmark. Compares the former lookup (all polygon
+  * tests with 32 bit arithmetic, as getAPRSRegionFrequency2m() did it), the
+  * polygon tests in 64 bit fixed point and the grid lookup (getRegion()) on
+  * random points all over the world and on points close to the polygon
+  * vertices. The results are checked against a ray casting in double
+  * precision, the grid lookup must give the same region as the polygons
+  * (the grid is generated by doc/geofence/compile.py, this checks the
+  * compiler against the firmware). All layers (APRS regions, ITU regions)
+  * are tested.
+  * Tracks drifting along the region borders count the region changes with
+  * and without hysteresis (getRegionHysteresis()).
+  *
+  * Usage: geofence_bench [points]
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "geofence.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define POLYGONS	geofence_layers[layer].cnt
+#define POLYGON(n)	(&geofence_layers[layer].polygons[n])
+#define MAX_VERTICES	1024
+
+// Referenced by geofence.c (tracing)
+SerialDriver SD4;
+mutex_t trace_mtx;
+
+static layer_t layer;	// Layer tested
+static const char *layer_names[] = {"APRS", "ITU"};
+
+// Vertices of the compiled polygons
+static coord_t vertices[MAX_VERTICES];
+static struct {
+	const coord_t *poly;
+	uint32_t size;
+} decoded[32];
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+  * Former implementation of geofence.c (32 bit, overflows on long edges)
+  */
+static bool former_polygon(const coord_t *poly, uint32_t size, int32_t lat, int32_t lon)
+{
+	bool c = false;
+	uint32_t j = size-1;
+
+	for(uint32_t i=0; i<size; i++) {
+		if((((poly[i].lat <= lat) && (lat < poly[j].lat)) || ((poly[j].lat <= lat) && (lat < poly[i].lat))) &&
+		   (lon < (int32_t)(((uint32_t)poly[j].lon - (uint32_t)poly[i].lon) * ((uint32_t)lat - (uint32_t)poly[i].lat)) / (poly[j].lat - poly[i].lat) + poly[i].lon))
+			c = !c;
+		j = i;
+	}
+
+	return c;
+}
+
+static bool double_polygon(const coord_t *poly, uint32_t size, int32_t lat, int32_t lon)
+{
+	bool c = false;
+	uint32_t j = size-1;
+
+	for(uint32_t i=0; i<size; i++) {
+		if((poly[i].lat <= lat) != (poly[j].lat <= lat)) {
+			double x = (double)(poly[j].lon - (double)poly[i].lon) * ((double)lat - poly[i].lat) / ((double)poly[j].lat - poly[i].lat) + poly[i].lon;
+			if(lon < x)
+				c = !c;
+		}
+		j = i;
+	}
+
+	return c;
+}
+
+/**
+  * Region of the polygon tests, the last region containing the point wins
+  * like in getAPRSRegionFrequency2m()
+  */
+static region_t lookup(bool (*test)(const coord_t*, uint32_t, int32_t, int32_t), int32_t lat, int32_t lon)
+{
+	region_t region = REGION_OTHER;
+	for(uint32_t n=0; n<POLYGONS; n++)
+		if(test(decoded[n].poly, decoded[n].size, lat, lon))
+			region = POLYGON(n)->region;
+	return region;
+}
+
+static region_t former(int32_t lat, int32_t lon) { return lookup(former_polygon, lat, lon); }
+static region_t reference(int32_t lat, int32_t lon) { return lookup(double_polygon, lat, lon); }
+static region_t exact(int32_t lat, int32_t lon)
+{
+	region_t region = REGION_OTHER;
+	for(uint32_t n=0; n<POLYGONS; n++)
+		if(isPointInPolygon(POLYGON(n), lat, lon))
+			region = POLYGON(n)->region;
+	return region;
+}
+
+/**
+  * Decodes the vertex differences of the polygons, the last edge must return
+  * to the first vertex and the bounding box must fit
+  */
+static bool decode(void)
+{
+	uint32_t cnt = 0;
+	bool ok = POLYGONS <= sizeof(decoded)/sizeof(decoded[0]);
+
+	for(uint32_t n=0; ok && n<POLYGONS; n++) {
+		const polygon_t *p = POLYGON(n);
+		coord_t v = p->start, min = v, max = v;
+		ok = cnt + p->size <= MAX_VERTICES;
+		decoded[n].poly = &vertices[cnt];
+		decoded[n].size = p->size;
+		for(uint32_t i=0; ok && i<p->size; i++) {
+			vertices[cnt++] = v;
+			v.lat += p->delta[2*i] * GEOFENCE_UNIT;
+			v.lon += p->delta[2*i+1] * GEOFENCE_UNIT;
+			if(v.lat < min.lat) min.lat = v.lat;
+			if(v.lat > max.lat) max.lat = v.lat;
+			if(v.lon < min.lon) min.lon = v.lon;
+			if(v.lon > max.lon) max.lon = v.lon;
+		}
+		ok &= v.lat == p->start.lat && v.lon == p->start.lon;
+		ok &= min.lat == p->min.lat && min.lon == p->min.lon && max.lat == p->max.lat && max.lon == p->max.lon;
+	}
+
+	return ok;
+}
+
+static region_t grid(int32_t lat, int32_t lon) { return getLayerRegion(layer, lat, lon); }
+
+static double bench(region_t (*f)(int32_t, int32_t), const coord_t *pts, uint32_t cnt)
+{
+	volatile uint32_t sink = 0;
+	uint64_t start = now_ns();
+	for(uint32_t i=0; i<cnt; i++)
+		sink += f(pts[i].lat, pts[i].lon);
+	(void)sink;
+	return (double)(now_ns() - start) / cnt;
+}
+
+static void run(const char *name, const coord_t *pts, uint32_t cnt, bool *ok)
+{
+	uint32_t err_former = 0, err_exact = 0, err_grid = 0;
+
+	for(uint32_t i=0; i<cnt; i++) {
+		region_t ref = reference(pts[i].lat, pts[i].lon);
+		err_former += former(pts[i].lat, pts[i].lon) != ref;
+		err_exact += exact(pts[i].lat, pts[i].lon) != ref;
+		err_grid += grid(pts[i].lat, pts[i].lon) != exact(pts[i].lat, pts[i].lon);
+	}
+	*ok &= !err_grid;
+
+	printf("%-16s %8u points, wrong region: former %u, 64 bit %u, grid differs from polygons %u\n",
+		   name, cnt, err_former, err_exact, err_grid);
+	printf("%-16s former %.0f ns, 64 bit polygons %.0f ns, grid %.1f ns per lookup\n", "",
+		   bench(former, pts, cnt), bench(exact, pts, cnt), bench(grid, pts, cnt));
+}
+
+static int32_t rnd(int32_t min, int32_t max)
+{
+	return min + (int32_t)(((uint64_t)rand() << 31 | rand()) % ((int64_t)max - min));
+}
+
+/**
+  * Random walks of the given number of track points starting at polygon
+  * vertices, steps of up to 0.02 deg (a slow balloon in a tracking cycle).
+  * Hysteresis must not keep a region further than GEOFENCE_HYSTERESIS away.
+  */
+static void tracks(uint32_t cnt, uint32_t points, bool *ok)
+{
+	uint32_t changes = 0, changes_hyst = 0, wrong = 0;
+
+	for(uint32_t i=0; i<cnt; i++) {
+		uint32_t n = rand() % POLYGONS;
+		const coord_t *v = &decoded[n].poly[rand() % decoded[n].size];
+		int32_t lat = v->lat, lon = v->lon;
+		region_t last = grid(lat, lon), hyst = last;
+
+		for(uint32_t p=0; p<points; p++) {
+			lat += rnd(-200000, 200001);
+			lon += rnd(-200000, 200001);
+			if(lat > 890000000) lat = 890000000;
+			if(lat < -890000000) lat = -890000000;
+			if(lon > 1790000000) lon = 1790000000;
+			if(lon < -1790000000) lon = -1790000000;
+
+			region_t region = grid(lat, lon);
+			changes += region != last;
+			last = region;
+
+			region = getLayerRegionHysteresis(layer, lat, lon, hyst);
+			changes_hyst += region != hyst;
+			hyst = region;
+
+			// Kept region must be within reach
+			if(hyst != last && grid(lat + GEOFENCE_HYSTERESIS, lon) != hyst && grid(lat - GEOFENCE_HYSTERESIS, lon) != hyst
+			&& grid(lat, lon + GEOFENCE_HYSTERESIS) != hyst && grid(lat, lon - GEOFENCE_HYSTERESIS) != hyst)
+				wrong++;
+		}
+	}
+	*ok &= !wrong;
+
+	printf("%-16s %8u tracks of %u points, region changes: %u, with %.1f deg hysteresis %u%s\n", "Border tracks",
+		   cnt, points, changes, GEOFENCE_HYSTERESIS / 10000000.0, changes_hyst, wrong ? " (region kept too far away)" : "");
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t cnt = argc > 1 ? atoi(argv[1]) : 200000;
+	coord_t *pts = malloc(cnt * sizeof(coord_t));
+	bool ok = true;
+	if(!cnt || !pts || sizeof(layer_names)/sizeof(layer_names[0]) != LAYERS)
+		return 1;
+
+	for(layer=0; layer<LAYERS; layer++) {
+		printf("Layer %s\n", layer_names[layer]);
+		if(!decode()) {
+			printf("Compiled polygons inconsistent\n");
+			return 1;
+		}
+		srand(1);
+
+		for(uint32_t i=0; i<cnt; i++) {
+			pts[i].lat = rnd(-900000000, 900000000);
+			pts[i].lon = rnd(-1800000000, 1800000000);
+		}
+		run("World", pts, cnt, &ok);
+
+		// Within 0.1 deg of a vertex
+		for(uint32_t i=0; i<cnt; i++) {
+			uint32_t n = rand() % POLYGONS;
+			const coord_t *v = &decoded[n].poly[rand() % decoded[n].size];
+			pts[i].lat = v->lat + rnd(-1000000, 1000000);
+			pts[i].lon = v->lon + rnd(-1000000, 1000000);
+			if(pts[i].lat > 900000000) pts[i].lat = 900000000;
+			if(pts[i].lat < -900000000) pts[i].lat = -900000000;
+			if(pts[i].lon > 1800000000) pts[i].lon = 1800000000;
+			if(pts[i].lon < -1800000000) pts[i].lon = -1800000000;
+		}
+		run("Near vertices", pts, cnt, &ok);
+
+		tracks(cnt / 100, 100, &ok);
+
+		uint32_t edges = 0;
+		for(uint32_t n=0; n<POLYGONS; n++)
+			edges += POLYGON(n)->size;
+		printf("Polygons         %u polygons, %u vertices, %u bytes\n", POLYGONS, edges, edges * 2 * (uint32_t)sizeof(int16_t));
+		printf("Grid             %dx%d cells of %d deg, %u bytes\n",
+			   GEOFENCE_ROWS, GEOFENCE_COLS, GEOFENCE_CELL / 10000000, GEOFENCE_ROWS * GEOFENCE_COLS / 2);
+	}
+
+	return ok ? 0 : 1;
+}
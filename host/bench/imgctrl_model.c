@@ -0,0 +1,215 @@
+/**
+  * Image resolution/quality controller model. Measures the complexity of
+  * recorded JPEG images (bytes per 1000 pixels at QS 12) and feeds a camera
+  * model with it, which delivers images of that complexity at any resolution
+  * and QS. Each image is captured like moduleIMG does it, once with the
+  * former strategy (RES_MAX: UXGA first, one resolution less per overflow,
+  * default QS) and once with imgctrl, and the camera inits, buffer fill and
+  * SSDV packets are compared.
+  *
+  * Usage: imgctrl_model [images] [image.jpg ...]
+  */
+
+#include "ch.h"
+#include "imgctrl.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define DEFAULT_IMAGES	"doc/sample_pictures/test%d.jpg"
+#define MAX_SCENES		16
+#define QS_EXPONENT		0.8		/* JPEG length ~ QS^-0.8 in the camera model */
+#define SCENE_LENGTH	6		/* Images of the same scene in a row */
+
+typedef struct {
+	const char *name;
+	resolution_t res;
+	uint8_t quality;
+	uint16_t packets;
+	size_t ram_size;
+	bool stream;
+} scenario_t;
+
+typedef struct {
+	uint32_t images;
+	uint32_t inits;			// Camera inits (3 s each)
+	uint32_t overflows;		// Images which didn't fit into the buffer in the end
+	uint64_t fill;			// Sum of buffer fill in 0.1%
+	uint64_t packets;		// Sum of SSDV packets
+	uint32_t over_target;	// Images with more packets than the target
+	uint64_t qs;
+	uint32_t res[RES_MAX];
+} result_t;
+
+static uint16_t scenes[MAX_SCENES];
+static uint32_t scene_cnt;
+
+/**
+  * Reads a JPEG image and returns its complexity (0 on error)
+  */
+static uint16_t measure(const char *filename)
+{
+	FILE *f = fopen(filename, "rb");
+	if(!f)
+		return 0;
+	static uint8_t d[1024*1024];
+	size_t len = fread(d, 1, sizeof(d), f);
+	fclose(f);
+
+	// Dimensions from the SOF0 header
+	uint32_t w = 0, h = 0;
+	for(size_t i=2; i+9<len && d[i]==0xFF; i+=2+(d[i+2]<<8 | d[i+3])) {
+		if(d[i+1] == 0xC0) {
+			h = d[i+5]<<8 | d[i+6];
+			w = d[i+7]<<8 | d[i+8];
+			break;
+		}
+	}
+	if(!w || !h || len <= IMGCTRL_HEADER)
+		return 0;
+
+	uint16_t c = (len - IMGCTRL_HEADER) * 1000 / (w*h);
+	printf("%-32s %ux%u %6zu bytes, complexity %u\n", filename, w, h, len, c);
+	return c;
+}
+
+/**
+  * Camera model, returns the JPEG length of the scene with a random
+  * variation of +/-15% between two captures
+  */
+static uint32_t camera(resolution_t res, uint8_t qs, uint16_t complexity)
+{
+	double var = 0.85 + 0.3 * rand() / RAND_MAX;
+	double scan = (double)imgctrl_pixels(res) * complexity / 1000 * pow((double)IMGCTRL_QS_REF / qs, QS_EXPONENT);
+	return IMGCTRL_HEADER + scan * var;
+}
+
+static uint32_t packets(uint32_t len)
+{
+	return (len - IMGCTRL_HEADER + IMGCTRL_PKT_PAYLOAD - 1) / IMGCTRL_PKT_PAYLOAD;
+}
+
+/**
+  * Captures an image, returns the JPEG length in the buffer
+  */
+static uint32_t capture(ssdv_config_t *conf, resolution_t res, uint16_t complexity, bool *overflow)
+{
+	uint32_t len = camera(res, conf->qs, complexity);
+	*overflow = !conf->stream && len > conf->ram_size;
+	return *overflow ? conf->ram_size : len;
+}
+
+static void account(result_t *r, const ssdv_config_t *conf, resolution_t res, uint32_t len, bool overflow)
+{
+	r->images++;
+	r->overflows += overflow;
+	r->fill += conf->stream ? 0 : (uint64_t)len * 1000 / conf->ram_size;
+	r->packets += packets(len);
+	r->over_target += conf->packets && packets(len) > conf->packets;
+	r->qs += conf->qs;
+	r->res[res]++;
+}
+
+/**
+  * Former strategy, RES_MAX decrements the resolution at every overflow
+  */
+static void run_former(const scenario_t *sc, ssdv_config_t *conf, uint16_t complexity, result_t *r)
+{
+	bool overflow;
+	uint32_t len;
+	resolution_t res = sc->res == RES_MAX ? RES_UXGA : sc->res;
+
+	conf->qs = IMGCTRL_QS_REF;
+	do {
+		len = capture(conf, res, complexity, &overflow);
+		r->inits++;
+	} while(sc->res == RES_MAX && overflow && res-- > RES_QVGA);
+
+	account(r, conf, overflow ? res+1 : res, len, overflow);
+}
+
+/**
+  * Controller, same loop as moduleIMG
+  */
+static void run_ctrl(const scenario_t *sc, ssdv_config_t *conf, uint16_t complexity, result_t *r)
+{
+	bool overflow;
+	uint32_t len;
+	resolution_t res;
+	uint8_t captures = sc->res == RES_MAX || !sc->quality ? IMGCTRL_CAPTURES : 1;
+
+	while(true) {
+		res = imgctrl_select(conf);
+		len = capture(conf, res, complexity, &overflow);
+		r->inits++;
+		imgctrl_update(conf, res, len, overflow);
+		if(!overflow || !--captures)
+			break;
+	}
+
+	account(r, conf, res, len, overflow);
+}
+
+static void print(const char *name, const char *strategy, const result_t *r, bool stream)
+{
+	printf("%-22s %-8s %6.2f %7.1f%% %6.1f%% %8.1f %7.1f%% %5.1f ", name, strategy,
+		   (double)r->inits / r->images, 100.0 * r->overflows / r->images,
+		   stream ? 0.0 : r->fill / 10.0 / r->images, (double)r->packets / r->images,
+		   100.0 * r->over_target / r->images, (double)r->qs / r->images);
+	const char *res[] = {"QCIF", "QVGA", "VGA", "XGA", "UXGA"};
+	for(uint32_t i=0; i<RES_MAX; i++)
+		if(r->res[i])
+			printf(" %s:%u", res[i], r->res[i]);
+	printf("\n");
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t images = argc > 1 ? atoi(argv[1]) : 240;
+
+	for(int i=2; i<argc && scene_cnt<MAX_SCENES; i++)
+		if((scenes[scene_cnt] = measure(argv[i])))
+			scene_cnt++;
+	for(int i=1; argc<=2 && scene_cnt<MAX_SCENES; i++) {
+		char filename[64];
+		snprintf(filename, sizeof(filename), DEFAULT_IMAGES, i);
+		if(!(scenes[scene_cnt] = measure(filename)))
+			break;
+		scene_cnt++;
+	}
+	if(!scene_cnt) {
+		fprintf(stderr, "No images\n");
+		return 1;
+	}
+
+	const scenario_t scenarios[] = {
+		{"RES_MAX 130k",          RES_MAX,  0,   0, 130*1024, false},
+		{"RES_MAX 130k 300 pkt",  RES_MAX,  0, 300, 130*1024, false},
+		{"RES_MAX 130k quality85",RES_MAX, 85,   0, 130*1024, false},
+		{"QVGA 20k",              RES_QVGA, 0,   0,  20*1024, false},
+		{"QVGA 20k 40 pkt",       RES_QVGA, 0,  40,  20*1024, false},
+		{"XGA stream 300 pkt",    RES_XGA,  0, 300, 130*1024, true},
+	};
+
+	printf("\n%-22s %-8s %6s %8s %7s %8s %8s %5s  resolutions\n", "Scenario", "Strategy",
+		   "inits", "overflow", "fill", "packets", ">target", "QS");
+	for(uint32_t s=0; s<sizeof(scenarios)/sizeof(scenario_t); s++) {
+		const scenario_t *sc = &scenarios[s];
+		result_t former = {0}, ctrl = {0};
+		ssdv_config_t conf_former = {.res = sc->res, .quality = sc->quality, .packets = sc->packets, .ram_size = sc->ram_size, .stream = sc->stream};
+		ssdv_config_t conf_ctrl = conf_former;
+
+		srand(1);
+		for(uint32_t i=0; i<images; i++) {
+			uint16_t complexity = scenes[(i / SCENE_LENGTH) % scene_cnt];
+			run_former(sc, &conf_former, complexity, &former);
+			run_ctrl(sc, &conf_ctrl, complexity, &ctrl);
+		}
+		print(sc->name, "former", &former, sc->stream);
+		print("", "imgctrl", &ctrl, sc->stream);
+	}
+
+	return 0;
+}
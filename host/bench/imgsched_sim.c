@@ -0,0 +1,275 @@
+/**
+  * SSDV channel simulator of the resend scheduler (imgsched). A series of
+  * images is sent over a channel which loses packets, once in order like
+  * moduleIMG did it and with several resend strategies. The ground station
+  * collects the packets and requests missing packets of the images it has
+  * seen over an uplink which loses requests as well. Resent packets must be
+  * identical to the packets sent first. For each strategy the transmissions,
+  * the images received completely and the transmissions per complete image
+  * are compared.
+  *
+  * The channel is a Gilbert model: packets are lost at the given rate on
+  * average, in bursts of the given mean length.
+  *
+  * Usage: imgsched_sim [-l loss%] [-b burst] [-u uplink loss%] [-n images] [-s seed] [image.jpg ...]
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "imgsched.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define DEFAULT_IMAGES	"doc/sample_pictures/test%d.jpg"
+#define MAX_IMAGES		8
+#define MAX_SERIES		256
+#define MAX_PACKETS		IMGSCHED_PACKETS
+#define HISTORY_SIZE	(1024*64)
+
+typedef struct {
+	const char *name;
+	uint8_t interleave;		// New packets between two resent packets
+	uint16_t early;			// Early packets resent per pass
+	bool uplink;			// Ground station requests missing packets
+	bool repeat;			// Each image sent twice (no scheduler)
+} strategy_t;
+
+static const strategy_t strategies[] = {
+	{"In order (former)",		0,  0, false, false},
+	{"Every image twice",		0,  0, false, true},
+	{"Early packets",			4, 16, false, false},
+	{"Uplink requests",			4,  0, true,  false},
+	{"Early packets + uplink",	4, 16, true,  false}
+};
+
+// Referenced by ssdv.c (tracing)
+SerialDriver SD4;
+mutex_t trace_mtx;
+void log_error(const char *file, uint16_t line);
+void log_error(const char *file, uint16_t line)
+{
+	(void)file;
+	(void)line;
+}
+
+static struct {
+	uint8_t *data;
+	size_t len;
+	uint16_t packets;
+} images[MAX_IMAGES];
+static uint32_t image_cnt;
+
+// Packets of the series (first transmission) and packets received
+static uint8_t (*sent[MAX_SERIES])[SSDV_PKT_SIZE];
+static bool received[MAX_SERIES][MAX_PACKETS];
+
+static double loss = 0.1;
+static double burst = 2.0;
+static double uplink_loss = 0.3;
+static bool channel_bad;
+
+typedef struct {
+	uint32_t tx;			// Packets transmitted
+	uint32_t resent;		// Packets resent
+	uint32_t lost;
+	uint32_t requests;		// Uplink requests sent by the ground station
+	uint32_t complete;		// Images received completely
+	uint32_t missing;		// Packets never received
+	bool mismatch;			// Resent packet differs from the first transmission
+} result_t;
+
+static bool load(const char *filename)
+{
+	FILE *f = fopen(filename, "rb");
+	if(!f || image_cnt == MAX_IMAGES)
+		return false;
+	images[image_cnt].data = malloc(1024*1024);
+	images[image_cnt].len = fread(images[image_cnt].data, 1, 1024*1024, f);
+	fclose(f);
+	image_cnt++;
+	return true;
+}
+
+/**
+  * Encodes an image of the series into sent[], returns the number of packets
+  */
+static uint16_t encode(uint32_t n)
+{
+	static uint8_t pkts[MAX_PACKETS][SSDV_PKT_SIZE];
+	ssdv_t ssdv;
+	uint16_t cnt = 0;
+	size_t pos = 0;
+	const uint8_t *data = images[n % image_cnt].data;
+	size_t len = images[n % image_cnt].len;
+	char c;
+
+	ssdv_enc_init(&ssdv, SSDV_TYPE_NORMAL, "DL7AD", n);
+	while(cnt < MAX_PACKETS) {
+		ssdv_enc_set_buffer(&ssdv, pkts[cnt]);
+		while((c = ssdv_enc_get_packet(&ssdv)) == SSDV_FEED_ME) {
+			size_t r = len - pos < 128 ? len - pos : 128;
+			if(!r)
+				break;
+			ssdv_enc_feed(&ssdv, (uint8_t*)&data[pos], r);
+			pos += r;
+		}
+		if(c != SSDV_OK)
+			break;
+		cnt++;
+	}
+	sent[n] = malloc(cnt * SSDV_PKT_SIZE);
+	memcpy(sent[n], pkts, cnt * SSDV_PKT_SIZE);
+	return cnt;
+}
+
+/**
+  * Gilbert channel, returns true if the packet arrives
+  */
+static bool channel(void)
+{
+	double r = (double)rand() / RAND_MAX;
+	if(channel_bad)
+		channel_bad = r < 1.0 - 1.0 / burst;
+	else
+		channel_bad = r < loss / (burst * (1.0 - loss));
+	return !channel_bad;
+}
+
+static void transmit(result_t *res, uint8_t id, uint16_t packet, const uint8_t *pkt)
+{
+	res->tx++;
+	if(memcmp(pkt, sent[id][packet], SSDV_PKT_SIZE))
+		res->mismatch = true;
+	if(channel())
+		received[id][packet] = true;
+	else
+		res->lost++;
+}
+
+/**
+  * Ground station: requests the missing packets of the images seen so far
+  * (the image sent last and the ones before), runs of missing packets in one
+  * request each
+  */
+static void request(result_t *res, imgsched_t *s, uint32_t last, uint16_t *packets)
+{
+	for(uint32_t n=last>=IMGSCHED_IMAGES ? last-IMGSCHED_IMAGES+1 : 0; n<=last; n++) {
+		for(uint16_t p=0; p<packets[n]; p++) {
+			if(received[n][p])
+				continue;
+			uint16_t first = p;
+			while(p < packets[n] && !received[n][p])
+				p++;
+			res->requests++;
+			if((double)rand() / RAND_MAX >= uplink_loss)
+				imgsched_request(s, n, first, p - first);
+		}
+	}
+}
+
+static void run(const strategy_t *st, uint32_t series, uint16_t *packets, result_t *res)
+{
+	static uint8_t history[HISTORY_SIZE] __attribute__((aligned(8)));
+	imgsched_t *s = imgsched_init(history, sizeof(history), "DL7AD", st->early);
+	uint8_t pkt[SSDV_PKT_SIZE];
+
+	memset(res, 0, sizeof(result_t));
+	memset(received, 0, sizeof(received));
+	channel_bad = false;
+
+	for(uint32_t n=0; n<series; n++) {
+		for(uint8_t r=0; r<(st->repeat ? 2 : 1); r++) {
+			for(uint16_t p=0; p<packets[n]; p++) {
+				transmit(res, n, p, sent[n][p]);
+
+				// Packets of the last images interleaved
+				uint8_t idx;
+				uint16_t packet;
+				if(st->interleave && (p+1) % st->interleave == 0 && imgsched_select(s, &idx, &packet)) {
+					if(!imgsched_encode(s, idx, packet, pkt))
+						res->mismatch = true;
+					transmit(res, s->img[idx].id, packet, pkt);
+					res->resent++;
+				}
+			}
+		}
+
+		if(st->interleave) {
+			imgsched_add(s, n, images[n % image_cnt].data, images[n % image_cnt].len, packets[n]);
+			if(st->uplink)
+				request(res, s, n, packets);
+		}
+	}
+
+	for(uint32_t n=0; n<series; n++) {
+		bool complete = true;
+		for(uint16_t p=0; p<packets[n]; p++)
+			if(!received[n][p]) {
+				res->missing++;
+				complete = false;
+			}
+		res->complete += complete;
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t series = 40;
+	uint32_t seed = 1;
+	bool ok = true;
+	int opt;
+
+	chMtxObjectInit(&trace_mtx);
+	SD4.fp = NULL; // No tracing
+
+	while((opt = getopt(argc, argv, "l:b:u:n:s:")) != -1) {
+		switch(opt) {
+			case 'l': loss = atof(optarg) / 100; break;
+			case 'b': burst = atof(optarg) >= 1 ? atof(optarg) : 1; break;
+			case 'u': uplink_loss = atof(optarg) / 100; break;
+			case 'n': series = atoi(optarg) < MAX_SERIES ? atoi(optarg) : MAX_SERIES; break;
+			case 's': seed = atoi(optarg); break;
+			default:
+				fprintf(stderr, "Usage: %s [-l loss%%] [-b burst] [-u uplink loss%%] [-n images] [-s seed] [image.jpg ...]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	for(int i=optind; i<argc; i++)
+		if(!load(argv[i]))
+			fprintf(stderr, "Could not load image %s\n", argv[i]);
+	for(int i=1; optind==argc; i++) {
+		char filename[64];
+		snprintf(filename, sizeof(filename), DEFAULT_IMAGES, i);
+		if(!load(filename))
+			break;
+	}
+	if(!image_cnt) {
+		fprintf(stderr, "No images\n");
+		return 1;
+	}
+
+	static uint16_t packets[MAX_SERIES];
+	uint32_t total = 0;
+	for(uint32_t n=0; n<series; n++)
+		total += packets[n] = encode(n);
+
+	printf("%u images, %u packets, %.0f%% loss in bursts of %.1f packets, %.0f%% uplink loss\n",
+		   series, total, loss * 100, burst, uplink_loss * 100);
+	printf("%-24s %7s %7s %8s %9s %8s %10s\n", "Strategy", "packets", "resent", "requests", "complete", "missing", "pkt/image");
+	for(uint32_t i=0; i<sizeof(strategies)/sizeof(strategies[0]); i++) {
+		result_t res;
+		srand(seed);
+		run(&strategies[i], series, packets, &res);
+		ok &= !res.mismatch;
+		printf("%-24s %7u %7u %8u %5u/%-3u %8u %10.1f%s\n", strategies[i].name, res.tx, res.resent, res.requests,
+			   res.complete, series, res.missing, res.complete ? (double)res.tx / res.complete : 0.0,
+			   res.mismatch ? "  (resent packets DIFFER)" : "");
+	}
+
+	return ok ? 0 : 1;
+}
+
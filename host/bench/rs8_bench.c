@@ -0,0 +1,186 @@
+/**
+  * Reed-Solomon encoder benchmark. Encodes random blocks with the table
+  * driven encode_rs_8() of rs8.c and with the former Karn loop (rs8_ref.c),
+  * checks that both produce the same parity for all shortenings (pad) and
+  * that decode_rs_8() accepts the codewords and corrects up to 16 symbol
+  * errors. Then compares the time needed per SSDV packet (RS(255,223)).
+  *
+  * The decoder implementations (scalar, SSSE3, AVX2) the CPU supports are
+  * checked against the scalar one (return value, corrected block and error
+  * locations, also with erasures and uncorrectable blocks) and their
+  * throughput is reported for clean packets and packets with symbol errors.
+  *
+  * Usage: rs8_bench [iterations]
+  */
+
+#include "rs8.h"
+#include "rs8_ref.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+
+#define NN		255
+#define NROOTS	32
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static bool check(uint32_t vectors)
+{
+	uint8_t block[NN], parity[NROOTS], ref[NROOTS];
+
+	srand(1);
+	for(uint32_t n=0; n<vectors; n++) {
+		int pad = n < 223 ? (int)n : rand() % 223;
+		int len = NN - NROOTS - pad;
+		for(int i=0; i<len; i++)
+			block[i] = n % 7 == 0 ? 0 : rand(); // Some all-zero blocks
+
+		encode_rs_8(block, parity, pad);
+		ref_encode_rs_8(block, ref, pad);
+		if(memcmp(parity, ref, NROOTS)) {
+			printf("Mismatch at vector %u, pad %d\n", n, pad);
+			return false;
+		}
+
+		// Codeword must decode, errors must be corrected
+		memcpy(&block[len], parity, NROOTS);
+		uint8_t orig[NN];
+		memcpy(orig, block, len + NROOTS);
+		int errors = rand() % (NROOTS/2 + 1);
+		for(int e=0; e<errors; e++)
+			block[rand() % (len + NROOTS)] ^= 1 + rand() % 255;
+		if(decode_rs_8(block, 0, 0, pad) < 0 || memcmp(block, orig, len + NROOTS)) {
+			printf("Decoding failed at vector %u, pad %d, %d errors\n", n, pad, errors);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+  * Decodes a copy of the block, returns the result in out
+  */
+static int decode(rs8_impl_t impl, const uint8_t *block, uint8_t *out, int *eras_pos, int no_eras, int pad)
+{
+	select_rs_8(impl);
+	memcpy(out, block, NN);
+	return decode_rs_8(out, eras_pos, no_eras, pad);
+}
+
+static bool check_decoder(rs8_impl_t impl, uint32_t vectors)
+{
+	uint8_t block[NN], ref[NN], out[NN];
+	int ref_pos[NROOTS], pos[NROOTS];
+
+	srand(2);
+	for(uint32_t n=0; n<vectors; n++) {
+		int pad = n < 223 ? (int)n : rand() % 223;
+		int len = NN - NROOTS - pad;
+		for(int i=0; i<len; i++)
+			block[i] = rand();
+		encode_rs_8(block, &block[len], pad);
+
+		// Up to 20 errors (uncorrectable beyond 16), some with erasures
+		int errors = rand() % 21;
+		int no_eras = n % 5 == 0 ? rand() % 8 : 0;
+		for(int e=0; e<errors; e++)
+			block[rand() % (len + NROOTS)] ^= 1 + rand() % 255;
+		for(int e=0; e<no_eras; e++)
+			ref_pos[e] = pos[e] = pad + rand() % (len + NROOTS);
+
+		int r = decode(RS8_SCALAR, block, ref, ref_pos, no_eras, pad);
+		int o = decode(impl, block, out, pos, no_eras, pad);
+		if(r != o || memcmp(ref, out, len + NROOTS) || (r > 0 && memcmp(ref_pos, pos, r * sizeof(int)))) {
+			printf("Decoder mismatch at vector %u, pad %d, %d errors: %d vs %d\n", n, pad, errors, r, o);
+			return false;
+		}
+	}
+	return true;
+}
+
+/**
+  * Returns decoded packets per second
+  */
+static double bench_decoder(rs8_impl_t impl, int errors, uint32_t iterations)
+{
+	uint8_t block[NN], out[NN];
+	volatile int sink = 0;
+
+	srand(3);
+	for(uint32_t i=0; i<NN - NROOTS; i++)
+		block[i] = rand();
+	encode_rs_8(block, &block[NN - NROOTS], 0);
+	for(int e=0; e<errors; e++)
+		block[e * 29 % NN] ^= 1 + e;
+
+	select_rs_8(impl);
+	uint64_t start = now_ns();
+	for(uint32_t n=0; n<iterations; n++) {
+		memcpy(out, block, NN);
+		sink += decode_rs_8(out, 0, 0, 0);
+	}
+	(void)sink;
+	return iterations * 1e9 / (now_ns() - start);
+}
+
+static double bench(void (*enc)(uint8_t*, uint8_t*, int), uint32_t iterations)
+{
+	static uint8_t block[NN];
+	uint8_t parity[NROOTS];
+	volatile uint8_t sink = 0;
+
+	for(uint32_t i=0; i<sizeof(block); i++)
+		block[i] = rand();
+	uint64_t start = now_ns();
+	for(uint32_t n=0; n<iterations; n++) {
+		block[n % (NN - NROOTS)]++;
+		enc(block, parity, 0);
+		sink ^= parity[0];
+	}
+	(void)sink;
+	return (double)(now_ns() - start) / iterations / 1000.0;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t iterations = argc > 1 ? atoi(argv[1]) : 100000;
+
+	bool ok = check(20000);
+	printf("Bit exactness     %s\n", ok ? "OK" : "FAILED");
+
+	double ref = bench(ref_encode_rs_8, iterations);
+	double opt = bench(encode_rs_8, iterations);
+	printf("RS(255,223)       %.2f us Karn loop, %.2f us table (%.1fx)\n", ref, opt, ref / opt);
+
+	const char *name[] = {"scalar", "SSSE3", "AVX2"};
+	rs8_impl_t best = get_rs_8();
+	double base[2] = {0};
+	printf("Decoder           selected %s\n", name[best]);
+	for(rs8_impl_t impl=RS8_SCALAR; impl<=RS8_AVX2; impl++) {
+		if(select_rs_8(impl)) {
+			printf("%-17s not supported\n", name[impl]);
+			continue;
+		}
+		bool eq = check_decoder(impl, 20000);
+		ok &= eq;
+		double clean = bench_decoder(impl, 0, iterations / 4);
+		double err = bench_decoder(impl, 8, iterations / 10);
+		if(impl == RS8_SCALAR) {
+			base[0] = clean;
+			base[1] = err;
+		}
+		printf("%-17s %s, %8.0f packets/s clean (%.1fx), %8.0f packets/s 8 errors (%.1fx)\n", name[impl],
+			   eq ? "identical" : "DIFFERS", clean, clean / base[0], err, err / base[1]);
+	}
+	select_rs_8(best);
+
+	return ok ? 0 : 1;
+}
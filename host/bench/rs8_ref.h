@@ -0,0 +1,12 @@
+/**
+  * Reference (Karn loop) Reed-Solomon encoder, see rs8_ref.c
+  */
+
+#ifndef __RS8_REF_H__
+#define __RS8_REF_H__
+
+#include <stdint.h>
+
+void ref_encode_rs_8(uint8_t *data, uint8_t *parity, int pad);
+
+#endif
@@ -0,0 +1,189 @@
+/**
+  * SSDV transcoder benchmark. Encodes JPEG images to SSDV packets and
+  * decodes the packets back to a JPEG, as moduleIMG and a ground station
+  * do, and reports the time per packet and the JPEG throughput. The decoded
+  * image is encoded again, which must give the same packets. Each image is
+  * also encoded with the JPEG fed in chunks of different sizes, which
+  * exercises the bit reader at chunk boundaries and must not change the
+  * packets either.
+  *
+  * Usage: ssdv_bench [iterations] [image.jpg ...]
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "ssdv.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define DEFAULT_IMAGES	"doc/sample_pictures/test%d.jpg"
+#define MAX_IMAGES		8
+#define MAX_PACKETS		4096
+#define JPEG_SIZE		(1024*1024)
+
+static const size_t chunks[] = {16, 128, 1024};
+
+// Referenced by ssdv.c (tracing)
+SerialDriver SD4;
+mutex_t trace_mtx;
+void log_error(const char *file, uint16_t line);
+void log_error(const char *file, uint16_t line)
+{
+	(void)file;
+	(void)line;
+}
+
+static struct {
+	const char *name;
+	uint8_t *data;
+	size_t len;
+} images[MAX_IMAGES];
+static uint32_t image_cnt;
+
+static uint8_t packets[MAX_PACKETS][SSDV_PKT_SIZE];
+static uint8_t jpeg[JPEG_SIZE];
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static bool load(const char *filename)
+{
+	FILE *f = fopen(filename, "rb");
+	if(!f || image_cnt == MAX_IMAGES)
+		return false;
+	images[image_cnt].data = malloc(JPEG_SIZE);
+	images[image_cnt].len = fread(images[image_cnt].data, 1, JPEG_SIZE, f);
+	images[image_cnt++].name = filename;
+	fclose(f);
+	return true;
+}
+
+/**
+  * Encodes a JPEG image into packets[], returns the number of packets
+  */
+static uint32_t encode_chunked(const uint8_t *data, size_t len, size_t chunk)
+{
+	ssdv_t ssdv;
+	uint32_t n = 0;
+	size_t pos = 0;
+	char c;
+
+	ssdv_enc_init(&ssdv, SSDV_TYPE_NORMAL, "DL7AD", 0);
+	while(n < MAX_PACKETS) {
+		ssdv_enc_set_buffer(&ssdv, packets[n]);
+		while((c = ssdv_enc_get_packet(&ssdv)) == SSDV_FEED_ME) {
+			size_t r = len - pos < chunk ? len - pos : chunk;
+			if(!r)
+				break;
+			ssdv_enc_feed(&ssdv, (uint8_t*)&data[pos], r);
+			pos += r;
+		}
+		if(c != SSDV_OK)
+			break;
+		n++;
+	}
+	return n;
+}
+
+static uint32_t encode(const uint8_t *data, size_t len)
+{
+	return encode_chunked(data, len, 128);
+}
+
+/**
+  * Decodes packets[] into jpeg[], returns the JPEG length
+  */
+static size_t decode(uint32_t n)
+{
+	ssdv_t ssdv;
+	uint8_t *out;
+	size_t len;
+
+	ssdv_dec_init(&ssdv);
+	ssdv_dec_set_buffer(&ssdv, jpeg, sizeof(jpeg));
+	for(uint32_t i=0; i<n; i++)
+		ssdv_dec_feed(&ssdv, packets[i]);
+	ssdv_dec_get_jpeg(&ssdv, &out, &len);
+	return len;
+}
+
+static uint32_t checksum(uint32_t n)
+{
+	uint32_t sum = 0;
+	for(uint32_t i=0; i<n; i++)
+		for(uint32_t j=0; j<SSDV_PKT_SIZE; j++)
+			sum = sum * 31 + packets[i][j];
+	return sum;
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t iterations = argc > 1 ? atoi(argv[1]) : 20;
+	bool ok = true;
+
+	chMtxObjectInit(&trace_mtx);
+	SD4.fp = NULL; // No tracing
+
+	for(int i=2; i<argc; i++)
+		if(!load(argv[i]))
+			fprintf(stderr, "Could not load image %s\n", argv[i]);
+	for(int i=1; argc<=2; i++) {
+		char *filename = malloc(64);
+		snprintf(filename, 64, DEFAULT_IMAGES, i);
+		if(!load(filename))
+			break;
+	}
+
+	printf("%-32s %7s %7s %10s %10s %8s", "Image", "bytes", "packets", "enc us/pkt", "dec us/pkt", "enc MB/s");
+	for(uint32_t c=0; c<sizeof(chunks)/sizeof(chunks[0]); c++)
+		printf("  feed %4zu", chunks[c]);
+	printf("\n");
+	for(uint32_t i=0; i<image_cnt; i++) {
+		uint32_t n = 0;
+		size_t len = 0;
+
+		uint64_t start = now_ns();
+		for(uint32_t r=0; r<iterations; r++)
+			n = encode(images[i].data, images[i].len);
+		uint64_t enc_ns = (now_ns() - start) / iterations;
+		if(!n) {
+			printf("%-32s not encodable\n", images[i].name);
+			ok = false;
+			continue;
+		}
+
+		start = now_ns();
+		for(uint32_t r=0; r<iterations; r++)
+			len = decode(n);
+		uint64_t dec_ns = (now_ns() - start) / iterations;
+
+		// Transcoding the decoded image gives the same packets
+		uint32_t sum = checksum(n);
+		static uint8_t copy[JPEG_SIZE];
+		memcpy(copy, jpeg, len);
+		bool same = encode(copy, len) == n && checksum(n) == sum;
+
+		printf("%-32s %7zu %7u %10.2f %10.2f %8.2f", images[i].name, images[i].len, n,
+			   enc_ns / 1000.0 / n, dec_ns / 1000.0 / n, images[i].len * 1e3 / enc_ns);
+
+		// Encoding time per packet by the size of the chunks fed
+		for(uint32_t c=0; c<sizeof(chunks)/sizeof(chunks[0]); c++) {
+			start = now_ns();
+			for(uint32_t r=0; r<iterations; r++)
+				same &= encode_chunked(images[i].data, images[i].len, chunks[c]) == n;
+			same &= checksum(n) == sum;
+			printf(" %10.2f", (now_ns() - start) / 1000.0 / iterations / n);
+		}
+		ok &= same;
+		printf("%s\n", same ? "" : "  (packets DIFFER)");
+	}
+
+	return ok ? 0 : 1;
+}
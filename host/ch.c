@@ -0,0 +1,529 @@
+/**
+  * POSIX stand-in for the ChibiOS/RT kernel. The simulated system time runs
+  * host_speedup times faster than the monotonic clock of the host. Virtual
+  * timer callbacks are executed by a separate thread holding the system lock
+  * (which is recursive, as ISRs may call chSysLockFromISR()).
+  */
+
+#include "ch.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <errno.h>
+#include <sched.h>
+
+uint32_t host_speedup = 1;
+
+static uint64_t start_ns;
+static pthread_mutex_t sys_mtx;
+static pthread_cond_t vt_cond;
+static virtual_timer_t *vt_list;
+static pthread_key_t self_key;
+
+static uint64_t mono_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+  * Converts simulated time into an absolute CLOCK_MONOTONIC timestamp
+  */
+static struct timespec sim2real(uint64_t sim_ns)
+{
+	uint64_t real = start_ns + sim_ns / host_speedup;
+	struct timespec ts = {.tv_sec = real / 1000000000ULL, .tv_nsec = real % 1000000000ULL};
+	return ts;
+}
+
+static uint64_t tick2ns(systime_t t)
+{
+	return (uint64_t)t * (1000000000ULL / CH_CFG_ST_FREQUENCY);
+}
+
+/**
+  * The simulated clock starts with the process, so the HAL may be started
+  * before the kernel like on the target
+  */
+__attribute__((constructor)) static void host_clock_init(void)
+{
+	start_ns = mono_ns();
+}
+
+/**
+  * Initializes a condition variable waiting on CLOCK_MONOTONIC
+  */
+void host_cond_init(pthread_cond_t *cond)
+{
+	pthread_condattr_t attr;
+	pthread_condattr_init(&attr);
+	pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+	pthread_cond_init(cond, &attr);
+	pthread_condattr_destroy(&attr);
+}
+
+uint64_t host_sim_ns(void)
+{
+	return (mono_ns() - start_ns) * host_speedup;
+}
+
+void host_sleep_until_ns(uint64_t sim_ns)
+{
+	struct timespec ts = sim2real(sim_ns);
+	while(clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &ts, NULL) == EINTR);
+}
+
+/**
+  * Returns the simulated time base. The upper bits of the 64 bit tick
+  * counter are dropped so the counter wraps like a 32 bit systick.
+  */
+systime_t chVTGetSystemTimeX(void)
+{
+	return (systime_t)(host_sim_ns() / (1000000000ULL / CH_CFG_ST_FREQUENCY));
+}
+
+/*===========================================================================*/
+/* Virtual timers                                                            */
+/*===========================================================================*/
+
+/**
+  * Systick thread, fires the virtual timer callbacks when due
+  */
+static void* vt_thread(void *arg)
+{
+	(void)arg;
+
+	pthread_mutex_lock(&sys_mtx);
+	while(true)
+	{
+		if(!vt_list) {
+			pthread_cond_wait(&vt_cond, &sys_mtx);
+			continue;
+		}
+
+		// Timer list is sorted by deadline (relative to now, wrapping)
+		virtual_timer_t *vtp = vt_list;
+		systime_t now = chVTGetSystemTimeX();
+		if((int32_t)(vtp->deadline - now) > 0) {
+			uint64_t sim_ns = host_sim_ns() + tick2ns(vtp->deadline - now);
+			struct timespec ts = sim2real(sim_ns);
+			pthread_cond_timedwait(&vt_cond, &sys_mtx, &ts);
+			continue;
+		}
+
+		vt_list = vtp->next;
+		vtp->armed = false;
+		vtp->func(vtp->par);
+	}
+	return NULL;
+}
+
+void chVTObjectInit(virtual_timer_t *vtp)
+{
+	vtp->next = NULL;
+	vtp->func = NULL;
+	vtp->armed = false;
+}
+
+void chVTResetI(virtual_timer_t *vtp)
+{
+	for(virtual_timer_t **p = &vt_list; *p; p = &(*p)->next) {
+		if(*p == vtp) {
+			*p = vtp->next;
+			break;
+		}
+	}
+	vtp->armed = false;
+}
+
+void chVTSetI(virtual_timer_t *vtp, systime_t delay, vtfunc_t vtfunc, void *par)
+{
+	if(vtp->armed)
+		chVTResetI(vtp);
+
+	systime_t now = chVTGetSystemTimeX();
+	vtp->deadline = now + (delay ? delay : 1);
+	vtp->func = vtfunc;
+	vtp->par = par;
+	vtp->armed = true;
+
+	// Insert sorted
+	virtual_timer_t **p = &vt_list;
+	while(*p && (int32_t)((*p)->deadline - vtp->deadline) <= 0)
+		p = &(*p)->next;
+	vtp->next = *p;
+	*p = vtp;
+
+	pthread_cond_signal(&vt_cond);
+}
+
+void chVTSet(virtual_timer_t *vtp, systime_t delay, vtfunc_t vtfunc, void *par)
+{
+	chSysLock();
+	chVTSetI(vtp, delay, vtfunc, par);
+	chSysUnlock();
+}
+
+void chVTReset(virtual_timer_t *vtp)
+{
+	chSysLock();
+	chVTResetI(vtp);
+	chSysUnlock();
+}
+
+bool chVTIsArmedI(virtual_timer_t *vtp)
+{
+	return vtp->armed;
+}
+
+/*===========================================================================*/
+/* System                                                                    */
+/*===========================================================================*/
+
+void chSysInit(void)
+{
+	pthread_mutexattr_t attr;
+	pthread_mutexattr_init(&attr);
+	pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+	pthread_mutex_init(&sys_mtx, &attr);
+	host_cond_init(&vt_cond);
+	pthread_key_create(&self_key, NULL);
+
+	pthread_t vt;
+	pthread_create(&vt, NULL, vt_thread, NULL);
+}
+
+void chSysHalt(const char *reason)
+{
+	fprintf(stderr, "chSysHalt: %s\n", reason);
+	abort();
+}
+
+void chSysLock(void)
+{
+	pthread_mutex_lock(&sys_mtx);
+}
+
+void chSysUnlock(void)
+{
+	pthread_mutex_unlock(&sys_mtx);
+}
+
+/*===========================================================================*/
+/* Threads                                                                   */
+/*===========================================================================*/
+
+static void* thd_entry(void *arg)
+{
+	thread_t *tp = (thread_t*)arg;
+	pthread_setspecific(self_key, tp);
+	if(tp->name)
+		pthread_setname_np(pthread_self(), tp->name);
+	tp->func(tp->arg);
+	return NULL;
+}
+
+thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size, const char *name, tprio_t prio, tfunc_t pf, void *arg)
+{
+	(void)heapp;
+
+	thread_t *tp = calloc(1, sizeof(thread_t));
+	if(!tp)
+		return NULL;
+	tp->name = name;
+	tp->prio = prio;
+	tp->func = pf;
+	tp->arg = arg;
+
+	// Firmware stacks are sized for Cortex-M, the host needs some more room
+	pthread_attr_t attr;
+	pthread_attr_init(&attr);
+	pthread_attr_setstacksize(&attr, size < 256*1024 ? 256*1024 : size);
+	if(pthread_create(&tp->thd, &attr, thd_entry, tp)) {
+		free(tp);
+		tp = NULL;
+	}
+	pthread_attr_destroy(&attr);
+	return tp;
+}
+
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio, tfunc_t pf, void *arg)
+{
+	(void)wsp;
+	return chThdCreateFromHeap(NULL, size, NULL, prio, pf, arg);
+}
+
+thread_t *chThdGetSelfX(void)
+{
+	return (thread_t*)pthread_getspecific(self_key);
+}
+
+void chThdExit(msg_t msg)
+{
+	thread_t *tp = chThdGetSelfX();
+	if(tp)
+		tp->exitcode = msg;
+	pthread_exit(NULL);
+}
+
+msg_t chThdWait(thread_t *tp)
+{
+	pthread_join(tp->thd, NULL);
+	msg_t msg = tp->exitcode;
+	free(tp);
+	return msg;
+}
+
+void chThdSleep(systime_t time)
+{
+	host_sleep_until_ns(host_sim_ns() + tick2ns(time));
+}
+
+void chThdSleepUntil(systime_t time)
+{
+	systime_t now = chVTGetSystemTimeX();
+	if((int32_t)(time - now) > 0)
+		chThdSleep(time - now);
+}
+
+systime_t chThdSleepUntilWindowed(systime_t prev, systime_t next)
+{
+	systime_t now = chVTGetSystemTimeX();
+	if((systime_t)(now - prev) < (systime_t)(next - prev))
+		chThdSleep(next - now);
+	return next;
+}
+
+void chThdYield(void)
+{
+	sched_yield();
+}
+
+void chRegSetThreadName(const char *name)
+{
+	thread_t *tp = chThdGetSelfX();
+	if(tp)
+		tp->name = name;
+	pthread_setname_np(pthread_self(), name);
+}
+
+/*===========================================================================*/
+/* Mutexes, semaphores, mailboxes                                            */
+/*===========================================================================*/
+
+void chMtxObjectInit(mutex_t *mp)
+{
+	pthread_mutex_init(&mp->mtx, NULL);
+	mp->initialized = true;
+}
+
+void chMtxLock(mutex_t *mp)
+{
+	chDbgAssert(mp->initialized, "mutex not initialized");
+	pthread_mutex_lock(&mp->mtx);
+}
+
+bool chMtxTryLock(mutex_t *mp)
+{
+	chDbgAssert(mp->initialized, "mutex not initialized");
+	return pthread_mutex_trylock(&mp->mtx) == 0;
+}
+
+void chMtxUnlock(mutex_t *mp)
+{
+	pthread_mutex_unlock(&mp->mtx);
+}
+
+void chSemObjectInit(semaphore_t *sp, cnt_t n)
+{
+	pthread_mutex_init(&sp->mtx, NULL);
+	host_cond_init(&sp->cond);
+	sp->cnt = n;
+}
+
+void chSemReset(semaphore_t *sp, cnt_t n)
+{
+	pthread_mutex_lock(&sp->mtx);
+	sp->cnt = n;
+	pthread_cond_broadcast(&sp->cond);
+	pthread_mutex_unlock(&sp->mtx);
+}
+
+msg_t chSemWaitTimeout(semaphore_t *sp, systime_t time)
+{
+	msg_t msg = MSG_OK;
+	uint64_t deadline = host_sim_ns() + tick2ns(time);
+	struct timespec ts = sim2real(deadline);
+
+	pthread_mutex_lock(&sp->mtx);
+	while(sp->cnt <= 0) {
+		if(time == TIME_IMMEDIATE) {
+			msg = MSG_TIMEOUT;
+			break;
+		} else if(time == TIME_INFINITE) {
+			pthread_cond_wait(&sp->cond, &sp->mtx);
+		} else if(pthread_cond_timedwait(&sp->cond, &sp->mtx, &ts) == ETIMEDOUT && sp->cnt <= 0) {
+			msg = MSG_TIMEOUT;
+			break;
+		}
+	}
+	if(msg == MSG_OK)
+		sp->cnt--;
+	pthread_mutex_unlock(&sp->mtx);
+	return msg;
+}
+
+msg_t chSemWait(semaphore_t *sp)
+{
+	return chSemWaitTimeout(sp, TIME_INFINITE);
+}
+
+void chSemSignal(semaphore_t *sp)
+{
+	pthread_mutex_lock(&sp->mtx);
+	sp->cnt++;
+	pthread_cond_signal(&sp->cond);
+	pthread_mutex_unlock(&sp->mtx);
+}
+
+cnt_t chSemGetCounterI(semaphore_t *sp)
+{
+	return sp->cnt;
+}
+
+void chBSemSignal(binary_semaphore_t *bsp)
+{
+	pthread_mutex_lock(&bsp->sem.mtx);
+	if(bsp->sem.cnt < 1)
+		bsp->sem.cnt++;
+	pthread_cond_signal(&bsp->sem.cond);
+	pthread_mutex_unlock(&bsp->sem.mtx);
+}
+
+void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n)
+{
+	mbp->buffer = mbp->wrptr = mbp->rdptr = buf;
+	mbp->top = &buf[n];
+	chSemObjectInit(&mbp->emptysem, n);
+	chSemObjectInit(&mbp->fullsem, 0);
+	pthread_mutex_init(&mbp->mtx, NULL);
+}
+
+void chMBReset(mailbox_t *mbp)
+{
+	pthread_mutex_lock(&mbp->mtx);
+	mbp->wrptr = mbp->rdptr = mbp->buffer;
+	chSemReset(&mbp->emptysem, mbp->top - mbp->buffer);
+	chSemReset(&mbp->fullsem, 0);
+	pthread_mutex_unlock(&mbp->mtx);
+}
+
+msg_t chMBPost(mailbox_t *mbp, msg_t msg, systime_t timeout)
+{
+	msg_t rdymsg = chSemWaitTimeout(&mbp->emptysem, timeout);
+	if(rdymsg == MSG_OK) {
+		pthread_mutex_lock(&mbp->mtx);
+		*mbp->wrptr++ = msg;
+		if(mbp->wrptr >= mbp->top)
+			mbp->wrptr = mbp->buffer;
+		pthread_mutex_unlock(&mbp->mtx);
+		chSemSignal(&mbp->fullsem);
+	}
+	return rdymsg;
+}
+
+msg_t chMBPostAhead(mailbox_t *mbp, msg_t msg, systime_t timeout)
+{
+	msg_t rdymsg = chSemWaitTimeout(&mbp->emptysem, timeout);
+	if(rdymsg == MSG_OK) {
+		pthread_mutex_lock(&mbp->mtx);
+		if(--mbp->rdptr < mbp->buffer)
+			mbp->rdptr = mbp->top - 1;
+		*mbp->rdptr = msg;
+		pthread_mutex_unlock(&mbp->mtx);
+		chSemSignal(&mbp->fullsem);
+	}
+	return rdymsg;
+}
+
+msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout)
+{
+	msg_t rdymsg = chSemWaitTimeout(&mbp->fullsem, timeout);
+	if(rdymsg == MSG_OK) {
+		pthread_mutex_lock(&mbp->mtx);
+		*msgp = *mbp->rdptr++;
+		if(mbp->rdptr >= mbp->top)
+			mbp->rdptr = mbp->buffer;
+		pthread_mutex_unlock(&mbp->mtx);
+		chSemSignal(&mbp->emptysem);
+	}
+	return rdymsg;
+}
+
+cnt_t chMBGetUsedCountI(mailbox_t *mbp)
+{
+	return chSemGetCounterI(&mbp->fullsem);
+}
+
+cnt_t chMBGetFreeCountI(mailbox_t *mbp)
+{
+	return chSemGetCounterI(&mbp->emptysem);
+}
+
+/*===========================================================================*/
+/* Memory                                                                    */
+/*===========================================================================*/
+
+void *chHeapAlloc(memory_heap_t *heapp, size_t size)
+{
+	(void)heapp;
+	return malloc(size);
+}
+
+void chHeapFree(void *p)
+{
+	free(p);
+}
+
+void *chCoreAlloc(size_t size)
+{
+	return malloc(size);
+}
+
+
+void chGuardedPoolObjectInit(guarded_memory_pool_t *gmp, size_t size)
+{
+	chSemObjectInit(&gmp->sem, 0);
+	pthread_mutex_init(&gmp->mtx, NULL);
+	gmp->next = NULL;
+	gmp->object_size = size;
+}
+
+void chGuardedPoolLoadArray(guarded_memory_pool_t *gmp, void *p, size_t n)
+{
+	for(size_t i=0; i<n; i++)
+		chGuardedPoolFree(gmp, (uint8_t*)p + i * gmp->object_size);
+}
+
+void *chGuardedPoolAllocTimeout(guarded_memory_pool_t *gmp, systime_t timeout)
+{
+	if(chSemWaitTimeout(&gmp->sem, timeout) != MSG_OK)
+		return NULL;
+
+	pthread_mutex_lock(&gmp->mtx);
+	void *objp = gmp->next;
+	gmp->next = *(void**)objp;
+	pthread_mutex_unlock(&gmp->mtx);
+	return objp;
+}
+
+void chGuardedPoolFree(guarded_memory_pool_t *gmp, void *objp)
+{
+	pthread_mutex_lock(&gmp->mtx);
+	*(void**)objp = gmp->next;
+	gmp->next = objp;
+	pthread_mutex_unlock(&gmp->mtx);
+	chSemSignal(&gmp->sem);
+}
@@ -0,0 +1,232 @@
+/**
+  * POSIX stand-in for the ChibiOS/RT kernel API used by the firmware. Threads
+  * are mapped onto pthreads, the system tick is derived from the monotonic
+  * clock multiplied by a speedup factor so the firmware runs faster than
+  * real time. Only the API subset used in this project is provided.
+  */
+
+#ifndef __HOST_CH_H__
+#define __HOST_CH_H__
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <pthread.h>
+
+#include "chconf.h"
+
+#ifndef TRUE
+#define TRUE	1
+#endif
+#ifndef FALSE
+#define FALSE	0
+#endif
+
+/*===========================================================================*/
+/* Types                                                                     */
+/*===========================================================================*/
+
+typedef uint32_t systime_t;
+typedef intptr_t msg_t;			// Large enough for pointers (posted to mailboxes)
+typedef uint32_t tprio_t;
+typedef int32_t cnt_t;
+typedef uint32_t eventmask_t;
+
+#define MSG_OK				(msg_t)0
+#define MSG_TIMEOUT			(msg_t)-1
+#define MSG_RESET			(msg_t)-2
+
+#define TIME_IMMEDIATE		((systime_t)0)
+#define TIME_INFINITE		((systime_t)-1)
+
+#define IDLEPRIO			1
+#define LOWPRIO				2
+#define NORMALPRIO			128
+#define HIGHPRIO			255
+
+typedef void (*tfunc_t)(void *p);
+typedef void (*vtfunc_t)(void *p);
+
+typedef struct thread {
+	pthread_t		thd;
+	const char		*name;
+	tprio_t			prio;
+	tfunc_t			func;
+	void			*arg;
+	msg_t			exitcode;
+} thread_t;
+
+typedef struct {
+	pthread_mutex_t	mtx;
+	bool			initialized;
+} mutex_t;
+
+typedef struct {
+	pthread_mutex_t	mtx;
+	pthread_cond_t	cond;
+	cnt_t			cnt;
+} semaphore_t;
+
+typedef struct {
+	semaphore_t		sem;
+} binary_semaphore_t;
+
+typedef struct {
+	msg_t			*buffer;
+	msg_t			*top;
+	msg_t			*wrptr;
+	msg_t			*rdptr;
+	semaphore_t		fullsem;
+	semaphore_t		emptysem;
+	pthread_mutex_t	mtx;
+} mailbox_t;
+
+typedef struct {
+	semaphore_t		sem;
+	void			*next;			// Free list
+	size_t			object_size;
+	pthread_mutex_t	mtx;
+} guarded_memory_pool_t;
+
+typedef struct virtual_timer {
+	struct virtual_timer	*next;
+	systime_t				deadline;
+	vtfunc_t				func;
+	void					*par;
+	bool					armed;
+} virtual_timer_t;
+
+typedef struct memory_heap memory_heap_t;
+
+/*===========================================================================*/
+/* Time conversion                                                           */
+/*===========================================================================*/
+
+#define S2ST(sec)	((systime_t)((uint64_t)(sec) * CH_CFG_ST_FREQUENCY))
+#define MS2ST(msec)	((systime_t)((((uint64_t)(msec) * CH_CFG_ST_FREQUENCY) + 999ULL) / 1000ULL))
+#define US2ST(usec)	((systime_t)((((uint64_t)(usec) * CH_CFG_ST_FREQUENCY) + 999999ULL) / 1000000ULL))
+#define ST2S(n)		((uint32_t)(((uint64_t)(n) + CH_CFG_ST_FREQUENCY - 1ULL) / CH_CFG_ST_FREQUENCY))
+#define ST2MS(n)	((uint32_t)((((uint64_t)(n) * 1000ULL) + CH_CFG_ST_FREQUENCY - 1ULL) / CH_CFG_ST_FREQUENCY))
+#define ST2US(n)	((uint32_t)((((uint64_t)(n) * 1000000ULL) + CH_CFG_ST_FREQUENCY - 1ULL) / CH_CFG_ST_FREQUENCY))
+
+/*===========================================================================*/
+/* Threads                                                                   */
+/*===========================================================================*/
+
+#define THD_FUNCTION(tname, arg)			void tname(void *arg)
+#define THD_WORKING_AREA_SIZE(n)			((size_t)(n))
+#define THD_WORKING_AREA(s, n)				uint8_t s[THD_WORKING_AREA_SIZE(n)]
+
+#define CH_FAST_IRQ_HANDLER(id)				void id(void)
+#define CH_IRQ_HANDLER(id)					void id(void)
+#define CH_IRQ_PROLOGUE()
+#define CH_IRQ_EPILOGUE()
+
+#define chDbgAssert(c, r)					do { if(!(c)) chSysHalt(r); } while(0)
+#define chDbgCheck(c)						chDbgAssert(c, __func__)
+
+thread_t *chThdCreateFromHeap(memory_heap_t *heapp, size_t size, const char *name, tprio_t prio, tfunc_t pf, void *arg);
+thread_t *chThdCreateStatic(void *wsp, size_t size, tprio_t prio, tfunc_t pf, void *arg);
+thread_t *chThdGetSelfX(void);
+void chThdExit(msg_t msg);
+msg_t chThdWait(thread_t *tp);
+void chThdSleep(systime_t time);
+void chThdSleepUntil(systime_t time);
+systime_t chThdSleepUntilWindowed(systime_t prev, systime_t next);
+void chThdYield(void);
+void chRegSetThreadName(const char *name);
+
+#define chThdSleepSeconds(sec)				chThdSleep(S2ST(sec))
+#define chThdSleepMilliseconds(msec)		chThdSleep(MS2ST(msec))
+#define chThdSleepMicroseconds(usec)		chThdSleep(US2ST(usec))
+
+/*===========================================================================*/
+/* System                                                                    */
+/*===========================================================================*/
+
+void chSysInit(void);
+void chSysHalt(const char *reason);
+void chSysLock(void);
+void chSysUnlock(void);
+
+#define chSysLockFromISR()					chSysLock()
+#define chSysUnlockFromISR()				chSysUnlock()
+#define chSchRescheduleS()
+
+systime_t chVTGetSystemTimeX(void);
+#define chVTGetSystemTime()					chVTGetSystemTimeX()
+#define chVTTimeElapsedSinceX(start)		((systime_t)(chVTGetSystemTimeX() - (start)))
+#define chVTIsSystemTimeWithinX(start, end)	((systime_t)(chVTGetSystemTimeX() - (start)) < (systime_t)((end) - (start)))
+
+void chVTObjectInit(virtual_timer_t *vtp);
+void chVTSetI(virtual_timer_t *vtp, systime_t delay, vtfunc_t vtfunc, void *par);
+void chVTSet(virtual_timer_t *vtp, systime_t delay, vtfunc_t vtfunc, void *par);
+void chVTResetI(virtual_timer_t *vtp);
+void chVTReset(virtual_timer_t *vtp);
+bool chVTIsArmedI(virtual_timer_t *vtp);
+#define chVTIsArmed(vtp)					chVTIsArmedI(vtp)
+
+/*===========================================================================*/
+/* Synchronization                                                           */
+/*===========================================================================*/
+
+#define MUTEX_DECL(name)	mutex_t name = {PTHREAD_MUTEX_INITIALIZER, true}
+
+void chMtxObjectInit(mutex_t *mp);
+void chMtxLock(mutex_t *mp);
+bool chMtxTryLock(mutex_t *mp);
+void chMtxUnlock(mutex_t *mp);
+
+void chSemObjectInit(semaphore_t *sp, cnt_t n);
+void chSemReset(semaphore_t *sp, cnt_t n);
+msg_t chSemWait(semaphore_t *sp);
+msg_t chSemWaitTimeout(semaphore_t *sp, systime_t time);
+void chSemSignal(semaphore_t *sp);
+cnt_t chSemGetCounterI(semaphore_t *sp);
+#define chSemSignalI(sp)					chSemSignal(sp)
+#define chSemResetI(sp, n)					chSemReset(sp, n)
+
+#define chBSemObjectInit(bsp, taken)		chSemObjectInit(&(bsp)->sem, (taken) ? 0 : 1)
+#define chBSemWait(bsp)						chSemWait(&(bsp)->sem)
+#define chBSemWaitTimeout(bsp, time)		chSemWaitTimeout(&(bsp)->sem, time)
+void chBSemSignal(binary_semaphore_t *bsp);
+#define chBSemSignalI(bsp)					chBSemSignal(bsp)
+#define chBSemReset(bsp, taken)				chSemReset(&(bsp)->sem, (taken) ? 0 : 1)
+#define chBSemResetI(bsp, taken)			chBSemReset(bsp, taken)
+
+void chMBObjectInit(mailbox_t *mbp, msg_t *buf, cnt_t n);
+void chMBReset(mailbox_t *mbp);
+msg_t chMBPost(mailbox_t *mbp, msg_t msg, systime_t timeout);
+msg_t chMBPostAhead(mailbox_t *mbp, msg_t msg, systime_t timeout);
+msg_t chMBFetch(mailbox_t *mbp, msg_t *msgp, systime_t timeout);
+cnt_t chMBGetUsedCountI(mailbox_t *mbp);
+cnt_t chMBGetFreeCountI(mailbox_t *mbp);
+#define chMBPostI(mbp, msg)					chMBPost(mbp, msg, TIME_IMMEDIATE)
+#define chMBPostAheadI(mbp, msg)			chMBPostAhead(mbp, msg, TIME_IMMEDIATE)
+#define chMBFetchI(mbp, msgp)				chMBFetch(mbp, msgp, TIME_IMMEDIATE)
+
+/*===========================================================================*/
+/* Memory                                                                    */
+/*===========================================================================*/
+
+void *chHeapAlloc(memory_heap_t *heapp, size_t size);
+void chHeapFree(void *p);
+void *chCoreAlloc(size_t size);
+
+void chGuardedPoolObjectInit(guarded_memory_pool_t *gmp, size_t size);
+void chGuardedPoolLoadArray(guarded_memory_pool_t *gmp, void *p, size_t n);
+void *chGuardedPoolAllocTimeout(guarded_memory_pool_t *gmp, systime_t timeout);
+void chGuardedPoolFree(guarded_memory_pool_t *gmp, void *objp);
+
+/*===========================================================================*/
+/* Simulation control (host only)                                            */
+/*===========================================================================*/
+
+extern uint32_t host_speedup;		// Simulated seconds per real second
+
+uint64_t host_sim_ns(void);
+void host_sleep_until_ns(uint64_t sim_ns);
+void host_cond_init(pthread_cond_t *cond);
+
+#endif
+
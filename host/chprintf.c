@@ -0,0 +1,28 @@
+#include "chprintf.h"
+#include <stdio.h>
+
+int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap)
+{
+	if(!chp->fp) // Stream disabled
+		return 0;
+	return vfprintf(chp->fp, fmt, ap);
+}
+
+int chprintf(BaseSequentialStream *chp, const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	int n = chvprintf(chp, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
+int chsnprintf(char *str, size_t size, const char *fmt, ...)
+{
+	va_list ap;
+	va_start(ap, fmt);
+	int n = vsnprintf(str, size, fmt, ap);
+	va_end(ap);
+	return n;
+}
+
@@ -0,0 +1,16 @@
+/**
+  * Formatted output for the host build, mapped onto the C library
+  */
+
+#ifndef __HOST_CHPRINTF_H__
+#define __HOST_CHPRINTF_H__
+
+#include <stdarg.h>
+#include "hal.h"
+
+int chvprintf(BaseSequentialStream *chp, const char *fmt, va_list ap);
+int chprintf(BaseSequentialStream *chp, const char *fmt, ...);
+int chsnprintf(char *str, size_t size, const char *fmt, ...);
+
+#endif
+
@@ -0,0 +1,387 @@
+/**
+  * POSIX stand-in for the ChibiOS/HAL
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include <string.h>
+#include <time.h>
+
+stm32_gpio_t host_gpio[11];
+stm32_tim_t host_tim1;
+stm32_tim_t host_tim7;
+stm32_rcc_t host_rcc;
+stm32_dma_stream_t host_dma_streams[16];
+SPIDriver SPID2;
+EXTDriver EXTD1;
+SerialDriver SD4;
+RTCDriver RTCD1;
+host_tim_stats_t host_tim1_stats;
+host_tim_stats_t host_tim7_stats;
+host_dma_stats_t host_dma_stats[16];
+
+static pthread_mutex_t nvic_mtx = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t nvic_cond;
+static bool tim7_vector;
+static uint32_t tim7_enables;	// Counts nvicEnableVector() calls
+
+/**
+  * Emulated timer. The update event raises an interrupt (irq) or a DMA
+  * request on the given stream and channel.
+  */
+typedef struct {
+	stm32_tim_t			*tim;
+	host_tim_stats_t	*stats;
+	uint32_t			clock;
+	bool				*vector;		// Interrupt vector enabled (NULL: no interrupt)
+	uint32_t			*enables;		// Number of vector enables
+	void				(*handler)(void);
+	uint32_t			dma;			// Stream ID of the update DMA request
+	uint32_t			chsel;			// Channel of the update DMA request
+} host_tim_t;
+
+/**
+  * Default handler, replaced by the firmware if it uses TIM7
+  */
+__attribute__((weak)) CH_FAST_IRQ_HANDLER(STM32_TIM7_HANDLER)
+{
+	TIM7->CR1 &= ~STM32_TIM_CR1_CEN;
+	TIM7->SR &= ~STM32_TIM_SR_UIF;
+}
+
+static host_tim_t host_tims[] = {
+	{TIM1, &host_tim1_stats, STM32_TIMCLK2, NULL, NULL, NULL, STM32_DMA_STREAM_ID(2, 5), 6},
+	{TIM7, &host_tim7_stats, STM32_TIMCLK1, &tim7_vector, &tim7_enables, STM32_TIM7_HANDLER, STM32_DMA_STREAM_ID(1, 2), 1}
+};
+
+void nvicEnableVector(uint32_t n, uint32_t prio)
+{
+	(void)prio;
+
+	if(n == TIM7_IRQn) {
+		pthread_mutex_lock(&nvic_mtx);
+		tim7_vector = true;
+		tim7_enables++;
+		pthread_cond_broadcast(&nvic_cond);
+		pthread_mutex_unlock(&nvic_mtx);
+	}
+}
+
+void nvicDisableVector(uint32_t n)
+{
+	if(n == TIM7_IRQn)
+		tim7_vector = false;
+}
+
+/*===========================================================================*/
+/* DMA                                                                       */
+/*===========================================================================*/
+
+bool dmaStreamAllocate(const stm32_dma_stream_t *dmastp, uint32_t priority, stm32_dmaisr_t func, void *param)
+{
+	(void)priority;
+
+	stm32_dma_stream_t *stream = (stm32_dma_stream_t*)dmastp;
+	stream->isr = func;
+	stream->param = param;
+	return false;
+}
+
+void dmaStreamRelease(const stm32_dma_stream_t *dmastp)
+{
+	stm32_dma_stream_t *stream = (stm32_dma_stream_t*)dmastp;
+	stream->isr = NULL;
+}
+
+void dmaStreamEnable(const stm32_dma_stream_t *dmastp)
+{
+	pthread_mutex_lock(&nvic_mtx);
+	((stm32_dma_stream_t*)dmastp)->CR |= STM32_DMA_CR_EN;
+	pthread_cond_broadcast(&nvic_cond);
+	pthread_mutex_unlock(&nvic_mtx);
+}
+
+void dmaStreamDisable(const stm32_dma_stream_t *dmastp)
+{
+	((stm32_dma_stream_t*)dmastp)->CR &= ~STM32_DMA_CR_EN;
+}
+
+/**
+  * Peripheral side of a DMA transfer. Writes to a GPIO BSRR register are
+  * applied to the output register.
+  */
+static void periph_write(void *addr, uint32_t value)
+{
+	for(uint32_t i=0; i<sizeof(host_gpio)/sizeof(stm32_gpio_t); i++) {
+		if(addr == (void*)&host_gpio[i].BSRR.W) {
+			__atomic_or_fetch(&host_gpio[i].ODR, value & 0xFFFF, __ATOMIC_SEQ_CST);
+			__atomic_and_fetch(&host_gpio[i].ODR, ~(value >> 16), __ATOMIC_SEQ_CST);
+			return;
+		}
+	}
+	*(volatile uint32_t*)addr = value;
+}
+
+/**
+  * Serves a DMA request (memory to peripheral, word size)
+  */
+static void dma_request(uint32_t id, uint32_t chsel)
+{
+	stm32_dma_stream_t *stream = &host_dma_streams[id];
+	if(!(stream->CR & STM32_DMA_CR_EN) || (stream->CR & STM32_DMA_CR_CHSEL_MASK) != STM32_DMA_CR_CHSEL(chsel))
+		return;
+
+	uint32_t *mem = stream->memory;
+	periph_write(stream->periph, mem[(stream->CR & STM32_DMA_CR_MINC) ? stream->size - stream->NDTR : 0]);
+	host_dma_stats[id].transfers++;
+
+	uint32_t flags = 0;
+	if(--stream->NDTR == stream->size / 2 && (stream->CR & STM32_DMA_CR_HTIE))
+		flags |= STM32_DMA_ISR_HTIF;
+	if(!stream->NDTR) {
+		if(stream->CR & STM32_DMA_CR_TCIE)
+			flags |= STM32_DMA_ISR_TCIF;
+		if(stream->CR & STM32_DMA_CR_CIRC)
+			stream->NDTR = stream->size;
+		else
+			stream->CR &= ~STM32_DMA_CR_EN;
+	}
+
+	if(flags && stream->isr) {
+		host_dma_stats[id].interrupts++;
+		stream->isr(stream->param, flags);
+	}
+}
+
+/*===========================================================================*/
+/* Timers                                                                    */
+/*===========================================================================*/
+
+static uint64_t tim_period_ns(host_tim_t *t)
+{
+	return (uint64_t)(t->tim->PSC + 1) * (t->tim->ARR + 1) * 1000000000ULL / t->clock;
+}
+
+/**
+  * Timer may produce interrupts or DMA requests
+  */
+static bool tim_armed(host_tim_t *t)
+{
+	return t->vector ? *t->vector : (host_dma_streams[t->dma].CR & STM32_DMA_CR_EN) != 0;
+}
+
+static bool tim_running(host_tim_t *t)
+{
+	uint32_t events = t->vector ? STM32_TIM_DIER_UIE : STM32_TIM_DIER_UDE;
+	return tim_armed(t) && (t->tim->CR1 & STM32_TIM_CR1_CEN) && (t->tim->DIER & events);
+}
+
+/**
+  * Basic timer emulation. The update event is raised at the rate given by
+  * PSC and ARR in simulated time. Events are served in batches of up to one
+  * simulated millisecond to keep the number of host wakeups low.
+  */
+static void* tim_thread(void *arg)
+{
+	host_tim_t *t = arg;
+
+	while(true)
+	{
+		// Wait for counter enable (firmware enables the vector or DMA stream right before)
+		pthread_mutex_lock(&nvic_mtx);
+		while(!tim_running(t)) {
+			if(!tim_armed(t)) {
+				pthread_cond_wait(&nvic_cond, &nvic_mtx);
+				continue;
+			}
+
+			// Vector or DMA stream enabled, poll for the counter enable bit
+			struct timespec ts;
+			clock_gettime(CLOCK_MONOTONIC, &ts);
+			ts.tv_nsec += 100000;
+			if(ts.tv_nsec >= 1000000000) {
+				ts.tv_sec++;
+				ts.tv_nsec -= 1000000000;
+			}
+			pthread_cond_timedwait(&nvic_cond, &nvic_mtx, &ts);
+		}
+		uint32_t enables = t->enables ? *t->enables : 0;
+		pthread_mutex_unlock(&nvic_mtx);
+
+		uint64_t start = host_sim_ns();
+		uint64_t next = start + tim_period_ns(t);
+		t->stats->starts++;
+
+		while(t->tim->CR1 & STM32_TIM_CR1_CEN)
+		{
+			uint64_t now = host_sim_ns();
+			while(next <= now && (t->tim->CR1 & STM32_TIM_CR1_CEN)) {
+				if(t->vector && (t->tim->DIER & STM32_TIM_DIER_UIE)) {
+					t->tim->SR |= STM32_TIM_SR_UIF;
+					t->handler();
+				}
+				if(t->tim->DIER & STM32_TIM_DIER_UDE)
+					dma_request(t->dma, t->chsel);
+				t->stats->updates++;
+				next += tim_period_ns(t);
+			}
+			host_sleep_until_ns(next > now + 1000000 ? next : now + 1000000);
+		}
+
+		t->stats->active_ns += next - start;
+
+		// Sleep until the firmware enables the vector again (unless it did already)
+		pthread_mutex_lock(&nvic_mtx);
+		if(t->vector && *t->enables == enables)
+			*t->vector = false;
+		pthread_mutex_unlock(&nvic_mtx);
+	}
+	return NULL;
+}
+
+/*===========================================================================*/
+/* EXT                                                                       */
+/*===========================================================================*/
+
+void extStart(EXTDriver *extp, const EXTConfig *config)
+{
+	extp->config = config;
+	extp->enabled = 0;
+}
+
+void extChannelEnable(EXTDriver *extp, expchannel_t channel)
+{
+	__atomic_or_fetch(&extp->enabled, 1U << channel, __ATOMIC_SEQ_CST);
+}
+
+void extChannelDisable(EXTDriver *extp, expchannel_t channel)
+{
+	__atomic_and_fetch(&extp->enabled, ~(1U << channel), __ATOMIC_SEQ_CST);
+}
+
+/**
+  * EXTI line of the pad, the callback is called if the line is enabled for
+  * this port and edge
+  */
+void host_ext_edge(ioportid_t port, uint32_t pad, bool rising)
+{
+	EXTDriver *extp = &EXTD1;
+	if(!extp->config || !(extp->enabled & (1U << pad)))
+		return;
+
+	const EXTChannelConfig *ch = &extp->config->channels[pad];
+	uint32_t edges = ch->mode & EXT_CH_MODE_EDGES_MASK;
+	if((uint32_t)(port - host_gpio) != ch->mode >> EXT_MODE_GPIO_OFF)
+		return;
+	if(edges & (rising ? EXT_CH_MODE_RISING_EDGE : EXT_CH_MODE_FALLING_EDGE))
+		ch->cb(extp, pad);
+}
+
+/*===========================================================================*/
+/* SPI                                                                       */
+/*===========================================================================*/
+
+void spiStart(SPIDriver *spip, const SPIConfig *config)
+{
+	spip->config = config;
+}
+
+void spiStop(SPIDriver *spip)
+{
+	spip->config = NULL;
+}
+
+void spiAcquireBus(SPIDriver *spip)
+{
+	chMtxLock(&spip->mutex);
+}
+
+void spiReleaseBus(SPIDriver *spip)
+{
+	chMtxUnlock(&spip->mutex);
+}
+
+void spiSelect(SPIDriver *spip)
+{
+	palClearPad(spip->config->ssport, spip->config->sspad);
+}
+
+void spiUnselect(SPIDriver *spip)
+{
+	palSetPad(spip->config->ssport, spip->config->sspad);
+}
+
+void spiExchange(SPIDriver *spip, size_t n, const void *txbuf, void *rxbuf)
+{
+	host_spi_exchange(spip, n, txbuf, rxbuf);
+}
+
+void spiSend(SPIDriver *spip, size_t n, const void *txbuf)
+{
+	uint8_t rxbuf[n];
+	host_spi_exchange(spip, n, txbuf, rxbuf);
+}
+
+void spiReceive(SPIDriver *spip, size_t n, void *rxbuf)
+{
+	uint8_t txbuf[n];
+	memset(txbuf, 0xFF, n);
+	host_spi_exchange(spip, n, txbuf, rxbuf);
+}
+
+/*===========================================================================*/
+/* Serial                                                                    */
+/*===========================================================================*/
+
+void sdStart(SerialDriver *sdp, const SerialConfig *config)
+{
+	(void)config;
+	if(!sdp->fp)
+		sdp->fp = stdout;
+}
+
+/*===========================================================================*/
+/* RTC (year counted from 2000 like in ptime.c)                              */
+/*===========================================================================*/
+
+void rtcGetTime(RTCDriver *rtcp, RTCDateTime *timespec)
+{
+	int64_t ms = (int64_t)(host_sim_ns() / 1000000) + rtcp->offset_ms;
+	time_t t = ms / 1000;
+	struct tm tm;
+	gmtime_r(&t, &tm);
+
+	timespec->year = tm.tm_year - 100;
+	timespec->month = tm.tm_mon + 1;
+	timespec->dstflag = 0;
+	timespec->dayofweek = tm.tm_wday ? tm.tm_wday : 7;
+	timespec->day = tm.tm_mday;
+	timespec->millisecond = (tm.tm_hour * 3600 + tm.tm_min * 60 + tm.tm_sec) * 1000 + ms % 1000;
+}
+
+void rtcSetTime(RTCDriver *rtcp, const RTCDateTime *timespec)
+{
+	struct tm tm = {
+		.tm_year = timespec->year + 100,
+		.tm_mon = timespec->month - 1,
+		.tm_mday = timespec->day
+	};
+	int64_t ms = (int64_t)timegm(&tm) * 1000 + timespec->millisecond;
+	rtcp->offset_ms = ms - (int64_t)(host_sim_ns() / 1000000);
+}
+
+/*===========================================================================*/
+/* HAL                                                                       */
+/*===========================================================================*/
+
+void halInit(void)
+{
+	chMtxObjectInit(&SPID2.mutex);
+	host_cond_init(&nvic_cond);
+
+	for(uint32_t i=0; i<sizeof(host_tims)/sizeof(host_tim_t); i++) {
+		pthread_t tim;
+		pthread_create(&tim, NULL, tim_thread, &host_tims[i]);
+	}
+}
+
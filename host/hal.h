@@ -0,0 +1,363 @@
+/**
+  * POSIX stand-in for the ChibiOS/HAL subset used by the firmware. GPIO ports
+  * and timers are plain structures in RAM. Timer update interrupts and DMA
+  * requests are emulated by a host thread per timer at the rate programmed
+  * into PSC/ARR, SPI transfers are routed to the device models in host/stubs.
+  */
+
+#ifndef __HOST_HAL_H__
+#define __HOST_HAL_H__
+
+#include "ch.h"
+#include "board.h"
+#include <stdio.h>
+
+/*===========================================================================*/
+/* PAL                                                                       */
+/*===========================================================================*/
+
+typedef struct {
+	volatile uint32_t	MODER;
+	volatile uint32_t	IDR;
+	volatile uint32_t	ODR;
+	volatile union {
+		uint32_t		W;
+		struct {
+			uint16_t	set;
+			uint16_t	clear;
+		} H;
+	} BSRR;							// Written by the DMA emulation only
+} stm32_gpio_t;
+
+typedef stm32_gpio_t* ioportid_t;
+typedef uint32_t iopadid_t;
+typedef uint32_t iomode_t;
+typedef uint32_t ioline_t;
+
+extern stm32_gpio_t host_gpio[11];
+
+#define GPIOA	(&host_gpio[0])
+#define GPIOB	(&host_gpio[1])
+#define GPIOC	(&host_gpio[2])
+#define GPIOD	(&host_gpio[3])
+#define GPIOE	(&host_gpio[4])
+#define GPIOF	(&host_gpio[5])
+#define GPIOG	(&host_gpio[6])
+#define GPIOH	(&host_gpio[7])
+#define GPIOI	(&host_gpio[8])
+#define GPIOJ	(&host_gpio[9])
+#define GPIOK	(&host_gpio[10])
+
+#define PAL_LOW								0U
+#define PAL_HIGH							1U
+#define PAL_MODE_RESET						0U
+#define PAL_MODE_UNCONNECTED				1U
+#define PAL_MODE_INPUT						2U
+#define PAL_MODE_INPUT_PULLUP				3U
+#define PAL_MODE_INPUT_PULLDOWN				4U
+#define PAL_MODE_INPUT_ANALOG				5U
+#define PAL_MODE_OUTPUT_PUSHPULL			6U
+#define PAL_MODE_OUTPUT_OPENDRAIN			7U
+#define PAL_MODE_ALTERNATE(n)				(0x80U | ((n) << 8))
+#define PAL_STM32_OSPEED_HIGHEST			(3U << 3)
+#define PAL_STM32_OTYPE_OPENDRAIN			(1U << 2)
+#define PAL_STM32_PUPDR_PULLUP				(1U << 5)
+
+#define PAL_LINE(port, pad)					((ioline_t)((uint32_t)((port) - host_gpio) << 4 | (pad)))
+#define PAL_PORT(line)						(&host_gpio[(line) >> 4])
+#define PAL_PAD(line)						((line) & 0xFU)
+
+#define palReadPad(port, pad)				(((port)->ODR >> (pad)) & 1U)
+#define palSetPad(port, pad)				__atomic_or_fetch(&(port)->ODR, 1U << (pad), __ATOMIC_SEQ_CST)
+#define palClearPad(port, pad)				__atomic_and_fetch(&(port)->ODR, ~(1U << (pad)), __ATOMIC_SEQ_CST)
+#define palTogglePad(port, pad)				__atomic_xor_fetch(&(port)->ODR, 1U << (pad), __ATOMIC_SEQ_CST)
+#define palWritePad(port, pad, bit)			((bit) ? palSetPad(port, pad) : palClearPad(port, pad))
+#define palSetPadMode(port, pad, mode)		((void)(port), (void)(pad), (void)(mode))
+#define palSetLineMode(line, mode)			palSetPadMode(PAL_PORT(line), PAL_PAD(line), mode)
+#define palSetLine(line)					palSetPad(PAL_PORT(line), PAL_PAD(line))
+#define palClearLine(line)					palClearPad(PAL_PORT(line), PAL_PAD(line))
+#define palReadLine(line)					palReadPad(PAL_PORT(line), PAL_PAD(line))
+
+/*===========================================================================*/
+/* Timers, RCC and NVIC                                                      */
+/*===========================================================================*/
+
+typedef struct {
+	volatile uint32_t	CR1;
+	volatile uint32_t	CR2;
+	volatile uint32_t	SMCR;
+	volatile uint32_t	DIER;
+	volatile uint32_t	SR;
+	volatile uint32_t	EGR;
+	volatile uint32_t	CNT;
+	volatile uint32_t	PSC;
+	volatile uint32_t	ARR;
+} stm32_tim_t;
+
+typedef struct {
+	volatile uint32_t	AHB1ENR;
+	volatile uint32_t	AHB2ENR;
+	volatile uint32_t	APB1ENR;
+	volatile uint32_t	APB2ENR;
+} stm32_rcc_t;
+
+extern stm32_tim_t host_tim1;
+extern stm32_tim_t host_tim7;
+extern stm32_rcc_t host_rcc;
+
+#define TIM1								(&host_tim1)
+#define TIM7								(&host_tim7)
+#define RCC									(&host_rcc)
+
+#define STM32_TIMCLK1						STM32_HSECLK	/* SYSCLK = HSE, APB1 prescaler 1 */
+#define STM32_TIMCLK2						STM32_HSECLK	/* SYSCLK = HSE, APB2 prescaler 1 */
+#define STM32_TIM_CR1_CEN					(1U << 0)
+#define STM32_TIM_CR1_URS					(1U << 2)
+#define STM32_TIM_CR1_OPM					(1U << 3)
+#define STM32_TIM_CR1_ARPE					(1U << 7)
+#define STM32_TIM_DIER_UIE					(1U << 0)
+#define STM32_TIM_DIER_UDE					(1U << 8)
+#define STM32_TIM_SR_UIF					(1U << 0)
+#define STM32_TIM_EGR_UG					(1U << 0)
+#define RCC_APB1ENR_TIM6EN					(1U << 4)
+#define RCC_APB1ENR_TIM7EN					(1U << 5)
+#define RCC_APB2ENR_TIM1EN					(1U << 0)
+
+#define TIM7_IRQn							55
+#define STM32_TIM7_HANDLER					host_tim7_handler
+
+void nvicEnableVector(uint32_t n, uint32_t prio);
+void nvicDisableVector(uint32_t n);
+
+/*===========================================================================*/
+/* DMA (memory to peripheral transfers triggered by timer updates)           */
+/*===========================================================================*/
+
+typedef void (*stm32_dmaisr_t)(void *p, uint32_t flags);
+
+typedef struct {
+	volatile uint32_t	CR;
+	volatile uint32_t	NDTR;
+	volatile uint32_t	FCR;
+	void				*periph;	// Peripheral address (PAR)
+	void				*memory;	// Memory address (M0AR)
+	uint32_t			size;		// Programmed transaction size
+	stm32_dmaisr_t		isr;
+	void				*param;
+} stm32_dma_stream_t;
+
+extern stm32_dma_stream_t host_dma_streams[16];
+
+#define STM32_DMA_STREAM_ID(dma, stream)	((((dma) - 1) * 8) + (stream))
+#define STM32_DMA_STREAM(id)				(&host_dma_streams[id])
+#define STM32_DMA2_STREAM1					STM32_DMA_STREAM(STM32_DMA_STREAM_ID(2, 1))
+#define STM32_DMA2_STREAM5					STM32_DMA_STREAM(STM32_DMA_STREAM_ID(2, 5))
+
+#define STM32_DMA_CR_EN						(1U << 0)
+#define STM32_DMA_CR_TEIE					(1U << 2)
+#define STM32_DMA_CR_HTIE					(1U << 3)
+#define STM32_DMA_CR_TCIE					(1U << 4)
+#define STM32_DMA_CR_DIR_P2M				(0U << 6)
+#define STM32_DMA_CR_DIR_M2P				(1U << 6)
+#define STM32_DMA_CR_CIRC					(1U << 8)
+#define STM32_DMA_CR_PINC					(1U << 9)
+#define STM32_DMA_CR_MINC					(1U << 10)
+#define STM32_DMA_CR_PSIZE_WORD				(2U << 11)
+#define STM32_DMA_CR_MSIZE_WORD				(2U << 13)
+#define STM32_DMA_CR_PL(n)					((n) << 16)
+#define STM32_DMA_CR_PBURST_SINGLE			(0U << 21)
+#define STM32_DMA_CR_MBURST_SINGLE			(0U << 23)
+#define STM32_DMA_CR_CHSEL(n)				((n) << 25)
+#define STM32_DMA_CR_CHSEL_MASK				(7U << 25)
+#define STM32_DMA_FCR_DMDIS					(1U << 2)
+#define STM32_DMA_FCR_FTH_FULL				(3U << 0)
+#define STM32_DMA_ISR_TEIF					(1U << 3)
+#define STM32_DMA_ISR_HTIF					(1U << 4)
+#define STM32_DMA_ISR_TCIF					(1U << 5)
+
+bool dmaStreamAllocate(const stm32_dma_stream_t *dmastp, uint32_t priority, stm32_dmaisr_t func, void *param);
+void dmaStreamRelease(const stm32_dma_stream_t *dmastp);
+void dmaStreamEnable(const stm32_dma_stream_t *dmastp);
+void dmaStreamDisable(const stm32_dma_stream_t *dmastp);
+
+#define dmaStreamSetPeripheral(dmastp, addr)	(((stm32_dma_stream_t*)(dmastp))->periph = (void*)(addr))
+#define dmaStreamSetMemory0(dmastp, addr)		(((stm32_dma_stream_t*)(dmastp))->memory = (void*)(addr))
+#define dmaStreamSetTransactionSize(dmastp, n)	(((stm32_dma_stream_t*)(dmastp))->NDTR = ((stm32_dma_stream_t*)(dmastp))->size = (n))
+#define dmaStreamGetTransactionSize(dmastp)		((dmastp)->NDTR)
+#define dmaStreamSetMode(dmastp, mode)			(((stm32_dma_stream_t*)(dmastp))->CR = (mode))
+#define dmaStreamSetFIFO(dmastp, mode)			(((stm32_dma_stream_t*)(dmastp))->FCR = (mode))
+
+/**
+  * DMA emulation statistics (host only)
+  */
+typedef struct {
+	uint64_t		transfers;		// Data items transferred
+	uint32_t		interrupts;		// Stream interrupts served
+} host_dma_stats_t;
+
+extern host_dma_stats_t host_dma_stats[16];
+
+/*===========================================================================*/
+/* EXT                                                                       */
+/*===========================================================================*/
+
+#define EXT_MAX_CHANNELS					23
+#define EXT_CH_MODE_DISABLED				0U
+#define EXT_CH_MODE_RISING_EDGE				1U
+#define EXT_CH_MODE_FALLING_EDGE			2U
+#define EXT_CH_MODE_BOTH_EDGES				3U
+#define EXT_CH_MODE_EDGES_MASK				3U
+#define EXT_MODE_GPIO_OFF					8
+#define EXT_MODE_GPIOA						(0U << EXT_MODE_GPIO_OFF)
+#define EXT_MODE_GPIOB						(1U << EXT_MODE_GPIO_OFF)
+#define EXT_MODE_GPIOC						(2U << EXT_MODE_GPIO_OFF)
+#define EXT_MODE_GPIOD						(3U << EXT_MODE_GPIO_OFF)
+#define EXT_MODE_GPIOE						(4U << EXT_MODE_GPIO_OFF)
+#define EXT_MODE_GPIOF						(5U << EXT_MODE_GPIO_OFF)
+#define EXT_MODE_GPIOG						(6U << EXT_MODE_GPIO_OFF)
+
+typedef struct EXTDriver EXTDriver;
+typedef uint32_t expchannel_t;
+typedef void (*extcallback_t)(EXTDriver *extp, expchannel_t channel);
+
+typedef struct {
+	uint32_t		mode;
+	extcallback_t	cb;
+} EXTChannelConfig;
+
+typedef struct {
+	EXTChannelConfig channels[EXT_MAX_CHANNELS];
+} EXTConfig;
+
+struct EXTDriver {
+	const EXTConfig	*config;
+	uint32_t		enabled;		// Enabled channels
+};
+
+extern EXTDriver EXTD1;
+
+void extStart(EXTDriver *extp, const EXTConfig *config);
+void extChannelEnable(EXTDriver *extp, expchannel_t channel);
+void extChannelDisable(EXTDriver *extp, expchannel_t channel);
+
+/**
+  * Signals an edge on a pin to the EXT driver, called by the device models
+  * after changing an input (host only)
+  */
+void host_ext_edge(ioportid_t port, uint32_t pad, bool rising);
+
+/*===========================================================================*/
+/* SPI                                                                       */
+/*===========================================================================*/
+
+typedef struct SPIDriver SPIDriver;
+typedef void (*spicallback_t)(SPIDriver *spip);
+
+typedef struct {
+	spicallback_t	end_cb;
+	ioportid_t		ssport;
+	uint16_t		sspad;
+	uint16_t		cr1;
+	uint16_t		cr2;
+} SPIConfig;
+
+struct SPIDriver {
+	const SPIConfig	*config;
+	mutex_t			mutex;
+};
+
+extern SPIDriver SPID2;
+
+#define SPI_CR1_CPHA						(1U << 0)
+#define SPI_CR1_CPOL						(1U << 1)
+#define SPI_CR1_MSTR						(1U << 2)
+#define SPI_CR1_BR_0						(1U << 3)
+#define SPI_CR1_BR_1						(1U << 4)
+#define SPI_CR1_BR_2						(1U << 5)
+
+void spiStart(SPIDriver *spip, const SPIConfig *config);
+void spiStop(SPIDriver *spip);
+void spiAcquireBus(SPIDriver *spip);
+void spiReleaseBus(SPIDriver *spip);
+void spiSelect(SPIDriver *spip);
+void spiUnselect(SPIDriver *spip);
+void spiExchange(SPIDriver *spip, size_t n, const void *txbuf, void *rxbuf);
+void spiSend(SPIDriver *spip, size_t n, const void *txbuf);
+void spiReceive(SPIDriver *spip, size_t n, void *rxbuf);
+
+/**
+  * Device model behind the SPI bus, implemented by the stubs
+  */
+void host_spi_exchange(SPIDriver *spip, size_t n, const uint8_t *txbuf, uint8_t *rxbuf);
+
+/*===========================================================================*/
+/* Serial and streams                                                        */
+/*===========================================================================*/
+
+typedef struct {
+	FILE			*fp;
+} BaseSequentialStream;
+
+typedef BaseSequentialStream SerialDriver;
+
+typedef struct {
+	uint32_t		speed;
+	uint16_t		cr1;
+	uint16_t		cr2;
+	uint16_t		cr3;
+} SerialConfig;
+
+extern SerialDriver SD4;
+
+void sdStart(SerialDriver *sdp, const SerialConfig *config);
+
+/*===========================================================================*/
+/* RTC                                                                       */
+/*===========================================================================*/
+
+typedef struct {
+	uint32_t		year: 8;
+	uint32_t		month: 4;
+	uint32_t		dstflag: 1;
+	uint32_t		dayofweek: 3;
+	uint32_t		day: 5;
+	uint32_t		millisecond: 27;
+} RTCDateTime;
+
+typedef struct {
+	int64_t			offset_ms;		// RTC time minus simulated time
+} RTCDriver;
+
+extern RTCDriver RTCD1;
+
+void rtcGetTime(RTCDriver *rtcp, RTCDateTime *timespec);
+void rtcSetTime(RTCDriver *rtcp, const RTCDateTime *timespec);
+
+/*===========================================================================*/
+/* Other drivers (only the types referenced by headers)                      */
+/*===========================================================================*/
+
+typedef struct {
+	uint32_t		state;
+} MMCDriver;
+
+/*===========================================================================*/
+/* HAL                                                                       */
+/*===========================================================================*/
+
+void halInit(void);
+
+/**
+  * Timer emulation statistics (host only)
+  */
+typedef struct {
+	uint64_t		updates;		// Update interrupts served
+	uint64_t		active_ns;		// Simulated time the counter was enabled
+	uint32_t		starts;			// Number of counter enables
+} host_tim_stats_t;
+
+extern host_tim_stats_t host_tim1_stats;
+extern host_tim_stats_t host_tim7_stats;
+
+#endif
+
@@ -0,0 +1,127 @@
+##############################################################################
+# Host (POSIX) build of the firmware for simulation and benchmarking
+#
+# make host         Builds build/host/sim and the tools (build/host/tools)
+# make host-run     Runs the simulator (arguments in SIMARGS)
+# make host-bench   Builds and runs the benchmarks in host/bench
+# make host-clean   Removes the host build
+#
+
+HOST_CC       = gcc
+HOST_BUILDDIR = build/host
+HOST_OPT      = -O2 -g
+HOST_CWARN    = -Wall -Wextra -Wundef -Wstrict-prototypes -std=gnu99
+HOST_DEFS     = -D_GNU_SOURCE -DHOST_BUILD
+
+# Firmware sources running unmodified on the host
+HOST_FWSRC = modules/tracking.c \
+             modules/position.c \
+             modules/image.c \
+             modules/imgctrl.c \
+             modules/imgsched.c \
+             modules/log.c \
+             modules/error.c \
+             protocols/ssdv/ssdv.c \
+             protocols/ssdv/rs8.c \
+             protocols/ssdv/crc32.c \
+             protocols/aprs/aprs.c \
+             protocols/aprs/ax25.c \
+             protocols/aprs/afsk.c \
+             protocols/morse/morse.c \
+             drivers/si4464.c \
+             drivers/wrapper/ptime.c \
+             debug.c \
+             radio.c \
+             sleep.c \
+             modules.c \
+             math/base.c \
+             math/sgp4.c \
+             math/geofence.c \
+             math/geofence_data.c \
+             config.c
+
+# ChibiOS/HAL stand-in and device stubs
+HOST_SIMSRC = host/ch.c \
+              host/hal.c \
+              host/chprintf.c \
+              host/replay.c \
+              host/stubs/si4464_spi.c \
+              host/stubs/ov2640.c \
+              host/stubs/max.c \
+              host/stubs/bme280.c \
+              host/stubs/pac1720.c \
+              host/stubs/padc.c \
+              host/stubs/pcrc.c \
+              host/stubs/pi2c.c \
+              host/stubs/sd.c \
+              host/stubs/flash.c
+
+HOST_INCDIR = host host/stubs . board_pecanpico7b \
+              modules drivers drivers/wrapper drivers/flash \
+              protocols/aprs protocols/ssdv protocols/morse math
+
+HOST_CFLAGS  = $(HOST_OPT) $(HOST_CWARN) $(HOST_DEFS) $(addprefix -I,$(HOST_INCDIR))
+HOST_LDFLAGS = -pthread -lm
+
+# Benchmarks, each linked with the firmware objects it exercises
+HOST_BENCH = $(HOST_BUILDDIR)/bench/ax25_bench \
+             $(HOST_BUILDDIR)/bench/afsk_bench \
+             $(HOST_BUILDDIR)/bench/imgctrl_model \
+             $(HOST_BUILDDIR)/bench/crc32_bench \
+             $(HOST_BUILDDIR)/bench/rs8_bench \
+             $(HOST_BUILDDIR)/bench/ssdv_bench \
+             $(HOST_BUILDDIR)/bench/imgsched_sim \
+             $(HOST_BUILDDIR)/bench/geofence_bench
+
+# Tools, built with the simulator
+HOST_TOOLS = $(HOST_BUILDDIR)/tools/ssdvdec
+
+host_objs = $(addprefix $(HOST_BUILDDIR)/obj/,$(1:.c=.o))
+
+HOST_FWOBJS  = $(addprefix $(HOST_BUILDDIR)/obj/,$(HOST_FWSRC:.c=.o))
+HOST_SIMOBJS = $(addprefix $(HOST_BUILDDIR)/obj/,$(HOST_SIMSRC:.c=.o))
+
+.PHONY: host host-run host-bench host-clean
+
+host: $(HOST_BUILDDIR)/sim $(HOST_BENCH) $(HOST_TOOLS)
+
+$(HOST_BUILDDIR)/sim: $(HOST_FWOBJS) $(HOST_SIMOBJS) $(HOST_BUILDDIR)/obj/host/main.o
+	$(HOST_CC) -o $@ $^ $(HOST_LDFLAGS)
+
+$(HOST_BUILDDIR)/obj/%.o: %.c
+	@mkdir -p $(dir $@)
+	$(HOST_CC) $(HOST_CFLAGS) -MMD -MP -c $< -o $@
+
+$(HOST_BUILDDIR)/bench/ax25_bench: $(call host_objs,host/bench/ax25_bench.c host/bench/ax25_ref.c protocols/aprs/ax25.c)
+
+$(HOST_BUILDDIR)/bench/afsk_bench: $(call host_objs,host/bench/afsk_bench.c protocols/aprs/afsk.c)
+
+$(HOST_BUILDDIR)/bench/imgctrl_model: $(call host_objs,host/bench/imgctrl_model.c modules/imgctrl.c)
+
+$(HOST_BUILDDIR)/bench/crc32_bench: $(call host_objs,host/bench/crc32_bench.c protocols/ssdv/crc32.c protocols/ssdv/ssdv.c protocols/ssdv/rs8.c host/stubs/pcrc.c host/ch.c host/chprintf.c)
+$(HOST_BUILDDIR)/bench/crc32_bench: HOST_LDFLAGS += -Wl,--wrap=crc32
+
+$(HOST_BUILDDIR)/bench/rs8_bench: $(call host_objs,host/bench/rs8_bench.c host/bench/rs8_ref.c protocols/ssdv/rs8.c)
+
+$(HOST_BUILDDIR)/bench/ssdv_bench: $(call host_objs,host/bench/ssdv_bench.c protocols/ssdv/ssdv.c protocols/ssdv/rs8.c protocols/ssdv/crc32.c host/stubs/pcrc.c host/ch.c host/chprintf.c)
+
+$(HOST_BUILDDIR)/bench/imgsched_sim: $(call host_objs,host/bench/imgsched_sim.c modules/imgsched.c protocols/ssdv/ssdv.c protocols/ssdv/rs8.c protocols/ssdv/crc32.c host/stubs/pcrc.c host/ch.c host/chprintf.c)
+
+$(HOST_BUILDDIR)/bench/geofence_bench: $(call host_objs,host/bench/geofence_bench.c math/geofence.c math/geofence_data.c host/ch.c host/chprintf.c)
+
+$(HOST_BUILDDIR)/tools/ssdvdec: $(call host_objs,host/tools/ssdvdec.c protocols/ssdv/ssdv.c protocols/ssdv/rs8.c protocols/ssdv/crc32.c math/base.c host/stubs/pcrc.c host/ch.c host/chprintf.c)
+
+$(HOST_BENCH) $(HOST_TOOLS):
+	@mkdir -p $(dir $@)
+	$(HOST_CC) -o $@ $^ $(HOST_LDFLAGS)
+
+host-bench: $(HOST_BENCH)
+	@for b in $(HOST_BENCH); do echo "=== $$b"; $$b || exit 1; done
+
+host-run: host
+	$(HOST_BUILDDIR)/sim $(SIMARGS)
+
+host-clean:
+	rm -rf $(HOST_BUILDDIR)
+
+-include $(shell find $(HOST_BUILDDIR) -name '*.d' 2>/dev/null)
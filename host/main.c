@@ -0,0 +1,160 @@
+/**
+  * Host simulator entry point. Starts the firmware modules like main.c does
+  * and runs them for a given amount of simulated time.
+  *
+  * Usage: sim [-t seconds] [-s speedup] [-f flight.csv] [-q] [-p] [-P] [image.jpg ...]
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "chprintf.h"
+
+#include "ptime.h"
+#include "config.h"
+#include "debug.h"
+#include "modules.h"
+#include "radio.h"
+#include "pi2c.h"
+#include "pac1720.h"
+#include "sd.h"
+#include "replay.h"
+#include "si4464_spi.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+
+#define DEFAULT_FLIGHT		"host/data/flight.csv"
+#define DEFAULT_IMAGES		"doc/sample_pictures"
+
+static int cmpstr(const void *a, const void *b)
+{
+	return strcmp(*(char* const*)a, *(char* const*)b);
+}
+
+/**
+  * Loads all JPEG files of a directory in alphabetical order
+  */
+static void load_image_dir(const char *dir)
+{
+	DIR *d = opendir(dir);
+	if(!d)
+		return;
+
+	char *names[64];
+	uint32_t cnt = 0;
+	struct dirent *e;
+	while((e = readdir(d)) && cnt < sizeof(names)/sizeof(char*)) {
+		size_t l = strlen(e->d_name);
+		if(l > 4 && !strcmp(&e->d_name[l-4], ".jpg"))
+			names[cnt++] = strdup(e->d_name);
+	}
+	closedir(d);
+
+	qsort(names, cnt, sizeof(char*), cmpstr);
+	for(uint32_t i=0; i<cnt; i++) {
+		char path[512];
+		snprintf(path, sizeof(path), "%s/%s", dir, names[i]);
+		replay_add_image(path);
+		free(names[i]);
+	}
+}
+
+static void report(uint32_t duration, uint64_t real_ns)
+{
+	printf("\n=== Simulation report ===\n");
+	printf("Simulated time    %u s in %.1f s (speedup %u)\n", duration, real_ns / 1e9, host_speedup);
+	printf("Track points      %u\n", getLastTrackPoint()->id);
+
+	for(uint8_t i=0; i<sizeof(config)/sizeof(module_conf_t); i++)
+		if(config[i].active)
+			printf("Module %-18s last activity %u s\n", config[i].name, ST2S(config[i].last_update));
+
+	printf("TIM1              %u runs, %lu updates, %.1f s active\n",
+		   host_tim1_stats.starts, (unsigned long)host_tim1_stats.updates, host_tim1_stats.active_ns / 1e9);
+	printf("TIM7              %u runs, %lu updates, %.1f s active\n",
+		   host_tim7_stats.starts, (unsigned long)host_tim7_stats.updates, host_tim7_stats.active_ns / 1e9);
+	printf("DMA2 stream 5     %lu transfers, %u interrupts\n",
+		   (unsigned long)host_dma_stats[STM32_DMA_STREAM_ID(2, 5)].transfers, host_dma_stats[STM32_DMA_STREAM_ID(2, 5)].interrupts);
+
+	for(radio_t r=RADIO_2M; r<=RADIO_70CM; r++)
+		printf("Radio %u           %u SPI transactions (%u commands, %u CTS polls), %u properties in %u commands, %u TX starts\n",
+			   r, host_si4464[r].transactions, host_si4464[r].commands, host_si4464[r].cts_polls,
+			   host_si4464[r].properties, host_si4464[r].property_cmds, host_si4464[r].tx_starts);
+	for(radio_t r=RADIO_2M; r<=RADIO_70CM; r++)
+		if(host_si4464[r].fifo_packets)
+			printf("Radio %u FIFO      %u packets, %u bytes, %u underflows\n",
+				   r, host_si4464[r].fifo_packets, host_si4464[r].fifo_bytes, host_si4464[r].fifo_underflows);
+
+	const char *prio[] = {"other", "image", "log", "error", "position"};
+	for(uint8_t p=0; p<=RADIO_PRIO_POSITION; p++) {
+		radioStats_t st;
+		radioGetStats(p, &st);
+		if(st.frames)
+			printf("Radio setup %-9s %u frames, %u cold starts, %u retunes, %u ms dead air, %u ms saved, %u ms on air\n",
+				   prio[p], st.frames, st.cold_starts, st.retunes, st.setup_ms, st.saved_ms, st.air_ms);
+	}
+}
+
+int main(int argc, char *argv[])
+{
+	uint32_t duration = 3600;
+	const char *flight = DEFAULT_FLIGHT;
+	bool quiet = false;
+	int opt;
+
+	host_speedup = 100;
+
+	while((opt = getopt(argc, argv, "t:s:f:qpP")) != -1) {
+		switch(opt) {
+			case 't': duration = atoi(optarg); break;
+			case 's': host_speedup = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+			case 'f': flight = optarg; break;
+			case 'q': quiet = true; break;
+			case 'p': host_si4464_cts_pin = false; break;
+			case 'P': host_si4464_cts_stuck = true; break;
+			default:
+				fprintf(stderr, "Usage: %s [-t seconds] [-s speedup] [-f flight.csv] [-q] [-p] [-P] [image.jpg ...]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	if(!replay_load(flight))
+		fprintf(stderr, "Could not load flight record %s, using defaults\n", flight);
+	for(int i=optind; i<argc; i++)
+		if(!replay_add_image(argv[i]))
+			fprintf(stderr, "Could not load image %s\n", argv[i]);
+	if(optind == argc)
+		load_image_dir(DEFAULT_IMAGES);
+
+	setvbuf(stdout, NULL, _IOLBF, 0);
+
+	halInit();					// Startup HAL
+	chSysInit();				// Startup RTOS
+
+	DEBUG_INIT();				// Debug Init (Serial debug port, LEDs)
+	if(quiet)
+		SD4.fp = NULL;
+	TRACE_INFO("MAIN > Startup (host simulation, speedup %d)", host_speedup);
+
+	// Set RTC to start of flight record
+	setTime(replay_get_date());
+
+	pi2cInit();					// Startup I2C
+	initEssentialModules();		// Startup required modules (input/output modules)
+	initModules();				// Startup optional modules (eg. POSITION, LOG, ...)
+	pac1720_init();				// Startup current measurement
+	initSD();					// Startup SD
+
+	uint64_t start = host_sim_ns();
+	chThdSleepSeconds(duration);
+	uint64_t real_ns = (host_sim_ns() - start) / host_speedup;
+
+	chMtxLock(&trace_mtx); // Stop tracing
+	fflush(stdout);
+	report(duration, real_ns);
+	return 0;
+}
+
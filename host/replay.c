@@ -0,0 +1,153 @@
+/**
+  * Recorded sensor data replayed by the host stubs. The flight record is a
+  * CSV file (see host/data/flight.csv), the first sample is aligned with the
+  * simulation start. Between samples the previous sample is held.
+  */
+
+#include "replay.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define MAX_IMAGES		16
+
+static replay_sample_t *samples;
+static uint32_t sample_cnt;
+
+static struct {
+	uint8_t *data;
+	uint32_t len;
+} images[MAX_IMAGES];
+static uint32_t image_cnt;
+static uint32_t image_next;
+
+// Used when no flight record has been loaded (Berlin, ground level)
+static const replay_sample_t default_sample = {
+	1483272000, 525163000, 133777000, 34, 8, 3900, 0, 0, 120, 1013250, 2000, 450
+};
+
+bool replay_load(const char *filename)
+{
+	FILE *f = fopen(filename, "r");
+	if(!f)
+		return false;
+
+	char line[256];
+	while(fgets(line, sizeof(line), f))
+	{
+		if(line[0] == '#' || line[0] == '\n')
+			continue;
+
+		replay_sample_t s;
+		int sats, vbat, vsol, charge, discharge, temp, hum;
+		if(sscanf(line, "%u,%d,%d,%d,%d,%d,%d,%d,%d,%u,%d,%d",
+				  &s.time, &s.gps_lat, &s.gps_lon, &s.gps_alt, &sats, &vbat, &vsol,
+				  &charge, &discharge, &s.press, &temp, &hum) != 12)
+			continue;
+		s.gps_sats = sats;
+		s.adc_battery = vbat;
+		s.adc_solar = vsol;
+		s.adc_charge = charge;
+		s.adc_discharge = discharge;
+		s.temp = temp;
+		s.hum = hum;
+
+		replay_sample_t *n = realloc(samples, (sample_cnt+1) * sizeof(replay_sample_t));
+		if(!n)
+			break;
+		samples = n;
+		samples[sample_cnt++] = s;
+	}
+	fclose(f);
+
+	return sample_cnt > 0;
+}
+
+/**
+  * Returns the recorded sample valid at the current simulation time
+  */
+const replay_sample_t* replay_get(void)
+{
+	if(!sample_cnt)
+		return &default_sample;
+
+	uint32_t t = samples[0].time + ST2S(chVTGetSystemTimeX());
+	uint32_t i = 0;
+	while(i+1 < sample_cnt && samples[i+1].time <= t)
+		i++;
+	return &samples[i];
+}
+
+/**
+  * Returns the wall clock time of the recorded flight at the current
+  * simulation time
+  */
+uint32_t replay_get_unixtime(void)
+{
+	uint32_t start = sample_cnt ? samples[0].time : default_sample.time;
+	return start + chVTGetSystemTimeX() / CH_CFG_ST_FREQUENCY;
+}
+
+/**
+  * Same as replay_get_unixtime() in the format used by the RTC and GPS
+  */
+ptime_t replay_get_date(void)
+{
+	time_t t = replay_get_unixtime();
+	struct tm tm;
+	gmtime_r(&t, &tm);
+
+	ptime_t date = {
+		.year = tm.tm_year + 1900,
+		.month = tm.tm_mon + 1,
+		.day = tm.tm_mday,
+		.hour = tm.tm_hour,
+		.minute = tm.tm_min,
+		.second = tm.tm_sec
+	};
+	return date;
+}
+
+bool replay_add_image(const char *filename)
+{
+	if(image_cnt >= MAX_IMAGES)
+		return false;
+
+	FILE *f = fopen(filename, "rb");
+	if(!f)
+		return false;
+
+	fseek(f, 0, SEEK_END);
+	long len = ftell(f);
+	fseek(f, 0, SEEK_SET);
+
+	uint8_t *data = malloc(len);
+	if(!data || fread(data, 1, len, f) != (size_t)len) {
+		free(data);
+		fclose(f);
+		return false;
+	}
+	fclose(f);
+
+	images[image_cnt].data = data;
+	images[image_cnt].len = len;
+	image_cnt++;
+	return true;
+}
+
+/**
+  * Returns the next recorded image (round robin)
+  */
+const uint8_t* replay_next_image(uint32_t *len)
+{
+	if(!image_cnt) {
+		*len = 0;
+		return NULL;
+	}
+
+	uint32_t i = image_next++ % image_cnt;
+	*len = images[i].len;
+	return images[i].data;
+}
+
@@ -0,0 +1,35 @@
+/**
+  * Recorded sensor data replayed by the host stubs
+  */
+
+#ifndef __HOST_REPLAY_H__
+#define __HOST_REPLAY_H__
+
+#include "ch.h"
+#include "ptime.h"
+
+typedef struct {
+	uint32_t time;			// UNIX timestamp
+	int32_t gps_lat;		// Latitude in deg*10^7
+	int32_t gps_lon;		// Longitude in deg*10^7
+	int32_t gps_alt;		// Altitude in meter
+	uint8_t gps_sats;		// Satellites used for solution
+	uint16_t adc_battery;	// Battery voltage in mV
+	uint16_t adc_solar;		// Solar voltage in mV
+	int16_t adc_charge;		// Charge power in mW
+	int16_t adc_discharge;	// Discharge power in mW
+	uint32_t press;			// Airpressure in Pa*10
+	int16_t temp;			// Temperature in degC*100
+	uint16_t hum;			// Rel. humidity in %*10
+} replay_sample_t;
+
+bool replay_load(const char *filename);
+const replay_sample_t* replay_get(void);
+uint32_t replay_get_unixtime(void);
+ptime_t replay_get_date(void);
+
+bool replay_add_image(const char *filename);
+const uint8_t* replay_next_image(uint32_t *len);
+
+#endif
+
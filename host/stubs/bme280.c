@@ -0,0 +1,46 @@
+/**
+  * BME280 stub for the host build. Only the internal sensor is present, its
+  * readings are taken from the flight record.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "bme280.h"
+#include "replay.h"
+#include <math.h>
+
+bool BME280_isAvailable(uint8_t address)
+{
+	return address == BME280_ADDRESS_INT;
+}
+
+void BME280_Init(bme280_t *handle, uint8_t address)
+{
+	handle->address = address;
+	handle->t_fine = 0;
+}
+
+int16_t BME280_getTemperature(bme280_t *handle)
+{
+	(void)handle;
+	return replay_get()->temp;
+}
+
+uint32_t BME280_getPressure(bme280_t *handle, uint16_t means)
+{
+	(void)handle;
+	(void)means;
+	return replay_get()->press;
+}
+
+uint16_t BME280_getHumidity(bme280_t *handle)
+{
+	(void)handle;
+	return replay_get()->hum;
+}
+
+int32_t BME280_getAltitude(uint32_t seaLevel, uint32_t atmospheric)
+{
+	return 44330.0 * (1.0 - pow(atmospheric / (float)seaLevel, 0.1903));
+}
+
@@ -0,0 +1,127 @@
+/**
+  * Flash stub for the host build. The first flash bank (sectors 0..11) is
+  * emulated in RAM, programming can only clear bits like on the target.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "flash.h"
+#include <string.h>
+
+#define FLASH_BASE	0x08000000
+#define FLASH_SIZE	(1024*1024)
+
+static uint8_t flash[FLASH_SIZE];
+static bool flash_initialized;
+
+static uint8_t* flashPtr(flashaddr_t address)
+{
+	if(!flash_initialized) {
+		memset(flash, 0xFF, sizeof(flash));
+		flash_initialized = true;
+	}
+	return &flash[address - FLASH_BASE];
+}
+
+static bool flashInRange(flashaddr_t address, size_t size)
+{
+	return address >= FLASH_BASE && address + size <= FLASH_BASE + FLASH_SIZE;
+}
+
+size_t flashSectorSize(flashsector_t sector)
+{
+	if(sector <= 3)
+		return 16 * 1024;
+	else if(sector == 4)
+		return 64 * 1024;
+	else if(sector >= 5 && sector <= 11)
+		return 128 * 1024;
+	return 0;
+}
+
+flashaddr_t flashSectorBegin(flashsector_t sector)
+{
+	flashaddr_t address = FLASH_BASE;
+	while(sector > 0)
+		address += flashSectorSize(--sector);
+	return address;
+}
+
+flashaddr_t flashSectorEnd(flashsector_t sector)
+{
+	return flashSectorBegin(sector + 1);
+}
+
+flashsector_t flashSectorAt(flashaddr_t address)
+{
+	flashsector_t sector = 0;
+	while(address >= flashSectorEnd(sector))
+		++sector;
+	return sector;
+}
+
+int flashSectorErase(flashsector_t sector)
+{
+	if(sector >= FLASH_SECTOR_COUNT)
+		return FLASH_RETURN_BAD_FLASH;
+
+	memset(flashPtr(flashSectorBegin(sector)), 0xFF, flashSectorSize(sector));
+	chThdSleepMilliseconds(1000); // Typical sector erase time (128k)
+	return FLASH_RETURN_SUCCESS;
+}
+
+int flashErase(flashaddr_t address, size_t size)
+{
+	while(size > 0)
+	{
+		flashsector_t sector = flashSectorAt(address);
+		int err = flashSectorErase(sector);
+		if(err != FLASH_RETURN_SUCCESS)
+			return err;
+		address = flashSectorEnd(sector);
+		size_t sector_size = flashSectorSize(sector);
+		if(sector_size >= size)
+			break;
+		size -= sector_size;
+	}
+	return FLASH_RETURN_SUCCESS;
+}
+
+bool flashIsErased(flashaddr_t address, size_t size)
+{
+	if(!flashInRange(address, size))
+		return FALSE;
+
+	uint8_t *p = flashPtr(address);
+	for(size_t i=0; i<size; i++)
+		if(p[i] != 0xFF)
+			return FALSE;
+	return TRUE;
+}
+
+bool flashCompare(flashaddr_t address, const char* buffer, size_t size)
+{
+	if(!flashInRange(address, size))
+		return FALSE;
+	return !memcmp(flashPtr(address), buffer, size);
+}
+
+int flashRead(flashaddr_t address, char* buffer, size_t size)
+{
+	if(!flashInRange(address, size))
+		return FLASH_RETURN_NO_PERMISSION;
+	memcpy(buffer, flashPtr(address), size);
+	return FLASH_RETURN_SUCCESS;
+}
+
+int flashWrite(flashaddr_t address, const char* buffer, size_t size)
+{
+	if(!flashInRange(address, size))
+		return FLASH_RETURN_NO_PERMISSION;
+
+	uint8_t *p = flashPtr(address);
+	for(size_t i=0; i<size; i++)
+		p[i] &= buffer[i];
+	return FLASH_RETURN_SUCCESS;
+}
+
@@ -0,0 +1,55 @@
+/**
+  * uBlox MAX GPS stub for the host build. Positions are taken from the flight
+  * record, a fix is available HOST_GPS_TTFF seconds after power on.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "max.h"
+#include "debug.h"
+#include "replay.h"
+
+#define HOST_GPS_TTFF	30	/* Time to first fix in seconds */
+
+static bool gps_on;
+static systime_t gps_on_time;
+
+bool gps_get_fix(gpsFix_t *fix)
+{
+	chThdSleepMilliseconds(1000); // Navigation rate 1Hz
+
+	const replay_sample_t *s = replay_get();
+	bool fixed = gps_on && chVTGetSystemTimeX() - gps_on_time >= S2ST(HOST_GPS_TTFF);
+
+	fix->time = replay_get_date();
+	fix->type = fixed ? 3 : 0;
+	fix->num_svs = fixed ? s->gps_sats : 0;
+	fix->lat = s->gps_lat;
+	fix->lon = s->gps_lon;
+	fix->alt = s->gps_alt;
+
+	return gps_on;
+}
+
+bool GPS_Init(void)
+{
+	if(!gps_on) {
+		TRACE_INFO("GPS  > Switch on");
+		chThdSleepMilliseconds(3000);
+		gps_on = true;
+		gps_on_time = chVTGetSystemTimeX();
+	}
+	return true;
+}
+
+void GPS_Deinit(void)
+{
+	TRACE_INFO("GPS  > Switch off");
+	gps_on = false;
+}
+
+uint32_t GPS_get_mcu_frequency(void)
+{
+	return 0;
+}
+
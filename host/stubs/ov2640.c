@@ -0,0 +1,185 @@
+/**
+  * OV2640 camera stub for the host build. A snapshot copies the next recorded
+  * JPEG image into the camera buffer of the module. In streaming mode the
+  * image is written into the buffer (used as ring buffer) at the DCMI rate
+  * in simulated time, like the circular DMA does.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "ov2640.h"
+#include "debug.h"
+#include "replay.h"
+#include <string.h>
+
+#define HOST_DCMI_RATE		500000	/* JPEG bytes per second delivered by the DCMI */
+#define HOST_FRAME_TIMEOUT	2000	/* Max. capture time of a frame in ms */
+
+static ssdv_config_t *ov2640_config;
+static uint32_t ov2640_len;
+static bool ov2640_overflow;
+
+// Streaming capture
+static const uint8_t *stream_image;	// Recorded image being captured
+static uint32_t stream_written;		// Bytes written into the ring
+static uint32_t stream_read;		// Bytes handed out by OV2640_StreamRead()
+static uint32_t stream_chunk;		// Start of the last chunk handed out
+static bool stream_end;				// Frame captured
+static uint64_t stream_start;		// Start of the capture in ns
+static bool stream_overrun;
+
+bool OV2640_Snapshot2RAM(void)
+{
+	TRACE_INFO("CAM  > Capture image");
+
+	uint32_t len;
+	const uint8_t *image = replay_next_image(&len);
+	if(!image) {
+		chThdSleepMilliseconds(HOST_FRAME_TIMEOUT);
+		TRACE_ERROR("CAM  > No recorded image available");
+		return false;
+	}
+
+	// Frame ends after the image has been delivered at the DCMI rate, or the
+	// DMA stops when the buffer is full
+	uint32_t written = len < ov2640_config->ram_size ? len : ov2640_config->ram_size;
+	chThdSleepMilliseconds((uint64_t)written * 1000 / HOST_DCMI_RATE + 1);
+	memcpy(ov2640_config->ram_buffer, image, written);
+
+	// Length up to the EOI marker like the driver determines it
+	ov2640_len = 0;
+	for(uint32_t i=written; i>=2 && !ov2640_len; i--)
+		if(image[i-2] == 0xFF && image[i-1] == 0xD9)
+			ov2640_len = i;
+	ov2640_overflow = len > ov2640_config->ram_size || !ov2640_len;
+	if(!ov2640_len)
+		ov2640_len = written;
+
+	TRACE_INFO("CAM  > Captured %d bytes%s", ov2640_len, ov2640_overflow ? " (buffer overflow)" : "");
+	return true;
+}
+
+bool OV2640_BufferOverflow(void)
+{
+	return ov2640_overflow;
+}
+
+uint32_t OV2640_getBuffer(uint8_t** buffer)
+{
+	*buffer = ov2640_config->ram_buffer;
+	return ov2640_len;
+}
+
+void OV2640_init(ssdv_config_t *config)
+{
+	ov2640_config = config;
+	ov2640_len = 0;
+	ov2640_overflow = false;
+
+	TRACE_INFO("CAM  > Switch on");
+	palSetPad(PORT(CAM_EN), PIN(CAM_EN));
+	chThdSleepMilliseconds(3000);
+}
+
+void OV2640_deinit(void)
+{
+	TRACE_INFO("CAM  > Switch off");
+	palClearPad(PORT(CAM_EN), PIN(CAM_EN));
+}
+
+bool OV2640_isAvailable(void)
+{
+	chThdSleepMilliseconds(100);
+	return true;
+}
+
+
+/**
+  * Writes the bytes the DCMI delivered until now into the ring
+  */
+static uint32_t OV2640_StreamWritten(void)
+{
+	uint64_t due = (host_sim_ns() - stream_start) * HOST_DCMI_RATE / 1000000000ULL;
+	uint32_t target = due < ov2640_len ? due : ov2640_len;
+
+	for(; stream_written < target; stream_written++)
+		ov2640_config->ram_buffer[stream_written % ov2640_config->ram_size] = stream_image[stream_written];
+	return stream_written;
+}
+
+void OV2640_StreamStart(void)
+{
+	TRACE_INFO("CAM  > Capture image (streaming)");
+
+	stream_image = replay_next_image(&ov2640_len);
+	if(!stream_image) {
+		TRACE_ERROR("CAM  > No recorded image available");
+		ov2640_len = 0;
+	}
+	stream_written = 0;
+	stream_read = 0;
+	stream_chunk = 0;
+	stream_end = false;
+	stream_overrun = false;
+	stream_start = host_sim_ns();
+}
+
+bool OV2640_StreamCaptured(void)
+{
+	if(!stream_end && OV2640_StreamWritten() == ov2640_len) {
+		stream_end = true;
+		TRACE_INFO("CAM  > Captured %d bytes in %d ms", ov2640_len, (uint32_t)((host_sim_ns() - stream_start) / 1000000));
+	}
+	return stream_end;
+}
+
+bool OV2640_StreamWait(void)
+{
+	while(!OV2640_StreamCaptured()) {
+		if(host_sim_ns() - stream_start > HOST_FRAME_TIMEOUT * 1000000ULL) {
+			TRACE_ERROR("CAM  > Capture timeout");
+			return false;
+		}
+		chThdSleepMilliseconds(1);
+	}
+	return true;
+}
+
+uint32_t OV2640_StreamRead(uint8_t **data, uint32_t max)
+{
+	uint32_t size = ov2640_config->ram_size;
+	uint32_t written;
+
+	while(true) {
+		bool captured = OV2640_StreamCaptured();
+		written = OV2640_StreamWritten();
+
+		if(written - stream_chunk > size) {
+			if(!stream_overrun)
+				TRACE_ERROR("CAM  > Stream overrun, image not read fast enough");
+			stream_overrun = true;
+			return 0;
+		}
+		if(written > stream_read)
+			break;
+		if(captured || !OV2640_StreamWait())
+			return 0;
+	}
+
+	uint32_t pos = stream_read % size;
+	uint32_t n = written - stream_read;
+	if(n > size - pos)
+		n = size - pos;
+	if(n > max)
+		n = max;
+
+	*data = &ov2640_config->ram_buffer[pos];
+	stream_chunk = stream_read;
+	stream_read += n;
+	return n;
+}
+
+bool OV2640_StreamOverrun(void)
+{
+	return stream_overrun;
+}
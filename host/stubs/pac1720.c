@@ -0,0 +1,43 @@
+/**
+  * PAC1720 stub for the host build, replays recorded power measurements
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "pac1720.h"
+#include "replay.h"
+
+int16_t pac1720_getPowerDischarge(void)
+{
+	return replay_get()->adc_discharge;
+}
+
+int16_t pac1720_getPowerCharge(void)
+{
+	return replay_get()->adc_charge;
+}
+
+int16_t pac1720_getAverageChargePower(void)
+{
+	return replay_get()->adc_charge;
+}
+
+int16_t pac1720_getAverageDischargePower(void)
+{
+	return replay_get()->adc_discharge;
+}
+
+uint16_t pac1720_getBatteryVoltage(void)
+{
+	return replay_get()->adc_battery;
+}
+
+bool pac1720_isAvailable(void)
+{
+	return true;
+}
+
+void pac1720_init(void)
+{
+}
+
@@ -0,0 +1,41 @@
+/**
+  * ADC stub for the host build. Conversions take as long as on the target,
+  * values are taken from the flight record.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "padc.h"
+#include "replay.h"
+
+void initADC(void)
+{
+}
+
+void deinitADC(void)
+{
+}
+
+static void doConversion(void)
+{
+	chThdSleepMilliseconds(35); // Wait until conversion is finished
+}
+
+uint16_t getBatteryVoltageMV(void)
+{
+	doConversion();
+	return replay_get()->adc_battery;
+}
+
+uint16_t getSolarVoltageMV(void)
+{
+	doConversion();
+	return replay_get()->adc_solar;
+}
+
+uint16_t getSTM32Temperature(void)
+{
+	doConversion();
+	return 940; // Raw sample at approx. 20degC
+}
+
@@ -0,0 +1,52 @@
+/**
+  * STM32 CRC unit stub for the host build. The unit (CRC-32/MPEG-2, one word
+  * per write, MSB first) is modelled with a byte-wise table and driven with
+  * the same bit reversal as the driver.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "pcrc.h"
+
+static uint32_t unit_table[256];	// CRC-32/MPEG-2 (polynom 0x04C11DB7), one entry per byte
+static uint8_t rbit_table[256];		// Bit reversed bytes
+
+__attribute__((constructor)) static void init_tables(void)
+{
+	for(uint32_t i=0; i<256; i++) {
+		uint32_t c = i << 24;
+		for(uint8_t j=0; j<8; j++)
+			c = c & 0x80000000 ? (c << 1) ^ 0x04C11DB7 : c << 1;
+		unit_table[i] = c;
+
+		uint8_t r = 0;
+		for(uint8_t j=0; j<8; j++)
+			r |= ((i >> j) & 1) << (7 - j);
+		rbit_table[i] = r;
+	}
+}
+
+static uint32_t rbit(uint32_t x)
+{
+	return (uint32_t)rbit_table[x & 0xFF] << 24 | rbit_table[(x >> 8) & 0xFF] << 16
+		 | rbit_table[(x >> 16) & 0xFF] << 8 | rbit_table[x >> 24];
+}
+
+/**
+  * Write to CRC->DR
+  */
+static uint32_t crc_unit(uint32_t dr, uint32_t word)
+{
+	dr ^= word;
+	for(uint8_t i=0; i<4; i++)
+		dr = (dr << 8) ^ unit_table[dr >> 24];
+	return dr;
+}
+
+uint32_t pcrc_crc32(const uint8_t *data, size_t words)
+{
+	uint32_t dr = 0xFFFFFFFF; // CRC_CR_RESET
+	for(; words; words--, data += 4)
+		dr = crc_unit(dr, rbit(data[0] | data[1] << 8 | data[2] << 16 | (uint32_t)data[3] << 24));
+	return rbit(dr);
+}
@@ -0,0 +1,85 @@
+/**
+  * I2C stub for the host build. All devices are stubbed at driver level, so
+  * there is nothing answering on the bus.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "pi2c.h"
+
+static mutex_t i2c_mtx;
+
+void pi2cInit(void)
+{
+	chMtxObjectInit(&i2c_mtx);
+}
+
+bool I2C_write8_locked(uint8_t address, uint8_t reg, uint8_t value)
+{
+	(void)address; (void)reg; (void)value;
+	return false;
+}
+
+bool I2C_writeN_locked(uint8_t address, uint8_t *txbuf, uint32_t length)
+{
+	(void)address; (void)txbuf; (void)length;
+	return false;
+}
+
+bool I2C_read8_locked(uint8_t address, uint8_t reg, uint8_t *val)
+{
+	(void)address; (void)reg; (void)val;
+	return false;
+}
+
+bool I2C_read16_locked(uint8_t address, uint8_t reg, uint16_t *val)
+{
+	(void)address; (void)reg; (void)val;
+	return false;
+}
+
+bool I2C_write8(uint8_t address, uint8_t reg, uint8_t value)
+{
+	return I2C_write8_locked(address, reg, value);
+}
+
+bool I2C_writeN(uint8_t address, uint8_t *txbuf, uint32_t length)
+{
+	return I2C_writeN_locked(address, txbuf, length);
+}
+
+bool I2C_read8(uint8_t address, uint8_t reg, uint8_t *val)
+{
+	return I2C_read8_locked(address, reg, val);
+}
+
+bool I2C_read16(uint8_t address, uint8_t reg, uint16_t *val)
+{
+	return I2C_read16_locked(address, reg, val);
+}
+
+bool I2C_read16_LE(uint8_t address, uint8_t reg, uint16_t *val)
+{
+	return I2C_read16_locked(address, reg, val);
+}
+
+bool I2C_readS16(uint8_t address, uint8_t reg, int16_t *val)
+{
+	return I2C_read16_locked(address, reg, (uint16_t*)val);
+}
+
+bool I2C_readS16_LE(uint8_t address, uint8_t reg, int16_t* val)
+{
+	return I2C_read16_locked(address, reg, (uint16_t*)val);
+}
+
+void I2C_lock(void)
+{
+	chMtxLock(&i2c_mtx);
+}
+
+void I2C_unlock(void)
+{
+	chMtxUnlock(&i2c_mtx);
+}
+
@@ -0,0 +1,23 @@
+/**
+  * SD card stub for the host build (no card inserted, like SD_AVAIL=FALSE)
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "sd.h"
+
+MMCDriver MMCD1;
+
+bool initSD(void)
+{
+	return false;
+}
+
+bool writeBufferToFile(const char *filename, const uint8_t *buffer, uint32_t len)
+{
+	(void)filename;
+	(void)buffer;
+	(void)len;
+	return false;
+}
+
@@ -0,0 +1,240 @@
+/**
+  * SPI level model of the two Si4464 transceivers for the host build. The real
+  * driver (drivers/si4464.c) runs against it. Commands are answered with CTS
+  * immediately (READ_CMD_BUFF and GPIO1), except POWER_UP which is busy until
+  * the first CTS poll. The model keeps transaction
+  * counters per radio. Packets started by START_TX with a length are sent from
+  * the TX FIFO at the programmed data rate, GPIO0 (TX_FIFO_EMPTY) rises when
+  * the FIFO runs almost empty.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "defines.h"
+#include "si4464.h"
+#include "si4464_spi.h"
+#include <string.h>
+
+host_si4464_t host_si4464[3];
+bool host_si4464_cts_pin = true;
+bool host_si4464_cts_stuck;
+
+static radio_t getRadio(const SPIConfig *config)
+{
+	if(config->ssport == PORT(RADIO1_CS) && config->sspad == PIN(RADIO1_CS))
+		return RADIO_2M;
+	if(config->ssport == PORT(RADIO2_CS) && config->sspad == PIN(RADIO2_CS))
+		return RADIO_70CM;
+	return 0;
+}
+
+static bool isPoweredUp(radio_t radio)
+{
+	return radio == RADIO_2M ? !palReadPad(PORT(RADIO1_SDN), PIN(RADIO1_SDN))
+	                         : !palReadPad(PORT(RADIO2_SDN), PIN(RADIO2_SDN));
+}
+
+/**
+  * Bytes of the packet sent until the given time
+  */
+static uint32_t fifoSent(host_si4464_t *si, uint64_t now)
+{
+	uint64_t sent = now > si->pkt_start ? (now - si->pkt_start) * si->pkt_rate / 8000000000ULL : 0;
+	return sent < si->pkt_written ? sent : si->pkt_written;
+}
+
+static void setGPIO0(radio_t radio, bool state)
+{
+	ioportid_t port = radio == RADIO_2M ? PORT(RADIO1_GPIO0) : PORT(RADIO2_GPIO0);
+	uint32_t pad = radio == RADIO_2M ? PIN(RADIO1_GPIO0) : PIN(RADIO2_GPIO0);
+	bool old = palReadPad(port, pad);
+
+	if(state)
+		palSetPad(port, pad);
+	else
+		palClearPad(port, pad);
+	if(state != old)
+		host_ext_edge(port, pad, state);
+}
+
+static void fifoCheck(void *arg);
+
+/**
+  * Updates GPIO0 and arms the timer for the almost empty condition
+  */
+static void fifoUpdate(radio_t radio)
+{
+	host_si4464_t *si = &host_si4464[radio];
+	uint32_t empty = SI4464_FIFO_SIZE - si->pkt[0x0B]; // Level at which the FIFO is almost empty
+	uint64_t now = host_sim_ns();
+
+	chVTResetI(&si->fifo_vt);
+	if(!si->pkt_active || si->gpio0 != 0x23)
+		return;
+
+	if(si->pkt_written - fifoSent(si, now) <= empty) {
+		setGPIO0(radio, true);
+	} else {
+		setGPIO0(radio, false);
+		uint64_t at = si->pkt_start + (uint64_t)(si->pkt_written - empty) * 8000000000ULL / si->pkt_rate;
+		systime_t delay = (at - now) * CH_CFG_ST_FREQUENCY / 1000000000ULL + 1;
+		chVTSetI(&si->fifo_vt, delay, fifoCheck, (void*)(uintptr_t)radio);
+	}
+}
+
+static void fifoCheck(void *arg)
+{
+	fifoUpdate((radio_t)(uintptr_t)arg);
+}
+
+/**
+  * Writes into the TX FIFO. Data which arrives after the FIFO ran empty
+  * during a packet counts as underflow (the packet is delayed in the model).
+  */
+static void fifoWrite(radio_t radio, uint32_t n)
+{
+	host_si4464_t *si = &host_si4464[radio];
+	si->fifo_bytes += n;
+	if(!si->pkt_active)
+		return;
+
+	uint64_t now = host_sim_ns();
+	uint64_t due = si->pkt_start + (uint64_t)si->pkt_written * 8000000000ULL / si->pkt_rate;
+	if(si->pkt_written < si->pkt_len && now > due) {
+		si->fifo_underflows++;
+		si->pkt_start += now - due;
+	}
+	si->pkt_written += n;
+	fifoUpdate(radio);
+}
+
+/**
+  * Starts a packet transmission from the TX FIFO. Bytes written before are
+  * already in the FIFO.
+  */
+static void fifoStart(radio_t radio, uint32_t len)
+{
+	host_si4464_t *si = &host_si4464[radio];
+	si->pkt_active = true;
+	si->pkt_len = len;
+	si->pkt_written = si->fifo_bytes_pending;
+	si->fifo_bytes_pending = 0;
+	si->pkt_rate = (si->modem[0x03] << 16) | (si->modem[0x04] << 8) | si->modem[0x05];
+	si->pkt_start = host_sim_ns();
+	si->fifo_packets++;
+	fifoUpdate(radio);
+}
+
+/**
+  * Returns true while the packet is sent
+  */
+static bool fifoBusy(radio_t radio)
+{
+	host_si4464_t *si = &host_si4464[radio];
+	if(si->pkt_active && si->pkt_written >= si->pkt_len && fifoSent(si, host_sim_ns()) >= si->pkt_len) {
+		si->pkt_active = false;
+		fifoUpdate(radio);
+	}
+	return si->pkt_active;
+}
+
+static void command(radio_t radio, const uint8_t *tx, size_t n)
+{
+	host_si4464_t *si = &host_si4464[radio];
+
+	memset(si->resp, 0, sizeof(si->resp));
+	si->commands++;
+
+	switch(tx[0])
+	{
+		case 0x02: // POWER_UP
+			si->booting = true;
+			break;
+		case 0x11: // SET_PROPERTY
+			si->properties += n > 2 ? tx[2] : 0;
+			si->property_cmds++;
+			for(size_t i=4; i<n && i-4<tx[2]; i++) {
+				uint8_t prop = (tx[3] + i - 4) & 0x7F;
+				if(tx[1] == 0x20)
+					si->modem[prop] = tx[i];
+				else if(tx[1] == 0x12)
+					si->pkt[prop] = tx[i];
+			}
+			break;
+		case 0x13: // GPIO_PIN_CFG
+			si->gpio0 = n > 1 ? tx[1] : 0;
+			break;
+		case 0x14: { // GET_ADC_READING, temperature at 20degC
+			uint16_t adc = (20 + 293) * 4096 / 899;
+			si->resp[4] = adc >> 8;
+			si->resp[5] = adc & 0xFF;
+			break;
+		}
+		case 0x15: // FIFO_INFO
+			if(n > 1 && (tx[1] & 0x01) && !si->pkt_active) // Reset TX FIFO
+				si->fifo_bytes_pending = 0;
+			si->resp[1] = SI4464_FIFO_SIZE - (si->pkt_active ? si->pkt_written - fifoSent(si, host_sim_ns()) : si->fifo_bytes_pending);
+			break;
+		case 0x31: { // START_TX
+			uint32_t len = n > 4 ? ((tx[3] & 0x1F) << 8) | tx[4] : 0;
+			si->state = 7;
+			si->tx_starts++;
+			si->pkt_len = 0;
+			if(len && si->gpio0 == 0x23)
+				fifoStart(radio, len);
+			break;
+		}
+		case 0x33: // REQUEST_DEVICE_STATE
+			if(si->state == 7 && si->pkt_len && !fifoBusy(radio))
+				si->state = 3; // Packet sent, back to READY
+			si->resp[0] = si->state;
+			break;
+		case 0x34: // CHANGE_STATE
+			si->state = n > 1 ? tx[1] : 0;
+			si->pkt_active = false;
+			si->pkt_len = 0;
+			fifoUpdate(radio);
+			break;
+		case 0x66: // WRITE_TX_FIFO
+			if(!si->pkt_active)
+				si->fifo_bytes_pending += n - 1;
+			fifoWrite(radio, n - 1);
+			break;
+	}
+}
+
+void host_spi_exchange(SPIDriver *spip, size_t n, const uint8_t *txbuf, uint8_t *rxbuf)
+{
+	memset(rxbuf, 0, n);
+
+	radio_t radio = getRadio(spip->config);
+	if(!radio || !n || !isPoweredUp(radio))
+		return; // MISO stays low
+
+	host_si4464_t *si = &host_si4464[radio];
+	si->transactions++;
+
+	if(txbuf[0] == 0x44 && si->booting) { // READ_CMD_BUFF, POWER_UP finishes now
+		si->cts_polls++;
+		si->booting = false;
+	} else if(txbuf[0] == 0x44) { // READ_CMD_BUFF
+		si->cts_polls++;
+		if(n > 1)
+			rxbuf[1] = 0xFF; // CTS
+		for(size_t i=2; i<n && i-2<sizeof(si->resp); i++)
+			rxbuf[i] = si->resp[i-2];
+	} else {
+		chSysLock();
+		command(radio, txbuf, n);
+		chSysUnlock();
+	}
+
+	// GPIO1 configured as CTS output, the command is processed instantly
+	ioportid_t port = radio == RADIO_2M ? PORT(RADIO1_GPIO1) : PORT(RADIO2_GPIO1);
+	uint32_t pad = radio == RADIO_2M ? PIN(RADIO1_GPIO1) : PIN(RADIO2_GPIO1);
+	if(host_si4464_cts_stuck || (host_si4464_cts_pin && !si->booting))
+		palSetPad(port, pad);
+	else
+		palClearPad(port, pad);
+}
+
@@ -0,0 +1,36 @@
+#ifndef __HOST_SI4464_SPI_H__
+#define __HOST_SI4464_SPI_H__
+
+#include "ch.h"
+
+typedef struct {
+	uint32_t transactions;	// SPI transactions (chip selects)
+	uint32_t commands;		// Commands (transactions without CTS polls)
+	uint32_t cts_polls;		// READ_CMD_BUFF transactions
+	uint32_t properties;	// Properties written by SET_PROPERTY
+	uint32_t property_cmds;	// SET_PROPERTY commands
+	uint32_t tx_starts;		// START_TX commands
+	uint32_t fifo_bytes;	// Bytes written into TX FIFO
+	uint32_t fifo_packets;	// Packets sent from the TX FIFO
+	uint32_t fifo_underflows;	// TX FIFO ran empty during a packet
+	uint8_t state;			// Device state
+	uint8_t resp[16];		// Response of last command
+	uint8_t modem[0x80];	// MODEM properties (group 0x20)
+	uint8_t pkt[0x80];		// PKT properties (group 0x12)
+	uint8_t gpio0;			// GPIO0 mode
+	bool pkt_active;		// Packet transmission from TX FIFO running
+	uint32_t fifo_bytes_pending;	// Bytes in the FIFO before START_TX
+	uint32_t pkt_len;		// Packet length in bytes
+	uint32_t pkt_written;	// Packet bytes written into the FIFO
+	uint32_t pkt_rate;		// Data rate in bps
+	uint64_t pkt_start;		// Simulated time of the first bit in ns (moved by underflows)
+	virtual_timer_t fifo_vt;	// Raises GPIO0 when the FIFO runs almost empty
+	bool booting;			// POWER_UP not finished yet (no CTS on the next poll)
+} host_si4464_t;
+
+extern host_si4464_t host_si4464[3];
+extern bool host_si4464_cts_pin;	// CTS signaled on GPIO1 (false: GPIO1 not connected)
+extern bool host_si4464_cts_stuck;	// GPIO1 stuck high
+
+#endif
+
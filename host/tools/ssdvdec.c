@@ -0,0 +1,550 @@
+/**
+  * SSDV receiver for the ground. Reads packet streams from files or stdin,
+  * corrects errors with the Reed-Solomon code, reassembles the images of
+  * all callsigns (interleaved streams of several balloons) and writes them
+  * as JPEG files. Reports corrected symbols, missing packets and the decode
+  * throughput.
+  *
+  * Input formats (-f, detected from the first byte by default):
+  *   raw   256 byte SSDV packets, resynchronized on errors
+  *   aprs  text lines containing APRS {{I payloads (base91, without sync,
+  *         CRC and FEC, as sent by moduleIMG)
+  *   kiss  KISS frames with AX.25 APRS {{I payloads or raw SSDV packets
+  *
+  * With -e the sample images are encoded by the firmware encoder into the
+  * selected format instead, with -x random symbol errors in raw packets.
+  * That's the reference stream for end-to-end checks of the encoder.
+  *
+  * Usage: ssdvdec [-f raw|aprs|kiss] [-o prefix] [-n] [-r repeat] [-v] [file ...]
+  *        ssdvdec -e [-f raw|aprs|kiss] [-c callsign] [-x errors] image.jpg ... > stream
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "ssdv.h"
+#include "rs8.h"
+#include "crc32.h"
+#include "base.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <time.h>
+
+#define MAX_IMAGES		16				/* Images decoded at the same time */
+#define JPEG_SIZE		(1024*1024)		/* Output buffer per image */
+#define APRS_DATA		(SSDV_PKT_SIZE - 37)	/* Sync byte, CRC and FEC not transmitted */
+#define KISS_FEND		0xC0
+#define KISS_FESC		0xDB
+#define KISS_TFEND		0xDC
+#define KISS_TFESC		0xDD
+
+typedef enum {
+	FMT_AUTO,
+	FMT_RAW,
+	FMT_APRS,
+	FMT_KISS
+} format_t;
+
+typedef struct {
+	bool used;
+	ssdv_t dec;
+	uint8_t *jpeg;
+	uint32_t callsign;
+	char callsign_s[SSDV_MAX_CALLSIGN+1];
+	uint8_t image_id;
+	uint16_t next;			// Next packet ID expected
+	uint16_t width;
+	uint16_t height;
+	uint32_t packets;
+	uint32_t missing;
+	bool eoi;				// Last packet received
+	uint64_t last;			// Sequence number of the last packet (LRU)
+} image_t;
+
+static struct {
+	uint32_t bytes;			// Input bytes
+	uint32_t packets;		// Valid packets
+	uint32_t corrected;		// Packets with corrected symbols
+	uint32_t symbols;		// Symbols corrected
+	uint32_t rejected;		// Candidates failing RS/CRC
+	uint32_t duplicates;	// Packets received before
+	uint32_t images;
+	uint32_t incomplete;	// Images without the last packet
+	uint32_t missing;		// Packets missing in between
+	uint64_t decode_ns;		// Time spent in RS, CRC and JPEG reassembly
+} stats;
+
+static image_t images[MAX_IMAGES];
+static uint64_t seq;
+static const char *prefix = "ssdv";
+static bool write_files = true;
+
+extern const unsigned char b91_table[91];
+
+// Referenced by ssdv.c (tracing)
+SerialDriver SD4;
+mutex_t trace_mtx;
+void log_error(const char *file, uint16_t line);
+void log_error(const char *file, uint16_t line)
+{
+	(void)file;
+	(void)line;
+}
+
+static uint64_t now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+/**
+  * Finishes an image and writes it to <prefix>_<callsign>_<image ID>.jpg
+  */
+static void finish(image_t *img)
+{
+	uint8_t *jpeg;
+	size_t len;
+	char filename[256] = "";
+
+	uint64_t start = now_ns();
+	ssdv_dec_get_jpeg(&img->dec, &jpeg, &len);
+	stats.decode_ns += now_ns() - start;
+
+	if(write_files) {
+		snprintf(filename, sizeof(filename), "%s_%s_%03u.jpg", prefix, img->callsign_s, img->image_id);
+		FILE *f = fopen(filename, "wb");
+		if(!f || fwrite(jpeg, 1, len, f) != len)
+			fprintf(stderr, "Could not write %s\n", filename);
+		if(f)
+			fclose(f);
+	}
+
+	stats.images++;
+	stats.missing += img->missing;
+	stats.incomplete += !img->eoi;
+	printf("%-6s image %3u  %4ux%-4u %4u packets, %3u missing%s, %7zu bytes %s\n", img->callsign_s, img->image_id,
+		   img->width, img->height, img->packets, img->missing, img->eoi ? "" : " (no end)", len, filename);
+
+	free(img->jpeg);
+	img->used = false;
+}
+
+/**
+  * Returns the decoder of the image of a packet. A new image of a callsign
+  * finishes its former image. If all decoders are in use, the one which
+  * hasn't received a packet for the longest time is finished.
+  */
+static image_t* get_image(const ssdv_packet_info_t *p)
+{
+	image_t *img = NULL, *lru = &images[0];
+
+	for(uint32_t i=0; i<MAX_IMAGES; i++) {
+		if(images[i].used && images[i].callsign == p->callsign) {
+			if(images[i].image_id == p->image_id)
+				return &images[i];
+			finish(&images[i]);
+		}
+		if(!images[i].used && !img)
+			img = &images[i];
+		if(images[i].last < lru->last)
+			lru = &images[i];
+	}
+	if(!img) {
+		finish(lru);
+		img = lru;
+	}
+
+	memset(img, 0, sizeof(image_t));
+	img->used = true;
+	img->jpeg = malloc(JPEG_SIZE);
+	img->callsign = p->callsign;
+	memcpy(img->callsign_s, p->callsign_s, sizeof(img->callsign_s));
+	img->image_id = p->image_id;
+	img->width = p->width;
+	img->height = p->height;
+	ssdv_dec_init(&img->dec);
+	ssdv_dec_set_buffer(&img->dec, img->jpeg, JPEG_SIZE);
+	return img;
+}
+
+/**
+  * Checks a candidate packet (RS error correction, CRC) and feeds it into
+  * the decoder of its image. Returns false if it isn't a valid packet (not
+  * counted here, a raw stream tries several candidates).
+  */
+static bool process_packet(uint8_t *pkt)
+{
+	int errors;
+	ssdv_packet_info_t p;
+
+	uint64_t start = now_ns();
+	if(ssdv_dec_is_packet(pkt, &errors)) {
+		stats.decode_ns += now_ns() - start;
+		return false;
+	}
+
+	stats.packets++;
+	stats.corrected += errors > 0;
+	stats.symbols += errors;
+
+	ssdv_dec_header(&p, pkt);
+	image_t *img = get_image(&p);
+	img->last = ++seq;
+
+	if(p.packet_id < img->next) { // Received before
+		stats.duplicates++;
+	} else {
+		img->missing += p.packet_id - img->next;
+		img->next = p.packet_id + 1;
+		img->packets++;
+		img->eoi |= p.eoi;
+		ssdv_dec_feed(&img->dec, pkt);
+	}
+	stats.decode_ns += now_ns() - start;
+
+	if(p.eoi)
+		finish(img);
+	return true;
+}
+
+/**
+  * Restores a packet from an APRS {{I payload: The sync byte, CRC and
+  * FEC aren't transmitted (AX.25 has its own CRC), so they are
+  * recalculated.
+  */
+static void process_aprs(const char *b91, size_t len)
+{
+	static int8_t dec[256];
+	static bool dec_init;
+	if(!dec_init) {
+		memset(dec, -1, sizeof(dec));
+		for(uint8_t i=0; i<91; i++)
+			dec[b91_table[i]] = i;
+		dec_init = true;
+	}
+
+	uint8_t pkt[SSDV_PKT_SIZE] = {0x55};
+	uint32_t n = 1, queue = 0, nbits = 0;
+	int32_t val = -1;
+
+	for(size_t i=0; i<len && n<=APRS_DATA; i++) {
+		int8_t d = dec[(uint8_t)b91[i]];
+		if(d < 0)
+			break;
+		if(val < 0) {
+			val = d;
+			continue;
+		}
+		val += d * 91;
+		queue |= val << nbits;
+		nbits += (val & 8191) > 88 ? 13 : 14;
+		do {
+			if(n <= APRS_DATA)
+				pkt[n++] = queue;
+			queue >>= 8;
+			nbits -= 8;
+		} while(nbits > 7);
+		val = -1;
+	}
+	if(val >= 0 && n <= APRS_DATA)
+		pkt[n++] = queue | val << nbits;
+	if(n <= APRS_DATA) {
+		stats.rejected++;
+		return;
+	}
+
+	uint32_t crc = crc32(&pkt[1], APRS_DATA);
+	pkt[APRS_DATA+1] = crc >> 24;
+	pkt[APRS_DATA+2] = crc >> 16;
+	pkt[APRS_DATA+3] = crc >> 8;
+	pkt[APRS_DATA+4] = crc;
+	encode_rs_8(&pkt[1], &pkt[APRS_DATA+5], 0);
+
+	if(!process_packet(pkt))
+		stats.rejected++;
+}
+
+/**
+  * Searches the {{I payloads in a text or AX.25 information field
+  */
+static void process_text(const uint8_t *data, size_t len)
+{
+	for(size_t i=0; i+3<=len; i++)
+		if(data[i] == '{' && data[i+1] == '{' && data[i+2] == 'I') {
+			process_aprs((const char*)&data[i+3], len-i-3);
+			i += 3;
+		}
+}
+
+/**
+  * KISS frame: raw SSDV packet or AX.25 frame with an APRS payload
+  */
+static void process_kiss(uint8_t *frame, size_t len)
+{
+	if(!len || (frame[0] & 0x0F)) // Data frames only
+		return;
+	frame++;
+	len--;
+
+	if(len == SSDV_PKT_SIZE || len == SSDV_PKT_SIZE-1) { // With or without sync byte
+		uint8_t pkt[SSDV_PKT_SIZE] = {0x55};
+		memcpy(&pkt[SSDV_PKT_SIZE-len], frame, len);
+		if(process_packet(pkt))
+			return;
+	}
+
+	// Skip the AX.25 addresses (last one has bit 0 set), control and PID
+	size_t i = 0;
+	while(i < len && !(frame[i] & 1))
+		i++;
+	process_text(&frame[i+3], i+3 < len ? len-i-3 : 0);
+}
+
+/**
+  * Raw packets are expected back to back. After an invalid packet the
+  * stream is searched for the next sync byte.
+  */
+static void decode_raw(FILE *f)
+{
+	uint8_t buf[2*SSDV_PKT_SIZE];
+	size_t fill = 0, n;
+	bool sync = true;
+
+	do {
+		n = fread(&buf[fill], 1, sizeof(buf)-fill, f);
+		stats.bytes += n;
+		fill += n;
+
+		size_t i = 0;
+		while(fill - i >= SSDV_PKT_SIZE) {
+			uint8_t pkt[SSDV_PKT_SIZE];
+			memcpy(pkt, &buf[i], SSDV_PKT_SIZE);
+			if(process_packet(pkt)) {
+				i += SSDV_PKT_SIZE;
+				sync = true;
+				continue;
+			}
+			if(sync)
+				stats.rejected++;
+			sync = false;
+			for(i++; i < fill && buf[i] != 0x55; i++);
+		}
+		memmove(buf, &buf[i], fill - i);
+		fill -= i;
+	} while(n);
+}
+
+static void decode_aprs(FILE *f)
+{
+	char line[2048];
+	while(fgets(line, sizeof(line), f)) {
+		stats.bytes += strlen(line);
+		process_text((uint8_t*)line, strlen(line));
+	}
+}
+
+static void decode_kiss(FILE *f)
+{
+	static uint8_t frame[4096];
+	size_t len = 0;
+	bool esc = false;
+	int c;
+
+	while((c = fgetc(f)) != EOF) {
+		stats.bytes++;
+		if(c == KISS_FEND) {
+			process_kiss(frame, len);
+			len = 0;
+			esc = false;
+		} else if(c == KISS_FESC) {
+			esc = true;
+		} else if(len < sizeof(frame)) {
+			if(esc)
+				c = c == KISS_TFEND ? KISS_FEND : c == KISS_TFESC ? KISS_FESC : c;
+			frame[len++] = c;
+			esc = false;
+		}
+	}
+}
+
+static void decode(FILE *f, format_t fmt)
+{
+	if(fmt == FMT_AUTO) {
+		int c = fgetc(f);
+		if(c == EOF)
+			return;
+		ungetc(c, f);
+		fmt = c == KISS_FEND ? FMT_KISS : c == 0x55 ? FMT_RAW : FMT_APRS;
+	}
+
+	switch(fmt) {
+		case FMT_RAW:	decode_raw(f); break;
+		case FMT_KISS:	decode_kiss(f); break;
+		default:		decode_aprs(f); break;
+	}
+}
+
+static void kiss_byte(uint8_t b)
+{
+	if(b == KISS_FEND) {
+		putchar(KISS_FESC);
+		putchar(KISS_TFEND);
+	} else if(b == KISS_FESC) {
+		putchar(KISS_FESC);
+		putchar(KISS_TFESC);
+	} else {
+		putchar(b);
+	}
+}
+
+static void kiss_address(const char *call, uint8_t ssid, bool last)
+{
+	for(uint8_t i=0; i<6; i++)
+		kiss_byte((i < strlen(call) ? call[i] : ' ') << 1);
+	kiss_byte(0x60 | ssid << 1 | last);
+}
+
+/**
+  * Writes a packet in the selected format, like moduleIMG transmits it
+  */
+static void write_packet(uint8_t *pkt, format_t fmt, const char *callsign, double errors)
+{
+	uint8_t b91[BASE91LEN(APRS_DATA)+1] = {0};
+
+	switch(fmt) {
+		case FMT_RAW:
+			for(uint32_t i=0; i<SSDV_PKT_SIZE; i++)
+				if(errors > 0 && rand() < errors * RAND_MAX)
+					pkt[i] ^= 1 + rand() % 255;
+			fwrite(pkt, 1, SSDV_PKT_SIZE, stdout);
+			break;
+
+		case FMT_KISS:
+			base91_encode(&pkt[1], b91, APRS_DATA);
+			putchar(KISS_FEND);
+			putchar(0x00);
+			kiss_address("APECAN", 0, false);
+			kiss_address(callsign, 11, true);
+			kiss_byte(0x03);
+			kiss_byte(0xF0);
+			printf("{{I");
+			for(uint32_t i=0; b91[i]; i++)
+				kiss_byte(b91[i]);
+			putchar(KISS_FEND);
+			break;
+
+		default:
+			base91_encode(&pkt[1], b91, APRS_DATA);
+			printf("%s-11>APECAN:{{I%s\n", callsign, b91);
+	}
+}
+
+static int encode(int argc, char *argv[], format_t fmt, const char *callsign, double errors)
+{
+	srand(1);
+	for(int n=0; n<argc; n++) {
+		FILE *f = fopen(argv[n], "rb");
+		if(!f) {
+			fprintf(stderr, "Could not open %s\n", argv[n]);
+			return 1;
+		}
+
+		ssdv_t ssdv;
+		uint8_t pkt[SSDV_PKT_SIZE], b[128];
+		size_t r;
+		char c;
+
+		ssdv_enc_init(&ssdv, SSDV_TYPE_NORMAL, (char*)callsign, n);
+		ssdv_enc_set_buffer(&ssdv, pkt);
+		while(true) {
+			while((c = ssdv_enc_get_packet(&ssdv)) == SSDV_FEED_ME) {
+				if(!(r = fread(b, 1, sizeof(b), f)))
+					break;
+				ssdv_enc_feed(&ssdv, b, r);
+			}
+			if(c != SSDV_OK)
+				break;
+			write_packet(pkt, fmt, callsign, errors);
+		}
+		fclose(f);
+	}
+	return 0;
+}
+
+static format_t parse_format(const char *s)
+{
+	if(!strcmp(s, "raw"))
+		return FMT_RAW;
+	if(!strcmp(s, "aprs"))
+		return FMT_APRS;
+	if(!strcmp(s, "kiss"))
+		return FMT_KISS;
+	fprintf(stderr, "Unknown format %s\n", s);
+	exit(1);
+}
+
+int main(int argc, char *argv[])
+{
+	format_t fmt = FMT_AUTO;
+	const char *callsign = "DL7AD";
+	bool enc = false;
+	double errors = 0;
+	uint32_t repeat = 1;
+	int opt;
+
+	chMtxObjectInit(&trace_mtx);
+	SD4.fp = NULL; // Decoder tracing with -v
+
+	while((opt = getopt(argc, argv, "f:o:nr:vec:x:")) != -1) {
+		switch(opt) {
+			case 'f': fmt = parse_format(optarg); break;
+			case 'o': prefix = optarg; break;
+			case 'n': write_files = false; break;
+			case 'r': repeat = atoi(optarg) > 0 ? atoi(optarg) : 1; break;
+			case 'v': SD4.fp = stderr; break;
+			case 'e': enc = true; break;
+			case 'c': callsign = optarg; break;
+			case 'x': errors = atof(optarg); break;
+			default:
+				fprintf(stderr, "Usage: %s [-f raw|aprs|kiss] [-o prefix] [-n] [-r repeat] [-v] [file ...]\n"
+								"       %s -e [-f raw|aprs|kiss] [-c callsign] [-x errors] image.jpg ...\n", argv[0], argv[0]);
+				return 1;
+		}
+	}
+
+	if(enc)
+		return encode(argc - optind, &argv[optind], fmt == FMT_AUTO ? FMT_RAW : fmt, callsign, errors);
+
+	uint64_t start = now_ns();
+	for(uint32_t r=0; r<repeat; r++) {
+		if(optind == argc) {
+			decode(stdin, fmt);
+		}
+		for(int i=optind; i<argc; i++) {
+			FILE *f = fopen(argv[i], "rb");
+			if(!f) {
+				fprintf(stderr, "Could not open %s\n", argv[i]);
+				return 1;
+			}
+			decode(f, fmt);
+			fclose(f);
+		}
+	}
+	for(uint32_t i=0; i<MAX_IMAGES; i++)
+		if(images[i].used)
+			finish(&images[i]);
+	uint64_t total_ns = now_ns() - start;
+
+	printf("\nInput             %u bytes\n", stats.bytes);
+	printf("Packets           %u valid (%u with %u corrected symbols), %u rejected, %u duplicates\n",
+		   stats.packets, stats.corrected, stats.symbols, stats.rejected, stats.duplicates);
+	printf("Images            %u (%u without last packet), %u packets missing\n",
+		   stats.images, stats.incomplete, stats.missing);
+	printf("Decoding          %.1f ms, %.0f packets/s (%.1f ms total with I/O)\n", stats.decode_ns / 1e6,
+		   stats.decode_ns ? stats.packets * 1e9 / stats.decode_ns : 0, total_ns / 1e6);
+
+	return 0;
+}
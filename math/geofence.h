@@ -3,21 +3,42 @@
 
 #include "ch.h"
 #include "hal.h"
+#include "geofence_data.h"	// Regions, generated by doc/geofence/compile.py
+#include "tracking.h"
+
+#define GEOFENCE_ROWS	(1800000000/GEOFENCE_CELL)
+#define GEOFENCE_COLS	(3600000000U/GEOFENCE_CELL)
+#define GEOFENCE_HYSTERESIS	1000000					/* Region kept within this distance of its border in deg*10000000 (0.1 deg) */
 
 typedef struct {
 	int32_t lat;
 	int32_t lon;
 } coord_t;
 
-bool isPointInPolygon(const coord_t *poly, uint32_t size, int32_t lat, int32_t lon);
-bool isPointInAmerica(int32_t lat, int32_t lon);
-bool isPointInChina(int32_t lat, int32_t lon);
-bool isPointInJapan(int32_t lat, int32_t lon);
-bool isPointInSouthkorea(int32_t lat, int32_t lon);
-bool isPointInSoutheastAsia(int32_t lat, int32_t lon);
-bool isPointInAustralia(int32_t lat, int32_t lon);
-bool isPointInNewZealand(int32_t lat, int32_t lon);
-bool isPointInArgentina(int32_t lat, int32_t lon);
-bool isPointInBrazil(int32_t lat, int32_t lon);
+typedef struct {
+	region_t region;
+	coord_t min;				// Bounding box
+	coord_t max;
+	coord_t start;				// First vertex
+	const int16_t *delta;		// Differences (lat, lon) to the next vertex in GEOFENCE_UNIT, back to the first one
+	uint16_t size;				// Number of edges
+} polygon_t;
+
+typedef struct {
+	const polygon_t *polygons;	// Polygons further down take precedence
+	uint32_t cnt;
+	const region_t *regions;	// Regions of the grid cell values
+	const uint8_t (*grid)[GEOFENCE_COLS/2];
+} geofence_layer_t;
+
+extern const geofence_layer_t geofence_layers[LAYERS];
+
+region_t getLayerRegion(layer_t layer, int32_t lat, int32_t lon);
+region_t getLayerRegionHysteresis(layer_t layer, int32_t lat, int32_t lon, region_t current);
+region_t getLayerRegionCached(layer_t layer, const trackPoint_t *point);
+region_t getRegion(int32_t lat, int32_t lon);
+region_t getRegionHysteresis(int32_t lat, int32_t lon, region_t current);
+bool isPointInPolygon(const polygon_t *polygon, int32_t lat, int32_t lon);
+bool isPointInRegion(region_t region, int32_t lat, int32_t lon);
 
 #endif
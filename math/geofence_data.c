@@ -0,0 +1,287 @@
+/* Generated by doc/geofence/compile.py from regions.geojson (tolerance 0.01 deg), do not edit */
+
+#include "ch.h"
+#include "hal.h"
+#include "geofence.h"
+
+/*
+ * Layer aprs
+ */
+
+static const int16_t aprs_poly0[] = { // America
+	// Latitude, longitude differences
+	-28454,     0, -28455,     0, -28454,     0,  -9917,  7481,  -9455,   -17,  -6576, -7464, -11432,     0,     43, 24873,
+	    43, 24873,     42, 24873,     43, 24873,   2929, 27292,  -1964, 31556,  22752,    10,  22751,    10,  13210, -4016,
+	 14266,-12252,  13354, -9210,  18764,  -314,   9178,   -79,   6339, -8164,   5710, -2267,   2724, -1621,   2678, -3028,
+	  4457,-11680,  15144,  -654,      0,-26269,      0,-26269,      0,-26268,      0,-26269, -14851,     0,  -6678, 10377,
+	 -2955,   -83,  -1387, -3687,  -3849, -6607,
+};
+static const int16_t aprs_poly1[] = { // China
+	// Latitude, longitude differences
+	    61,  -601,    119,  -262,   -178,  -742,   -204, -1000,   -314,   427,   -594,    19,   -567,   283,   -332,   -69,
+	  -334,  -288,   -722,  -223,  -1037, -2292,    -52,  -915,   -435,  -233,   -203,  -409,     56, -1284,   -931, -1294,
+	 -2317,  1192,  -5637,  4229,  -1375,  2976,  -1819,  3854,   -423,  3314,    472,   477,   -450,  1919,    725,  3049,
+	  -794,  3020,  -3867,  -275,  -2795,  3592,   1397,  4239,  -1827,  2086,  -3299,  -222,  -1301,  5003,   4134,  4779,
+	   592,  7512,   2689,  3294,   2557, -2112,   6500, -1528,   2318,  -720,   2393,   599,   1211,  -748,    477,   833,
+	   691,  7226,   2991,  -860,    126,   597,    314,   183,    844,    59,    757,  -322,    174,   469,    329,   381,
+	  -271,  1138,   1189,   752,   1090,   466,    440,   508,    700,  -196,   -184,  -698,   -154,  -816,   -398,  -490,
+	   -77,  -751,    159,  -752,   1015,  -470,    790, -1731,    -68,  -809,    331,  -502,    626,  -169,   1527,  -954,
+	   910,  -588,    605, -2407,   -210, -2408,   -554,  -913,   -718,   541,  -1035,  -829,   -946,  -388,   -532, -1657,
+	   302, -1004,  -1898,  -941,    151,  2385,   -871,  1545,   -501,    25,   -313, -2756,   -811, -1041,   -194, -1179,
+	  -568,  -828,    262, -1876,   -548,  -469,   -876,   233,  -1018, -2052,   -381, -2755,   -580, -1964,    336, -2434,
+	   593, -1467,   -122, -2039,    396, -2698,   1384, -1177,    790, -1994,    -12, -1349,    236,  -822,    136,  -321,
+	   472,    74,    662,   281,    885,  -537,    474,  -664,    265, -1016,    365,  -774,    651,  -335,    -41,  -663,
+	   -65,  -217,   -146,  -105,    -84,   110,   -295,  -229,   -134,  -391,    -22,  -399,   -242,  -243,   -590,    78,
+	  -313,    84,   -194,  -181,    -26,  -323,   -161,  -279,    109,  -109,     34,  -307,    -29,  -537,     31,  -273,
+	   212,  -696,   -997,  -466,   -250,  -102,    -29,  -114,   -349,   -83,    -79,     8,   -126,   326,   -236,   -29,
+};
+static const int16_t aprs_poly2[] = { // Japan
+	// Latitude, longitude differences
+	  2557, -2112,   6500, -1528,   -112,  2455,   1887,  2856,   1544,  1692,   1531,   747,   2240,  -560,   1296,  4164,
+	  2055,  1846,   5167,  3779,   -250,  4702,  -3131,  7355, -13438, -7756,  -5469, -9668,  -2377, -7972,
+};
+static const int16_t aprs_poly3[] = { // South Korea
+	// Latitude, longitude differences
+	  2318,  -720,   2393,   599,   1211,  -748,    477,   833,    691,  7226,  -2240,   560,  -1531,  -747,  -1544, -1692,
+	 -1887, -2856,    112, -2455,
+};
+static const int16_t aprs_poly4[] = { // Southeast Asia
+	// Latitude, longitude differences
+	   725,  3049,   -794,  3020,  -3867,  -275,  -2795,  3592,   1397,  4239,  -1827,  2086,  -3299,  -222,  -1301,  5003,
+	  4134,  4779,    592,  7512,      0, 27788,      0, 27787, -23003,     0, -23003,     0,      0,-12465,  10906,-11689,
+	  1807, -9228,   2350, -1736,     21, -4834,    542, -5186,     21, -4219,  -1578, -3977,  -1442, -3186,  -1817, -5537,
+	  -700, -9448,   2196, -6812,   7896,-10546,  10182, -2725,   9253,   264,   7213,  1670,   6191,  1296,
+};
+static const int16_t aprs_poly5[] = { // Australia
+	// Latitude, longitude differences
+	 10906,-11689,   1807, -9228,   2350, -1736,     21, -4834,    542, -5186,     21, -4219,  -1578, -3977,  -1442, -3186,
+	 -1817, -5537,   -700, -9448,  -2192, -2395,  -3701,    66,  -6493,    88,  -5840,   439,  -4508,  1846,  -2862,  5273,
+	 -1584,  7735,  -1544,  8174,  -1444,  5800,  -1347,  6241,   -781,  6064,    599,  6680,   1965,  2549,   3273,  2373,
+	  5200,  2021,   3846,  1846,   3863,  2109,   3440,  2131,
+};
+static const int16_t aprs_poly6[] = { // New Zealand
+	// Latitude, longitude differences
+	  1965,  2549,   3273,  2373,   5200,  2021,   3846,  1846,   3863,  2109,   3440,  2131,      0, 12465, -25948,     0,
+	 -4327, -7000,      0, -6684,    781, -4746,   3392, -3955,   2257, -1846,   2258, -1263,
+};
+static const int16_t aprs_poly7[] = { // New Zealand
+	// Latitude, longitude differences
+	 -9917,  7481,  -9455,   -17,  -6576, -7464,  25948,     0,
+};
+static const int16_t aprs_poly8[] = { // Argentina, Paraguay, Uruguay
+	// Latitude, longitude differences
+	   311,  -351,    717,   527,    724,  -703,    616, -1011,    639, -1186,    644,  -857,    267,  -440,   1284,  1187,
+	   774,   923,    624,  1230,    922,   264,    533,  -198,    158,  -351,     40,  -374,    995,   286,    621,   -66,
+	   100,  -396,   -120,  -329,     60,  -286,    543,  -132,    952,  -263,    223,  -528,    -40,  -791,    142,  -835,
+	  1063,    66,    822,  -198,    393,  -153,    455,  -901,     41,  -857,   -290, -1736,   -908,  -571,   -534,    44,
+	 -1225,  -396,    285,  -198,    -20, -1098,   -874,  -374,    609,  -264,    204, -1142,    244,  -462,   -671,  -703,
+	  -507,  -175,  -1007,  -308,   -401,  -901,   -539,  -132,  -1209,    44,   -826,    66,   -293,  -549,   -856,  -506,
+	 -1280,  -582,   -392,    11,   -476,    66,   -113,  -220,   -737,  -329,   -581,   -66,   -745,   329,   -665,   242,
+	  -933,   110,   -617,  -374,   -612,  -241,   -714,    44,   -461,  -462,   -493,  -351,   -664,   -22,  -1106,   329,
+	  -205,  -549,   -494,     0,   -541,  -286,   -704,  -132,  -1434,    44,    -49,  -329,   -389,    66,   -372,     0,
+	  -305,   307,   -255,  -175,   -239,   329,   -600,  -220,   -126,   572,   -282,   -66,    -31,  -703,   -156,   -44,
+	  -124,   549,   -248,   220,   -216,  -418,   -338,   -22,   -305,   -88,   -500,   154,   -256,  -351,   -345,    66,
+	  -282,  -440,   -399,   -88,   -469,   264,   -102,  -352,   -305,     0,   -246,  -483,   -629,   -22,   -636,  -220,
+	  -475,   110,    167,   506,    -69,   351,   -430,     0,   -385,   -22,   -259,   132,   -176,   351,    -54,   879,
+	     0,   879,   -162,   572,   -135,   879,   -348,   -44,  -1171,     0,  -1107,    65,     32,   455,    -16,   555,
+	  -129,   868,   -329,   675,   -494,  1703,    360,  2395,   1290,   462,    778, -1846,   1628, -2241,   1929,   417,
+	  2647,  2637,   4070,  1626,   2803,  4614,   3432,  4043,   1687,  1626,    721, -1406,    681, -1224,
+};
+static const int16_t aprs_poly9[] = { // Brazil
+	// Latitude, longitude differences
+	  -721,  1406,   1402, -2630,    311,  -351,    717,   527,    724,  -703,    616, -1011,    639, -1186,    644,  -857,
+	   267,  -440,   1284,  1187,    774,   923,    624,  1230,    922,   264,    533,  -198,    158,  -351,     40,  -374,
+	   995,   286,    621,   -66,    100,  -396,   -120,  -329,     60,  -286,    543,  -132,    952,  -263,    223,  -528,
+	   -40,  -791,    142,  -835,   1063,    66,    822,  -198,    393,  -153,   1599,   620,    648,  -219,    567,  -682,
+	   631,   132,    106, -1780,   1482,  -109,    851,  -176,    363,  -615,     43,  -704,    363,  -417,    193,  -703,
+	   321,  -308,    193,  -703,    387, -1077,    559,  -351,   1684,   -44,     87,  -527,   -239,  -747,   -346,  -660,
+	  -410,  -483,   -324,  -747,     65,  -681,     22, -1341,   1492,     0,   -477,  -747,    -22,  -813,    477,  -307,
+	    87,  -747,    368,   219,    826,  -681,    696,  -285,    502,   153,    480,   594,    480,   -88,    350,   219,
+	   547,   176,    678,  1077,    154,   813,    131,   395,   -153,   550,   1118,   285,   1053,   176,   1186,   110,
+	   484,  -264,    241,  -351,    813,    22,    154,   483,    -66,   352,    396,    44,     88,  -660,    637,   -43,
+	   -66,  1691,    307,    22,     88,   528,    154,   241,   -505,   198,   -571,    88,     44,   220,   -462,   505,
+	   176,   659,     44,   616,    483,   593,    461,   417,    242,   681,    285,    22,    110,  -659,    505,  -132,
+	   526,   -22,    658,  -637,   -153,   659,   -198,   264,    132,   527,   -417,   374,     66,   242,    373,   -22,
+	    87,   659,    220,   593,    328,   703,    263,   220,    267,   -77,     44,   626,   -657,   -77,   -197,   385,
+	  -450,   175,   -361,  -241,   -870,  -154,   -944,   373,   -472,   671,     22,   417,    253,   428,    285,   671,
+	    88,   758,    -77,   670,    209,    44,    219,  -209,    253,   165,   -132,   275,     33,   318,    208,   396,
+	  -362,   417,   -175,   407,    219,   384,   -121,   429,    -11,   428,    319,   352,   1853,  1032,   3628,  3373,
+	  3107,  3812,  -2511,  4966,  -2004,  3164,  -2845,  5010,  -3688,  3120,  -4697,  1319,  -3972,   175,  -3501,  -439,
+	 -3667, -1494,  -3768, -1758,  -6596, -2461,  -3380, -1802,  -2678, -1538,  -2746, -1670,  -2552, -1318,   1018, -6196,
+	  1976, -6747,
+};
+
+static const polygon_t aprs_polygons[] = {
+	// Region, bounding box, first vertex, differences, edges
+	{REGION_AMERICA, {-624630000, -1800000000}, {900000000, -216400000}, {602800000, -1800000000}, aprs_poly0, 35},
+	{REGION_CHINA, {161970000, 736810000}, {535240000, 1346400000}, {451740000, 825640000}, aprs_poly1, 128},
+	{REGION_JAPAN, {236120000, 1240790000}, {482770000, 1531150000}, {236120000, 1277190000}, aprs_poly2, 15},
+	{REGION_SOUTHKOREA, {325570000, 1232100000}, {397590000, 1318290000}, {326690000, 1240790000}, aprs_poly3, 10},
+	{REGION_SOUTHEASTASIA, {-250830000, 884120000}, {286830000, 1800000000}, {279580000, 916420000}, aprs_poly4, 31},
+	{REGION_AUSTRALIA, {-472690000, 1061000000}, {-94360000, 1675350000}, {-250830000, 1675350000}, aprs_poly5, 28},
+	{REGION_NEWZEALAND, {-553580000, 1545060000}, {-250830000, 1800000000}, {-466700000, 1545060000}, aprs_poly6, 14},
+	{REGION_NEWZEALAND, {-510310000, -1800000000}, {-250830000, -1725190000}, {-250830000, -1800000000}, aprs_poly7, 4},
+	{REGION_ARGENTINA, {-558490000, -732740000}, {-193200000, -506270000}, {-338230000, -532570000}, aprs_poly8, 127},
+	{REGION_BRAZIL, {-374980000, -739050000}, {111070000, -266100000}, {-345040000, -520330000}, aprs_poly9, 153},
+};
+
+static const region_t aprs_regions[] = {REGION_OTHER, REGION_AMERICA, REGION_CHINA, REGION_JAPAN, REGION_SOUTHKOREA, REGION_SOUTHEASTASIA, REGION_AUSTRALIA, REGION_NEWZEALAND, REGION_ARGENTINA, REGION_BRAZIL};
+
+static const uint8_t aprs_grid[GEOFENCE_ROWS][GEOFENCE_COLS/2] = {
+	// Two cells per byte, low nibble first, row 0 at 90 deg south
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF},
+	{0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xFF,0x11,0x11,0x11,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xFF,0xFF},
+	{0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xFF,0x11,0x11,0x11,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xFF,0xFF,0xFF,0x77,0xF7},
+	{0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xF8,0xFF,0x11,0x11,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xFF,0xFF,0xFF,0x66,0xFF,0x7F,0xF7},
+	{0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x88,0xFF,0xFF,0x1F,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x6F,0x66,0x66,0x66,0xF6,0x7F,0xF7},
+	{0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x8F,0xFF,0x9F,0xFF,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x66,0x66,0x66,0x66,0x66,0xFF,0xF7},
+	{0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x8F,0xFF,0x99,0xFF,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x66,0x66,0x66,0x66,0xF6,0xFF,0xFF},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0xFF,0x99,0xF9,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x66,0x66,0x66,0x66,0xF6,0xFF,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x9F,0x99,0xF9,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x66,0x66,0x66,0x66,0xF6,0xFF,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xFF,0x99,0x99,0x99,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0xFF,0xFF,0x6F,0xFF,0xFF,0xFF,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x9F,0x99,0x99,0x99,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x5F,0x55,0xF5,0xFF,0x5F,0x55,0x55,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x9F,0x99,0x99,0xFF,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xFF,0x5F,0x55,0x55,0x55,0x55,0x55,0x55,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xFF,0xFF,0x9F,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x5F,0x55,0x55,0x55,0x55,0x55,0x55,0x55,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xF1,0xFF,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x5F,0x55,0x55,0x55,0x55,0x55,0x55,0x55,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x5F,0x55,0x55,0x55,0x55,0x55,0x55,0x55,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0x5F,0xF5,0xFF,0x55,0x55,0x55,0x55,0x55,0xF5},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0x22,0x22,0xFF,0xFF,0xFF,0x00,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0xFF,0x22,0x22,0x22,0xFF,0xFF,0xFF,0x0F,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x22,0x22,0x22,0x22,0xFF,0xFF,0xF3,0x0F,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xFF,0x2F,0xFF,0xFF,0x2F,0x22,0xFF,0xFF,0x0F,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xFF,0xFF,0x00,0xFF,0xF2,0xFF,0xFF,0x0F,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0xF0,0xFF,0x00,0x00,0x00,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0xFF,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0xFF,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0xFF,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xFF,0x0F,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0xFF,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+	{0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00,0x00},
+};
+
+/*
+ * Layer itu
+ */
+
+static const int16_t itu_poly0[] = { // ITU Region 1
+	// Latitude, longitude differences
+	 30000,     0,  30000,     0,  30000,     0,  30000,     0,  30000,     0,  30000,     0,      0, 32727,      0, 32728,
+	     0, 32727,      0, 32727,      0, 32727,      0, 32728,      0, 32727,      0, 32727,      0, 32727,      0, 32728,
+	     0, 32727, -30000,     0, -30000,     0, -30000,     0, -30000,     0, -30000,     0, -30000,     0,      0,-32727,
+	     0,-32728,      0,-32727,      0,-32727,      0,-32727,      0,-32728,      0,-32727,      0,-32727,      0,-32727,
+	     0,-32728,      0,-32727,
+};
+static const int16_t itu_poly1[] = { // ITU Region 2
+	// Latitude, longitude differences
+	     0, 31800,      0, 31800,      0, 31800,      0, 31800,      0, 31800, -18000,     0,  -1230, -4853,  -1343, -4267,
+	 -1434, -3749,  -1510, -3302,  -1571, -2917,  -1622, -2589,  -1664, -2311,  -1699, -2072,  -1728, -1868,  -1753, -1694,
+	 -1774, -1544,  -1792, -1414,  -1808, -1301,  -1820, -1203,  -1833, -1117,  -1842, -1042,  -1852,  -975,  -1859,  -917,
+	 -1866,  -865,  -1608,  1474,  -1626,  1410,  -1641,  1350,  -1656,  1298,  -1669,  1248,  -1681,  1204,  -1691,  1163,
+	 -1701,  1127,  -1710,  1093,  -1717,  1064,  -1724,  1036,  -1731,  1012,  -3477,  1960,  -1745,   953,  -3502,  1864,
+	 -5273,  2716, -10572,  5326,  -5276,  2702, -26667,     0, -26666,     0, -26667,     0,      0,-25000,      0,-25000,
+	     0,-25000,      0,-25000,  25000,     0,  25000,     0,  25000,     0,  25000,     0,      0,-25000,      0,-25000,
+	  3612, -1546,   1802,  -790,   3596, -1623,   1792,  -838,   1788,  -858,   1784,  -880,   1778,  -905,   1773,  -933,
+	  1766,  -965,   1166,  -662,  30259,     0,    724,  1439,   1288,  2916,   1224,  3179,   1148,  3466,  24500,     0,
+};
+static const int16_t itu_poly2[] = { // ITU Region 2
+	// Latitude, longitude differences
+	 -1596,  1735,  -1621,  1628,  -1643,  1533,  -1662,  1446,  -1679,  1368,  -1695,  1299,  -1709,  1235,  -1720,  1177,
+	 -1732,  1126,  -1742,  1079,  -2344,  1374,  30259,     0,   -622, -1237,  -1394, -2459,  -1438, -2264,  -1475, -2089,
+	 -1507, -1933,  -1536, -1793,  -1561, -1668,  -1583, -1557,
+};
+static const int16_t itu_poly3[] = { // ITU Region 3
+	// Latitude, longitude differences
+	     0, 28000,      0, 28000,      0, 28000,      0, 28000,      0, 28000, -28884,     0,   -622, -1237,  -1394, -2459,
+	 -1438, -2264,  -1475, -2089,  -1507, -1933,  -1536, -1793,  -1561, -1668,  -1583, -1557,  -1596,  1735,  -1621,  1628,
+	 -1643,  1533,  -1662,  1446,  -1679,  1368,  -1695,  1299,  -1709,  1235,  -1720,  1177,  -1732,  1126,  -1742,  1079,
+	 -2344,  1374, -30214,     0, -30214,     0, -30215,     0, -30214,     0,      0,-30000,      0,-30000,      0,-30000,
+	     0,-30000,  28360,     0,  28360,     0,  28359,     0,  28360,     0,   1485, -1419,   1470, -1454,   1455, -1491,
+	  1439, -1531,   1421, -1575,   1401, -1621,   1380, -1672,   1357, -1725,   1331, -1783,   1305, -1844,   1275, -1908,
+	  1242, -1977,  25000,     0,  25000,     0,
+};
+static const int16_t itu_poly4[] = { // ITU Region 3
+	// Latitude, longitude differences
+	 -1166,   662,  -1766,   965,  -1773,   933,  -1778,   905,  -1784,   880,  -1788,   858,  -1792,   838,  -3596,  1623,
+	 -1802,   790,  -3612,  1546,      0, 25000,      0, 25000, -25000,     0, -25000,     0, -25000,     0, -25000,     0,
+	     0,-30000,      0,-30000,  30214,     0,  30214,     0,  30215,     0,  30214,     0,
+};
+static const int16_t itu_poly5[] = { // ITU Region 1
+	// Latitude, longitude differences
+	 -3000,  2400,    100,  2400,   2200,  -400,    100,  2100,   -500,     0,   -500,  2400,  -1100,  5000,    200,  3100,
+	  -900,  4200,  -1000,   100,   1700,  5200,   -100,  1300,   -200,   700,      0,  3000,    300,  3400,   2100, -1300,
+	  1100,  2000,   1500,  4600,   3000,  2300,   2000,   500,   2100,  4300,  -3600,  3500,  -2800,  5500,  -1100,  8200,
+	   900,  3000,   2500,  4000,   1600,  8200,   3200, -3000,   3500,  4800,    300,  2000,   -700,  2500,  -3400,  1500,
+	 -1200,  7200,  -3300, -1700,  -2500, -2300,   3100, 11100,  -2200,  3800,   6600, 19400,   1583,  1557,   1561,  1668,
+	  1536,  1793,   1507,  1933,   1475,  2089,   1438,  2264,   1394,  2459,    622,  1237,  28884,     0,      0,-28000,
+	     0,-28000,      0,-28000,      0,-28000,      0,-28000, -25000,     0, -25000,     0,
+};
+static const int16_t itu_poly6[] = { // ITU Region 1
+	// Latitude, longitude differences
+	   724,  1439,   1288,  2916,   1224,  3179,   1148,  3466,  24500,     0,      0,-11000, -28884,     0,
+};
+
+static const polygon_t itu_polygons[] = {
+	// Region, bounding box, first vertex, differences, edges
+	{REGION_ITU1, {-900000000, -1800000000}, {900000000, 1800000000}, {-900000000, -1800000000}, itu_poly0, 34},
+	{REGION_ITU2, {-900000000, -1800000000}, {900000000, -100000000}, {900000000, -1690000000}, itu_poly1, 72},
+	{REGION_ITU2, {308570000, 1650000000}, {611160000, 1800000000}, {500000000, 1650000000}, itu_poly2, 20},
+	{REGION_ITU3, {-900000000, 400000000}, {900000000, 1800000000}, {900000000, 400000000}, itu_poly3, 51},
+	{REGION_ITU3, {-900000000, -1800000000}, {308570000, -1200000000}, {308570000, -1800000000}, itu_poly4, 22},
+	{REGION_ITU1, {356000000, 400000000}, {900000000, 1800000000}, {400000000, 400000000}, itu_poly5, 54},
+	{REGION_ITU1, {611160000, -1800000000}, {900000000, -1690000000}, {611160000, -1800000000}, itu_poly6, 7},
+};
+
+static const region_t itu_regions[] = {REGION_OTHER, REGION_ITU1, REGION_ITU2, REGION_ITU3};
+
+static const uint8_t itu_grid[GEOFENCE_ROWS][GEOFENCE_COLS/2] = {
+	// Two cells per byte, low nibble first, row 0 at 90 deg south
+	{0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xF2,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x3F,0x33,0x33,0x33,0x33,0x33,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xF2,0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xF2,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0xFF,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0xFF,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xF2,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0x3F,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xF3},
+	{0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF,0xFF,0xFF,0xFF,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0x33,0xFF},
+	{0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0xFF,0x3F,0xFF,0xFF,0x3F,0x33,0xFF,0xFF,0xFF,0xFF,0xFF},
+	{0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0xFF,0xFF,0xF1,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF},
+	{0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0xF1,0xFF,0x11,0xF1,0xFF,0xFF,0xFF},
+	{0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xF2,0xFF,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xFF},
+	{0xFF,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1},
+	{0xFF,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0xFF,0x11,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1},
+	{0x1F,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0xFF,0x1F,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1},
+	{0x1F,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1},
+	{0x1F,0x2F,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x22,0x1F,0x11,0x11,0x11,0x11,0x1F,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0x11,0xF1},
+	{0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF,0xFF},
+};
+
+const geofence_layer_t geofence_layers[LAYERS] = {
+	{aprs_polygons, sizeof(aprs_polygons)/sizeof(polygon_t), aprs_regions, aprs_grid},
+	{itu_polygons, sizeof(itu_polygons)/sizeof(polygon_t), itu_regions, itu_grid},
+};
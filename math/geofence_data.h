@@ -0,0 +1,33 @@
+/* Generated by doc/geofence/compile.py from regions.geojson, do not edit */
+
+#ifndef __GEOFENCE_DATA_H__
+#define __GEOFENCE_DATA_H__
+
+#define GEOFENCE_CELL	50000000		/* Grid cell size in deg*10000000 (5 deg) */
+#define GEOFENCE_UNIT	10000			/* Vertex resolution in deg*10000000 (0.001 deg) */
+#define GEOFENCE_EDGE	0xF			/* Grid cell touched by a polygon edge */
+
+typedef enum {
+	LAYER_APRS,
+	LAYER_ITU,
+	LAYERS
+} layer_t;
+
+typedef enum {
+	REGION_OTHER,			// Rest of the world
+	REGION_AMERICA,		// America
+	REGION_CHINA,			// China
+	REGION_JAPAN,			// Japan
+	REGION_SOUTHKOREA,		// South Korea
+	REGION_SOUTHEASTASIA,	// Southeast Asia
+	REGION_AUSTRALIA,		// Australia
+	REGION_NEWZEALAND,		// New Zealand
+	REGION_ARGENTINA,		// Argentina, Paraguay, Uruguay
+	REGION_BRAZIL,			// Brazil
+	REGION_ITU1,			// ITU Region 1
+	REGION_ITU2,			// ITU Region 2
+	REGION_ITU3,			// ITU Region 3
+	REGIONS
+} region_t;
+
+#endif
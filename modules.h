@@ -10,15 +10,18 @@
 #include "types.h"
 
 #define MODULE_POSITION(CONF)	{chThdCreateFromHeap(NULL, THD_WORKING_AREA_SIZE(2*1024), (CONF)->name, NORMALPRIO, modulePOS,   (CONF)); (CONF)->active=true; }
-#define MODULE_IMAGE(CONF)		{chThdCreateFromHeap(NULL, THD_WORKING_AREA_SIZE(6*1024), (CONF)->name, NORMALPRIO, moduleIMG,   (CONF)); (CONF)->active=true; }
+#define MODULE_IMAGE(CONF)		{chThdCreateFromHeap(NULL, THD_WORKING_AREA_SIZE(10*1024), (CONF)->name, NORMALPRIO, moduleIMG,   (CONF)); (CONF)->active=true; }
 #define MODULE_ERROR(CONF)		{chThdCreateFromHeap(NULL, THD_WORKING_AREA_SIZE(2*1024), (CONF)->name, NORMALPRIO, moduleERROR, (CONF)); (CONF)->active=true; }
 #define MODULE_LOG(CONF)		{chThdCreateFromHeap(NULL, THD_WORKING_AREA_SIZE(2*1024), (CONF)->name, NORMALPRIO, moduleLOG,   (CONF)); (CONF)->active=true; }
+#define MODULE_RADIO()			 chThdCreateFromHeap(NULL, THD_WORKING_AREA_SIZE(2*1024), "Radio",      NORMALPRIO+1, moduleRADIO, NULL );
 #define MODULE_TRACKING(CYCLE)	 chThdCreateFromHeap(NULL, THD_WORKING_AREA_SIZE(2*1024), "Tracking",   NORMALPRIO, moduleTRACKING, NULL  );
 
 #define initEssentialModules() { \
 	chMtxObjectInit(&interference_mtx); \
 	chMtxObjectInit(&camera_mtx); \
 	chMtxObjectInit(&radio_mtx); \
+	initRadio(); \
+	MODULE_RADIO(); /* Radio transmit queue */ \
 	MODULE_TRACKING(CYCLE_TIME); /* Tracker data input */ \
 	chThdSleepMilliseconds(1000); /* Give Tracking manager some time to fill first track point */ \
 }
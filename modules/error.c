@@ -121,6 +121,8 @@ THD_FUNCTION(moduleERROR, arg)
 			radioMSG_t msg;
 			msg.freq = getFrequency(&config->frequency);
 			msg.power = config->power;
+			msg.priority = RADIO_PRIO_ERROR;
+			msg.deadline = 0;
 
 			switch(config->protocol) {
 				case PROT_APRS_2GFSK:
@@ -134,7 +136,8 @@ THD_FUNCTION(moduleERROR, arg)
 						pkt_base91[t] = 0;
 
 					base91_encode((uint8_t*)pkt, pkt_base91, 4*size+4);
-					msg.bin_len = aprs_encode_experimental('E', msg.msg, msg.mod, &config->aprs_config, pkt_base91, strlen((char*)pkt_base91));
+					radioAllocMSG(&msg);
+					msg.bin_len = aprs_encode_experimental('E', msg.msg, msg.msg_size, msg.mod, &config->aprs_config, pkt_base91, strlen((char*)pkt_base91));
 
 					transmitOnRadio(&msg);
 					break;
@@ -13,19 +13,189 @@
 #include "types.h"
 #include "sleep.h"
 #include "sd.h"
+#include "imgctrl.h"
+#include "imgsched.h"
+#include "config.h"
 
 static uint32_t gimage_id;
 mutex_t camera_mtx;
+static MUTEX_DECL(sched_mtx);	// Resend schedulers
+
+/**
+  * JPEG source of the SSDV encoder, an image in RAM or the camera stream
+  */
+typedef struct {
+	uint8_t *image;		// Image in RAM (NULL: read from the camera stream)
+	uint32_t len;		// Image length (RAM only)
+	uint32_t pos;		// Bytes read
+	bool capturing;		// Camera on, camera and interference mutex held (stream only)
+} ssdv_src_t;
+
+/**
+  * Finishes the capture of a streamed image. The camera is switched off and
+  * the radio is released, the rest of the image is read from the buffer.
+  */
+static void stopCapture(ssdv_src_t *src)
+{
+	if(!src->capturing)
+		return;
+
+	OV2640_StreamWait();
+	OV2640_deinit();
+	src->capturing = false;
+
+	chMtxUnlock(&interference_mtx);
+	chMtxUnlock(&camera_mtx);
+	TRACE_INFO("IMG  > Unlocked radio and camera");
+}
+
+/**
+  * Returns the next chunk of the JPEG image (0 at the end)
+  */
+static uint8_t readImage(ssdv_src_t *src, uint8_t **b)
+{
+	if(src->image) {
+		uint8_t r = src->pos < src->len-128 ? 128 : src->len - src->pos;
+		*b = &src->image[src->pos];
+		src->pos += r;
+		return r;
+	}
+
+	uint8_t r = OV2640_StreamRead(b, 128);
+	src->pos += r;
+	if(src->capturing && OV2640_StreamCaptured())
+		stopCapture(src);
+	return r;
+}
+
+/**
+  * Assigns a message buffer. While capturing the radio is held off, so only
+  * free buffers are taken. Otherwise the capture is finished first.
+  */
+static void allocMSG(ssdv_src_t *src, radioMSG_t *msg)
+{
+	if(src->capturing && radioTryAllocMSG(msg))
+		return;
+
+	stopCapture(src);
+	radioAllocMSG(msg);
+}
+
+/**
+  * Transmits an SSDV packet
+  */
+static void transmitPacket(ssdv_src_t *src, module_conf_t* config, uint8_t *pkt)
+{
+	uint8_t pkt_base91[BASE91LEN(SSDV_PKT_SIZE-37)];
+	radioMSG_t msg;
+	msg.freq = getFrequency(&config->frequency);
+	msg.power = config->power;
+	msg.priority = RADIO_PRIO_IMAGE;
+	msg.deadline = 0;
+
+	switch(config->protocol) {
+		case PROT_APRS_2GFSK:
+		case PROT_APRS_AFSK:
+			msg.mod = config->protocol == PROT_APRS_AFSK ? MOD_AFSK : MOD_2GFSK;
+			msg.afsk_config = &(config->afsk_config);
+			msg.gfsk_config = &(config->gfsk_config);
+
+			// Deleting buffer
+			for(uint16_t t=0; t<256; t++)
+				pkt_base91[t] = 0;
+
+			base91_encode(&pkt[1], pkt_base91, SSDV_PKT_SIZE-37); // Sync byte, CRC and FEC of SSDV not transmitted
+			allocMSG(src, &msg);
+			msg.bin_len = aprs_encode_experimental('I', msg.msg, msg.msg_size, msg.mod, &config->aprs_config, pkt_base91, strlen((char*)pkt_base91));
+
+			transmitOnRadio(&msg);
+			break;
+
+		case PROT_SSDV_2FSK:
+			msg.mod = MOD_2FSK;
+			msg.fsk_config = &(config->fsk_config);
+
+			// Queued in a pool buffer, the next packet is encoded while this one is sent
+			allocMSG(src, &msg);
+			memcpy(msg.msg, pkt, SSDV_PKT_SIZE);
+			msg.bin_len = 8*SSDV_PKT_SIZE;
+
+			transmitOnRadio(&msg);
+			break;
+
+		default:
+			TRACE_ERROR("IMG  > Unsupported protocol selected for module IMAGE");
+	}
+
+	// Packet spacing (delay), not while capturing (packets are only queued then)
+	if(config->packet_spacing && !src->capturing)
+		chThdSleepMilliseconds(config->packet_spacing);
+}
+
+/**
+  * Transmits a packet of the images kept by the resend scheduler, if any
+  * packet is due. Returns true if a packet has been transmitted.
+  */
+static bool transmitResend(ssdv_src_t *src, module_conf_t* config)
+{
+	imgsched_t *sched = config->ssdv_config.sched;
+	uint8_t pkt[SSDV_PKT_SIZE];
+	uint8_t idx;
+	uint16_t packet;
+
+	if(!sched)
+		return false;
+
+	chMtxLock(&sched_mtx);
+	bool due = imgsched_select(sched, &idx, &packet);
+	chMtxUnlock(&sched_mtx);
+
+	// Only this thread changes the kept images, they can be encoded unlocked
+	if(!due || !imgsched_encode(sched, idx, packet, pkt))
+		return false;
+
+	TRACE_INFO("SSDV > Resend packet %d of image %d", packet, sched->img[idx].id);
+	transmitPacket(src, config, pkt);
+	return true;
+}
+
+/**
+  * Keeps an image which has been sent for resending. A streamed image can be
+  * kept if it's in the camera buffer completely.
+  */
+static void keepImage(ssdv_src_t *src, module_conf_t* config, uint8_t image_id, uint16_t packets)
+{
+	imgsched_t *sched = config->ssdv_config.sched;
+	const uint8_t *image = src->image;
+	if(!sched)
+		return;
+
+	if(!image) {
+		if(OV2640_StreamOverrun() || src->pos > config->ssdv_config.ram_size)
+			return;
+		image = config->ssdv_config.ram_buffer;
+	}
+
+	chMtxLock(&sched_mtx);
+	bool kept = imgsched_add(sched, image_id, image, src->image ? src->len : src->pos, packets);
+	chMtxUnlock(&sched_mtx);
 
-void encode_ssdv(uint8_t *image, uint32_t image_len, module_conf_t* config, uint8_t image_id)
+	if(!kept)
+		TRACE_WARN("SSDV > Image too large to be kept for resending");
+}
+
+static void encode_ssdv(ssdv_src_t *src, module_conf_t* config, uint8_t image_id)
 {
 	ssdv_t ssdv;
 	uint8_t pkt[SSDV_PKT_SIZE];
-	uint8_t pkt_base91[BASE91LEN(SSDV_PKT_SIZE-37)];
 	uint16_t i = 0;
+	uint16_t resent = 0;
 	uint8_t *b;
-	uint32_t bi = 0;
 	uint8_t c = SSDV_OK;
+	uint8_t interleave = config->ssdv_config.interleave ? config->ssdv_config.interleave : IMGSCHED_INTERLEAVE;
+	radioStats_t rs_start, rs_end;
+
+	radioGetStats(RADIO_PRIO_IMAGE, &rs_start);
 
 	// Init SSDV (FEC at 2FSK, non FEC at APRS)
 	ssdv_enc_init(&ssdv, SSDV_TYPE_NORMAL, config->ssdv_config.callsign, image_id);
@@ -37,9 +207,7 @@ void encode_ssdv(uint8_t *image, uint32_t image_len, module_conf_t* config, uint
 
 		while((c = ssdv_enc_get_packet(&ssdv)) == SSDV_FEED_ME)
 		{
-			b = &image[bi];
-			uint8_t r = bi < image_len-128 ? 128 : image_len - bi;
-			bi += r;
+			uint8_t r = readImage(src, &b);
 
 			if(r <= 0)
 			{
@@ -55,53 +223,95 @@ void encode_ssdv(uint8_t *image, uint32_t image_len, module_conf_t* config, uint
 			break;
 		} else if(c != SSDV_OK) {
 			TRACE_ERROR("SSDV > ssdv_enc_get_packet failed: %i", c);
+			stopCapture(src);
 			return;
 		}
 
 		// Transmit packet
-		radioMSG_t msg;
-		msg.freq = getFrequency(&config->frequency);
-		msg.power = config->power;
+		transmitPacket(src, config, pkt);
+		i++;
 
-		switch(config->protocol) {
-			case PROT_APRS_2GFSK:
-			case PROT_APRS_AFSK:
-				msg.mod = config->protocol == PROT_APRS_AFSK ? MOD_AFSK : MOD_2GFSK;
-				msg.afsk_config = &(config->afsk_config);
-				msg.gfsk_config = &(config->gfsk_config);
+		// Packets of the last images interleaved
+		if(i % interleave == 0 && transmitResend(src, config))
+			resent++;
+	}
 
-				// Deleting buffer
-				for(uint16_t t=0; t<256; t++)
-					pkt_base91[t] = 0;
+	stopCapture(src);
+	if(!src->image && OV2640_StreamOverrun())
+		TRACE_ERROR("SSDV > Camera stream overrun, image incomplete");
 
-				base91_encode(&pkt[1], pkt_base91, sizeof(pkt)-37); // Sync byte, CRC and FEC of SSDV not transmitted
-				msg.bin_len = aprs_encode_experimental('I', msg.msg, msg.mod, &config->aprs_config, pkt_base91, strlen((char*)pkt_base91));
+	TRACE_INFO("SSDV > %i packets, %i packets of the last images resent", i, resent);
+	keepImage(src, config, image_id, i);
 
-				transmitOnRadio(&msg);
-				break;
+	// Radio setup of the image packets (queued packets are accounted to the next image)
+	radioGetStats(RADIO_PRIO_IMAGE, &rs_end);
+	TRACE_INFO("SSDV > Radio setup %d ms dead air, %d ms saved by hot radio (%d cold starts, %d retunes, %d frames, %d ms on air)",
+				rs_end.setup_ms - rs_start.setup_ms, rs_end.saved_ms - rs_start.saved_ms,
+				rs_end.cold_starts - rs_start.cold_starts, rs_end.retunes - rs_start.retunes,
+				rs_end.frames - rs_start.frames, rs_end.air_ms - rs_start.air_ms);
+}
 
-			case PROT_SSDV_2FSK:
-				msg.mod = MOD_2FSK;
-				msg.fsk_config = &(config->fsk_config);
+/**
+  * Requests packets of a kept image to be resent (uplink). Returns false if
+  * the image isn't kept by any image module.
+  */
+bool imageResendPackets(uint8_t image_id, uint16_t first, uint16_t count)
+{
+	bool kept = false;
 
-				memcpy(msg.msg, pkt, sizeof(pkt));
-				msg.bin_len = 8*sizeof(pkt);
+	chMtxLock(&sched_mtx);
+	for(uint8_t i=0; i<sizeof(config)/sizeof(module_conf_t); i++)
+		if(config[i].ssdv_config.sched)
+			kept |= imgsched_request(config[i].ssdv_config.sched, image_id, first, count);
+	chMtxUnlock(&sched_mtx);
 
-				transmitOnRadio(&msg);
-				break;
+	return kept;
+}
 
-			default:
-				TRACE_ERROR("IMG  > Unsupported protocol selected for module IMAGE");
-		}
+/**
+  * Captures an image and encodes it while the DMA is still writing it into
+  * the camera buffer. The first packets are queued before the capture has
+  * finished, they are transmitted as soon as the radio is unlocked at the
+  * end of the frame.
+  */
+static void captureStream(module_conf_t* config)
+{
+	// Lock camera
+	TRACE_INFO("IMG  > Lock camera");
+	chMtxLock(&camera_mtx);
+	TRACE_INFO("IMG  > Locked camera");
+
+	// Lock RADIO from producing interferences
+	TRACE_INFO("IMG  > Lock radio");
+	chMtxLock(&interference_mtx);
+	TRACE_INFO("IMG  > Locked radio");
+
+	// Shutdown radios (to avoid interference)
+	radioShutdown(RADIO_2M);
+	radioShutdown(RADIO_70CM);
+
+	if(!OV2640_isAvailable()) {
+		TRACE_ERROR("IMG  > No camera found");
+		chMtxUnlock(&interference_mtx);
+		chMtxUnlock(&camera_mtx);
+		return;
+	}
+	TRACE_INFO("IMG  > OV2640 found");
 
-		// Packet spacing (delay)
-		if(config->packet_spacing)
-			chThdSleepMilliseconds(config->packet_spacing);
+	// Quality from the size of the last images
+	imgctrl_select(&config->ssdv_config);
+	TRACE_INFO("IMG  > Resolution %d, QS %d", config->ssdv_config.res, config->ssdv_config.qs);
 
-		i++;
-	}
+	// Init camera and start capture, encode_ssdv() switches it off and unlocks after the frame
+	OV2640_init(&config->ssdv_config);
+	OV2640_StreamStart();
+
+	ssdv_src_t src = {.image = NULL, .capturing = true};
+	TRACE_INFO("IMG  > Encode/Transmit SSDV ID=%d (streaming)", gimage_id++);
+	encode_ssdv(&src, config, gimage_id);
 
-	TRACE_INFO("SSDV > %i packets", i);
+	if(!OV2640_StreamOverrun())
+		imgctrl_update(&config->ssdv_config, config->ssdv_config.res, src.pos, false);
 }
 
 THD_FUNCTION(moduleIMG, arg) {
@@ -114,6 +324,14 @@ THD_FUNCTION(moduleIMG, arg) {
 	// Print initialization message
 	TRACE_INFO("IMG  > Startup module %s", config->name);
 
+	// Resend scheduler in the history buffer
+	if(config->ssdv_config.hist_buffer) {
+		config->ssdv_config.sched = imgsched_init(config->ssdv_config.hist_buffer, config->ssdv_config.hist_size,
+						config->ssdv_config.callsign, config->ssdv_config.resend);
+		if(!config->ssdv_config.sched)
+			TRACE_ERROR("IMG  > History buffer too small for resending");
+	}
+
 	systime_t time = chVTGetSystemTimeX();
 	while(true)
 	{
@@ -126,7 +344,11 @@ THD_FUNCTION(moduleIMG, arg) {
 			uint8_t *image;
 
 			// Take photo if camera activated (if camera disabled, camera buffer is probably shared in config file)
-			if(!config->ssdv_config.no_camera)
+			if(!config->ssdv_config.no_camera && config->ssdv_config.stream && config->ssdv_config.res != RES_MAX)
+			{
+				captureStream(config);
+
+			} else if(!config->ssdv_config.no_camera)
 			{
 				// Lock camera
 				TRACE_INFO("IMG  > Lock camera");
@@ -150,28 +372,14 @@ THD_FUNCTION(moduleIMG, arg) {
 				{
 					TRACE_INFO("IMG  > OV2640 found");
 
-					if(config->ssdv_config.res == RES_MAX) // Attempt maximum resolution (limited by memory)
-					{
-						config->ssdv_config.res = RES_UXGA; // Try maximum resolution
-
-						do {
-
-							// Init camera
-							OV2640_init(&config->ssdv_config);
-
-							// Sample data from DCMI through DMA into RAM
-							tries = 5; // Try 5 times at maximum
-							do { // Try capturing image until capture successful
-								status = OV2640_Snapshot2RAM();
-							} while(!status && --tries);
-
-							config->ssdv_config.res--; // Decrement resolution in next attempt (if status==false)
-
-						} while(OV2640_BufferOverflow() && config->ssdv_config.res >= RES_QVGA);
-
-						config->ssdv_config.res = RES_MAX; // Revert register
-
-					} else { // Static resolution
+					// Resolution (RES_MAX) and quality from the size of the last images. If the
+					// image still didn't fit into the buffer, it's captured again with the
+					// corrected estimate.
+					resolution_t res = config->ssdv_config.res;
+					uint8_t captures = res == RES_MAX || !config->ssdv_config.quality ? IMGCTRL_CAPTURES : 1;
+					while(true) {
+						config->ssdv_config.res = imgctrl_select(&config->ssdv_config);
+						TRACE_INFO("IMG  > Resolution %d, QS %d", config->ssdv_config.res, config->ssdv_config.qs);
 
 						// Init camera
 						OV2640_init(&config->ssdv_config);
@@ -182,6 +390,13 @@ THD_FUNCTION(moduleIMG, arg) {
 							status = OV2640_Snapshot2RAM();
 						} while(!status && --tries);
 
+						if(status)
+							imgctrl_update(&config->ssdv_config, config->ssdv_config.res, OV2640_getBuffer(&image), OV2640_BufferOverflow());
+						config->ssdv_config.res = res; // Revert register
+
+						if(!status || !OV2640_BufferOverflow() || !--captures)
+							break;
+						OV2640_deinit();
 					}
 
 					// Switch off camera
@@ -216,8 +431,9 @@ THD_FUNCTION(moduleIMG, arg) {
 				// Encode/Transmit SSDV if image sampled successfully
 				if(status)
 				{
+					ssdv_src_t src = {.image = image, .len = image_len};
 					TRACE_INFO("IMG  > Encode/Transmit SSDV ID=%d", gimage_id++);
-					encode_ssdv(image, image_len, config, gimage_id);
+					encode_ssdv(&src, config, gimage_id);
 				}
 
 			} else {
@@ -226,8 +442,9 @@ THD_FUNCTION(moduleIMG, arg) {
 				TRACE_INFO("IMG  > Image size: %d bytes", image_len);
 
 				TRACE_INFO("IMG  > Camera disabled");
+				ssdv_src_t src = {.image = image, .len = image_len};
 				TRACE_INFO("IMG  > Encode/Transmit SSDV ID=%d", gimage_id);
-				encode_ssdv(image, image_len, config, gimage_id);
+				encode_ssdv(&src, config, gimage_id);
 
 			}
 		}
@@ -5,6 +5,7 @@
 #include "hal.h"
 
 THD_FUNCTION(moduleIMG, arg);
+bool imageResendPackets(uint8_t image_id, uint16_t first, uint16_t count);
 
 extern mutex_t camera_mtx;
 
@@ -0,0 +1,130 @@
+/**
+  * Resolution and JPEG quality controller of the image modules. Picks the
+  * camera resolution (RES_MAX) and the OV2640 quantization scale (QS) before
+  * the capture, so the image fills the camera buffer up to the target fill
+  * and doesn't need more than the target number of SSDV packets. The
+  * complexity of the scene is estimated from the size of the last images.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "imgctrl.h"
+
+/**
+  * Returns the number of pixels of a resolution
+  */
+uint32_t imgctrl_pixels(resolution_t res)
+{
+	switch(res) {
+		case RES_QCIF:	return 176*144;
+		case RES_QVGA:	return 320*240;
+		case RES_VGA:	return 640*480;
+		case RES_XGA:	return 1024*768;
+		case RES_UXGA:	return 1600*1200;
+		default:		return 320*240; // Driver default QVGA
+	}
+}
+
+/**
+  * Estimates the JPEG length of an image
+  */
+uint32_t imgctrl_estimate(resolution_t res, uint8_t qs, uint16_t complexity)
+{
+	return IMGCTRL_HEADER + (uint64_t)imgctrl_pixels(res) * complexity * IMGCTRL_QS_REF / qs / 1000;
+}
+
+/**
+  * Returns the target JPEG length (0: no limit). The buffer fill doesn't
+  * apply to streamed images, the buffer is used as ring buffer. The packet
+  * target keeps a margin for the variation between two images.
+  */
+uint32_t imgctrl_target(const ssdv_config_t *conf)
+{
+	uint32_t target = 0;
+	if(!conf->stream)
+		target = conf->ram_size * (conf->fill ? conf->fill : IMGCTRL_FILL) / 100;
+	if(conf->packets) {
+		uint32_t pkt = IMGCTRL_HEADER + conf->packets * IMGCTRL_PKT_PAYLOAD * IMGCTRL_PKT_MARGIN / 100;
+		if(!target || pkt < target)
+			target = pkt;
+	}
+	return target;
+}
+
+/**
+  * Returns the QS needed to fit an image into the target length
+  */
+static uint32_t imgctrl_qs(resolution_t res, uint16_t complexity, uint32_t target)
+{
+	if(!target)
+		return IMGCTRL_QS_REF;
+	if(target <= IMGCTRL_HEADER)
+		return IMGCTRL_QS_MAX;
+
+	uint64_t scan = (uint64_t)imgctrl_pixels(res) * complexity * IMGCTRL_QS_REF / 1000;
+	uint32_t avail = target - IMGCTRL_HEADER;
+	return (scan + avail - 1) / avail;
+}
+
+/**
+  * Maps the configured JPEG quality (1..100) to QS (63..2)
+  */
+static uint8_t imgctrl_quality2qs(uint8_t quality)
+{
+	if(quality > 100)
+		quality = 100;
+	return 2 + (100 - quality) * 61 / 99;
+}
+
+/**
+  * Selects the resolution and QS (conf->qs) of the next capture. The
+  * resolution is the configured one or, at RES_MAX, the highest resolution
+  * which fits at a QS up to IMGCTRL_QS_RES.
+  */
+resolution_t imgctrl_select(ssdv_config_t *conf)
+{
+	uint16_t complexity = conf->complexity ? conf->complexity : IMGCTRL_COMPLEXITY;
+	uint32_t target = imgctrl_target(conf);
+	uint8_t fixed = conf->quality ? imgctrl_quality2qs(conf->quality) : 0;
+	resolution_t res = conf->res;
+
+	if(res == RES_MAX) {
+		for(res=RES_UXGA; res>RES_QVGA; res--) {
+			if(!target)
+				break;
+			if(fixed ? imgctrl_estimate(res, fixed, complexity) <= target
+					 : imgctrl_qs(res, complexity, target) <= IMGCTRL_QS_RES)
+				break;
+		}
+	}
+
+	if(fixed) {
+		conf->qs = fixed;
+	} else {
+		uint32_t qs = imgctrl_qs(res, complexity, target);
+		conf->qs = qs < IMGCTRL_QS_MIN ? IMGCTRL_QS_MIN : qs > IMGCTRL_QS_MAX ? IMGCTRL_QS_MAX : qs;
+	}
+	return res;
+}
+
+/**
+  * Updates the complexity estimate with the length of a captured image. If
+  * the image didn't fit into the buffer, only a lower bound of its length is
+  * known, so the estimate is raised by at least 50%.
+  */
+void imgctrl_update(ssdv_config_t *conf, resolution_t res, uint32_t len, bool overflow)
+{
+	uint32_t old = conf->complexity ? conf->complexity : IMGCTRL_COMPLEXITY;
+	uint32_t scan = len > IMGCTRL_HEADER ? len - IMGCTRL_HEADER : 0;
+	uint32_t c = (uint64_t)scan * 1000 * conf->qs / IMGCTRL_QS_REF / imgctrl_pixels(res);
+
+	if(overflow) {
+		c = c * 5 / 4;
+		if(c < old * 3 / 2)
+			c = old * 3 / 2;
+	} else if(conf->complexity) {
+		c = (c + old) / 2;
+	}
+
+	conf->complexity = c < 1 ? 1 : c > 0xFFFF ? 0xFFFF : c;
+}
@@ -0,0 +1,31 @@
+#ifndef __IMGCTRL_H__
+#define __IMGCTRL_H__
+
+#include "ch.h"
+#include "hal.h"
+#include "types.h"
+#include "ssdv.h"
+
+/**
+  * Image size model: JPEG length = IMGCTRL_HEADER + pixels * complexity/1000 * IMGCTRL_QS_REF/qs
+  * The complexity (bytes per 1000 pixels at QS 12) is learned from the last captures.
+  */
+#define IMGCTRL_HEADER			623		/* JPEG header of the OV2640 (tables) in byte */
+#define IMGCTRL_QS_REF			12		/* QS the complexity refers to (OV2640 default) */
+#define IMGCTRL_COMPLEXITY		170		/* Complexity assumed before the first capture */
+#define IMGCTRL_QS_MIN			8		/* Best quality chosen automatically */
+#define IMGCTRL_QS_MAX			63		/* Worst quality */
+#define IMGCTRL_QS_RES			24		/* Max. QS before falling back to a lower resolution (RES_MAX) */
+#define IMGCTRL_FILL			80		/* Default target buffer fill in percent */
+#define IMGCTRL_PKT_MARGIN		85		/* Packets aimed at in percent of the target */
+#define IMGCTRL_CAPTURES		3		/* Max. captures of an image which doesn't fit into the buffer */
+#define IMGCTRL_PKT_PAYLOAD		(SSDV_PKT_SIZE - SSDV_PKT_SIZE_HEADER - SSDV_PKT_SIZE_CRC - SSDV_PKT_SIZE_RSCODES)
+
+uint32_t imgctrl_pixels(resolution_t res);
+uint32_t imgctrl_estimate(resolution_t res, uint8_t qs, uint16_t complexity);
+uint32_t imgctrl_target(const ssdv_config_t *conf);
+resolution_t imgctrl_select(ssdv_config_t *conf);
+void imgctrl_update(ssdv_config_t *conf, resolution_t res, uint32_t len, bool overflow);
+
+#endif
+
@@ -0,0 +1,201 @@
+/**
+  * Resend scheduler of the image modules. SSDV packets lost on the way to
+  * the ground are gone for good when an image is sent only once. The last
+  * images (their JPEGs, the packets don't fit into RAM) are kept in a history
+  * buffer, so packets of them can be encoded again and sent interleaved with
+  * the packets of the next images: any packets requested by the ground
+  * station and, if enabled, the early packets of each image in a resend pass
+  * after each of the next IMGSCHED_PASSES images. Requested packets are known to be
+  * missing, they are sent before the early packets.
+  */
+
+#include "ch.h"
+#include "hal.h"
+#include "imgsched.h"
+#include <string.h>
+
+/**
+  * Places the scheduler at the start of the history buffer, the rest of the
+  * buffer keeps the JPEGs. early is the number of early packets resent per
+  * pass, 0 disables the resend passes. Returns NULL if the buffer is too
+  * small.
+  */
+imgsched_t *imgsched_init(uint8_t *buffer, size_t size, const char *callsign, uint16_t early)
+{
+	uint32_t align = -(uintptr_t)buffer & 7;
+	if(!buffer || size < align + sizeof(imgsched_t))
+		return NULL;
+
+	imgsched_t *s = (imgsched_t*)&buffer[align];
+	memset(s, 0, sizeof(imgsched_t));
+	s->early = early;
+	s->buffer = &buffer[align + sizeof(imgsched_t)];
+	s->size = size - align - sizeof(imgsched_t);
+	strncpy(s->callsign, callsign, sizeof(s->callsign)-1);
+	return s;
+}
+
+static void drop(imgsched_t *s, uint8_t idx)
+{
+	memmove(&s->img[idx], &s->img[idx+1], (s->cnt - idx - 1) * sizeof(imgsched_image_t));
+	s->cnt--;
+}
+
+static void mark(imgsched_image_t *img, uint8_t *bitmap, uint16_t first, uint16_t count)
+{
+	for(uint32_t p=first; p<(uint32_t)first+count && p<img->packets; p++)
+		bitmap[p >> 3] |= 1 << (p & 7);
+}
+
+/**
+  * Keeps an image which has been sent. The oldest images are dropped if there
+  * is no space left. Starts a resend pass of the early packets of all images
+  * which have passes left. Returns false if the image doesn't fit into the
+  * history buffer.
+  */
+bool imgsched_add(imgsched_t *s, uint8_t id, const uint8_t *jpeg, uint32_t len, uint16_t packets)
+{
+	s->enc_active = false; // The JPEG being encoded may be overwritten
+
+	// Image ID used again (camera disabled)
+	for(uint8_t i=0; i<s->cnt; i++)
+		if(s->img[i].id == id)
+			drop(s, i--);
+
+	if(len <= s->size) {
+		// JPEGs stored one after another, the oldest ones are overwritten
+		uint32_t pos = 0;
+		if(s->cnt) {
+			imgsched_image_t *last = &s->img[s->cnt-1];
+			pos = last->jpeg + last->len - s->buffer;
+			if(pos + len > s->size)
+				pos = 0;
+		}
+		for(uint8_t i=0; i<s->cnt; i++) {
+			uint32_t start = s->img[i].jpeg - s->buffer;
+			if(start < pos + len && pos < start + s->img[i].len)
+				drop(s, i--);
+		}
+		if(s->cnt == IMGSCHED_IMAGES)
+			drop(s, 0);
+
+		imgsched_image_t *img = &s->img[s->cnt++];
+		memset(img, 0, sizeof(imgsched_image_t));
+		img->id = id;
+		img->packets = packets < IMGSCHED_PACKETS ? packets : IMGSCHED_PACKETS;
+		img->passes = IMGSCHED_PASSES;
+		img->jpeg = &s->buffer[pos];
+		img->len = len;
+		memcpy(img->jpeg, jpeg, len);
+	}
+
+	// Resend pass of the early packets of the images sent before
+	for(uint8_t i=0; s->early && i<s->cnt; i++) {
+		imgsched_image_t *img = &s->img[i];
+		if(img->id != id && img->passes) {
+			mark(img, img->early, 0, s->early);
+			img->passes--;
+		}
+	}
+
+	return len <= s->size;
+}
+
+/**
+  * Marks packets of a kept image for resending (uplink request). Returns
+  * false if the image isn't kept anymore.
+  */
+bool imgsched_request(imgsched_t *s, uint8_t id, uint16_t first, uint16_t count)
+{
+	for(uint8_t i=0; i<s->cnt; i++) {
+		if(s->img[i].id == id) {
+			mark(&s->img[i], s->img[i].requested, first, count);
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool next_marked(imgsched_image_t *img, uint8_t *bitmap, uint16_t from, uint16_t *packet)
+{
+	for(uint32_t p=from; p<img->packets; p++) {
+		if(!bitmap[p >> 3]) {
+			p |= 7; // Skip empty bytes
+			continue;
+		}
+		if(bitmap[p >> 3] & (1 << (p & 7))) {
+			img->requested[p >> 3] &= ~(1 << (p & 7));
+			img->early[p >> 3] &= ~(1 << (p & 7));
+			*packet = p;
+			return true;
+		}
+	}
+	return false;
+}
+
+static bool select_from(imgsched_t *s, bool requested, uint8_t *idx, uint16_t *packet)
+{
+	if(s->enc_active)
+		for(uint8_t i=0; i<s->cnt; i++)
+			if(s->img[i].id == s->enc_id && next_marked(&s->img[i], requested ? s->img[i].requested : s->img[i].early, s->enc_packets, packet)) {
+				*idx = i;
+				return true;
+			}
+
+	for(uint8_t i=0; i<s->cnt; i++)
+		if(next_marked(&s->img[i], requested ? s->img[i].requested : s->img[i].early, 0, packet)) {
+			*idx = i;
+			return true;
+		}
+
+	return false;
+}
+
+/**
+  * Selects the next packet to resend and unmarks it, requested packets
+  * first. The image being encoded is continued as long as it has packets
+  * left behind the last one encoded, the oldest image is taken otherwise.
+  * Returns false if there is nothing to resend.
+  */
+bool imgsched_select(imgsched_t *s, uint8_t *idx, uint16_t *packet)
+{
+	return select_from(s, true, idx, packet) || select_from(s, false, idx, packet);
+}
+
+/**
+  * Encodes a packet of a kept image into pkt. The encoder is restarted at
+  * the beginning of the image unless it's already in front of the packet.
+  */
+bool imgsched_encode(imgsched_t *s, uint8_t idx, uint16_t packet, uint8_t *pkt)
+{
+	imgsched_image_t *img = &s->img[idx];
+
+	if(!s->enc_active || s->enc_id != img->id || s->enc_packets > packet) {
+		ssdv_enc_init(&s->ssdv, SSDV_TYPE_NORMAL, s->callsign, img->id);
+		ssdv_enc_set_buffer(&s->ssdv, s->pkt);
+		s->enc_active = true;
+		s->enc_id = img->id;
+		s->enc_packets = 0;
+		s->enc_pos = 0;
+	}
+
+	while(true) {
+		char c;
+		while((c = ssdv_enc_get_packet(&s->ssdv)) == SSDV_FEED_ME) {
+			uint32_t r = img->len - s->enc_pos < 128 ? img->len - s->enc_pos : 128;
+			if(!r)
+				break;
+			ssdv_enc_feed(&s->ssdv, &img->jpeg[s->enc_pos], r);
+			s->enc_pos += r;
+		}
+		if(c != SSDV_OK) {
+			s->enc_active = false;
+			return false;
+		}
+		if(s->enc_packets++ == packet) {
+			memcpy(pkt, s->pkt, SSDV_PKT_SIZE);
+			return true;
+		}
+	}
+}
+
@@ -0,0 +1,54 @@
+#ifndef __IMGSCHED_H__
+#define __IMGSCHED_H__
+
+#include "ch.h"
+#include "hal.h"
+#include "ssdv.h"
+
+/**
+  * Resend scheduler of the image modules. The JPEGs of the last images are
+  * kept in a history buffer, packets of them are encoded again and sent
+  * interleaved with the packets of the next images.
+  */
+#define IMGSCHED_IMAGES			4		/* Max. images kept for resending */
+#define IMGSCHED_PACKETS		1024	/* Max. packets of an image which can be resent */
+#define IMGSCHED_EARLY			16		/* Suggested early packets resent per pass (opt-in) */
+#define IMGSCHED_PASSES			2		/* Resend passes of the early packets (one per following image) */
+#define IMGSCHED_INTERLEAVE		4		/* New packets between two resent packets by default */
+
+typedef struct {
+	uint8_t id;								// SSDV image ID
+	uint16_t packets;						// Number of packets
+	uint8_t passes;							// Resend passes of the early packets left
+	uint8_t *jpeg;							// JPEG in the history buffer
+	uint32_t len;							// JPEG length
+	uint8_t requested[IMGSCHED_PACKETS/8];	// Packets requested by the ground station (bitmap)
+	uint8_t early[IMGSCHED_PACKETS/8];		// Early packets of the resend pass (bitmap)
+} imgsched_image_t;
+
+typedef struct imgsched {
+	imgsched_image_t img[IMGSCHED_IMAGES];	// Kept images, oldest first
+	uint8_t cnt;							// Number of kept images
+	uint16_t early;							// Early packets resent per pass
+	uint8_t *buffer;						// JPEG storage
+	size_t size;							// JPEG storage size
+
+	// Encoder of the resent packets, continued while the packets resent
+	// are in order
+	ssdv_t ssdv;
+	char callsign[8];
+	bool enc_active;
+	uint8_t enc_id;							// Image being encoded
+	uint16_t enc_packets;					// Packets encoded
+	uint32_t enc_pos;						// JPEG bytes fed
+	uint8_t pkt[SSDV_PKT_SIZE];
+} imgsched_t;
+
+imgsched_t *imgsched_init(uint8_t *buffer, size_t size, const char *callsign, uint16_t early);
+bool imgsched_add(imgsched_t *s, uint8_t id, const uint8_t *jpeg, uint32_t len, uint16_t packets);
+bool imgsched_request(imgsched_t *s, uint8_t id, uint16_t first, uint16_t count);
+bool imgsched_select(imgsched_t *s, uint8_t *idx, uint16_t *packet);
+bool imgsched_encode(imgsched_t *s, uint8_t idx, uint16_t packet, uint8_t *pkt);
+
+#endif
+
@@ -160,6 +160,8 @@ THD_FUNCTION(moduleLOG, arg)
 			radioMSG_t msg;
 			msg.freq = getFrequency(&config->frequency);
 			msg.power = config->power;
+			msg.priority = RADIO_PRIO_LOG;
+			msg.deadline = 0;
 
 			switch(config->protocol) {
 				case PROT_APRS_2GFSK:
@@ -173,7 +175,8 @@ THD_FUNCTION(moduleLOG, arg)
 						pkt_base91[t] = 0;
 
 					base91_encode((uint8_t*)pkt, pkt_base91, sizeof(pkt));
-					msg.bin_len = aprs_encode_message(msg.msg, msg.mod, &config->aprs_config, APRS_DEST_CALLSIGN, (char*)pkt_base91);
+					radioAllocMSG(&msg);
+					msg.bin_len = aprs_encode_message(msg.msg, msg.msg_size, msg.mod, &config->aprs_config, APRS_DEST_CALLSIGN, (char*)pkt_base91);
 
 					transmitOnRadio(&msg);
 					break;
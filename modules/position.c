@@ -12,6 +12,8 @@
 #include <string.h>
 #include <math.h>
 
+#define POS_TX_DEADLINE		60		/* Position reports not transmitted within this time (in seconds) are dropped */
+
 void str_replace(char *string, uint32_t size, char *search, char *replace) {
 	for(uint32_t i=0; string[i] != 0; i++) { // Find search string
 		uint32_t j=0;
@@ -142,6 +144,8 @@ THD_FUNCTION(modulePOS, arg) {
 			radioMSG_t msg;
 			msg.freq = getFrequency(&config->frequency);
 			msg.power = config->power;
+			msg.priority = RADIO_PRIO_POSITION;
+			msg.deadline = chVTGetSystemTimeX() + S2ST(POS_TX_DEADLINE);
 
 			switch(config->protocol) {
 
@@ -152,7 +156,8 @@ THD_FUNCTION(modulePOS, arg) {
 					msg.gfsk_config = &(config->gfsk_config);
 					msg.afsk_config = &(config->afsk_config);
 
-					msg.bin_len = aprs_encode_position(msg.msg, msg.mod, &(config->aprs_config), trackPoint); // Encode packet
+					radioAllocMSG(&msg);
+					msg.bin_len = aprs_encode_position(msg.msg, msg.msg_size, msg.mod, &(config->aprs_config), trackPoint); // Encode packet
 					transmitOnRadio(&msg);
 
 					// Telemetry encoding parameter transmission
@@ -171,7 +176,8 @@ THD_FUNCTION(modulePOS, arg) {
 							chThdSleepMilliseconds(5000); // Take a litte break between the package transmissions
 
 							const telemetry_config_t tel_config[] = {CONFIG_PARM, CONFIG_UNIT, CONFIG_EQNS, CONFIG_BITS};
-							msg.bin_len = aprs_encode_telemetry_configuration(msg.msg, msg.mod, &(config->aprs_config), tel_config[current_config_count]); // Encode packet
+							radioAllocMSG(&msg);
+							msg.bin_len = aprs_encode_telemetry_configuration(msg.msg, msg.msg_size, msg.mod, &(config->aprs_config), tel_config[current_config_count]); // Encode packet
 							transmitOnRadio(&msg);
 
 							current_config_count++;
@@ -189,7 +195,8 @@ THD_FUNCTION(modulePOS, arg) {
 					memcpy(fskmsg, config->ukhas_config.format, sizeof(config->ukhas_config.format));
 					replace_placeholders(fskmsg, sizeof(fskmsg), trackPoint);
 					str_replace(fskmsg, sizeof(fskmsg), "<CALL>", config->ukhas_config.callsign);
-					msg.bin_len = 8*chsnprintf((char*)msg.msg, sizeof(fskmsg), "$$$$$%s*%04X\n", fskmsg, crc16(fskmsg));
+					radioAllocMSG(&msg);
+					msg.bin_len = 8*chsnprintf((char*)msg.msg, msg.msg_size, "$$$$$%s*%04X\n", fskmsg, crc16(fskmsg));
 
 					// Transmit message
 					transmitOnRadio(&msg);
@@ -206,6 +213,7 @@ THD_FUNCTION(modulePOS, arg) {
 					str_replace(morse, sizeof(morse), "<CALL>", config->morse_config.callsign);
 
 					// Transmit message
+					radioAllocMSG(&msg);
 					msg.bin_len = morse_encode(msg.msg, morse); // Convert message to binary stream
 					transmitOnRadio(&msg);
 					break;
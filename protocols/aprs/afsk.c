@@ -0,0 +1,50 @@
+#include "ch.h"
+#include "afsk.h"
+
+/**
+  * Initializes the generator for a message of the given number of bits.
+  * set and reset are the BSRR words for the high and low pin level.
+  */
+void afsk_init(afsk_t *afsk, const uint8_t *data, uint32_t bits, uint32_t set, uint32_t reset)
+{
+	afsk->data = data;
+	afsk->bits = bits;
+	afsk->bit = 0;
+	afsk->phase = 0;
+	afsk->set = set;
+	afsk->reset = reset;
+}
+
+/**
+  * Writes the samples of the next bits (AFSK_SAMPLES_PER_BAUD words each)
+  * into the buffer. The phase accumulator carries over from bit to bit and
+  * from call to call, so the waveform is phase continuous whatever the chunk
+  * size is. If the message ends, the rest of the buffer is filled with the
+  * last pin level.
+  * Returns the number of bits written.
+  */
+uint32_t afsk_fill(afsk_t *afsk, uint32_t *buffer, uint32_t bits)
+{
+	uint32_t phase = afsk->phase;
+	uint32_t n = afsk->bits - afsk->bit < bits ? afsk->bits - afsk->bit : bits;
+
+	for(uint32_t i=0; i<n; i++) {
+		uint32_t bit = afsk->bit + i;
+		uint32_t delta = (afsk->data[bit >> 3] >> (bit & 7)) & 1 ? AFSK_PHASE_DELTA_1200 : AFSK_PHASE_DELTA_2200;
+
+		for(uint32_t s=0; s<AFSK_SAMPLES_PER_BAUD; s++) {
+			phase += delta;
+			*buffer++ = (phase >> 16) & 1 ? afsk->set : afsk->reset;
+		}
+	}
+
+	// Hold the pin level after the last bit
+	uint32_t idle = (phase >> 16) & 1 ? afsk->set : afsk->reset;
+	for(uint32_t s=n*AFSK_SAMPLES_PER_BAUD; s<bits*AFSK_SAMPLES_PER_BAUD; s++)
+		*buffer++ = idle;
+
+	afsk->phase = phase;
+	afsk->bit += n;
+	return n;
+}
+
@@ -0,0 +1,29 @@
+#ifndef __AFSK_H__
+#define __AFSK_H__
+
+#include "ch.h"
+
+#define AFSK_PLAYBACK_RATE		129000											/* Samples per second (TIM clock 26MHz / 2 / 101) */
+#define AFSK_BAUD_RATE			1200											/* APRS AFSK baudrate */
+#define AFSK_SAMPLES_PER_BAUD	(AFSK_PLAYBACK_RATE / AFSK_BAUD_RATE)			/* Samples per baud */
+#define AFSK_PHASE_DELTA_1200	(((2 * 1200) << 16) / AFSK_PLAYBACK_RATE)		/* Delta-phase per sample for 1200Hz tone */
+#define AFSK_PHASE_DELTA_2200	(((2 * 2200) << 16) / AFSK_PLAYBACK_RATE)		/* Delta-phase per sample for 2200Hz tone */
+
+/**
+  * AFSK sample generator. Produces the modulation pin level of each sample
+  * as a GPIO BSRR word, so the samples can be sent to the port by DMA.
+  */
+typedef struct {
+	const uint8_t *data;	// NRZI encoded bits (LSB first)
+	uint32_t bits;			// Number of bits in data
+	uint32_t bit;			// Next bit to be generated
+	uint32_t phase;			// Phase accumulator (bit 16 is the pin level)
+	uint32_t set;			// BSRR word setting the pin
+	uint32_t reset;			// BSRR word resetting the pin
+} afsk_t;
+
+void afsk_init(afsk_t *afsk, const uint8_t *data, uint32_t bits, uint32_t set, uint32_t reset);
+uint32_t afsk_fill(afsk_t *afsk, uint32_t *buffer, uint32_t bits);
+
+#endif
+
@@ -29,6 +29,19 @@
 static uint16_t loss_of_gps_counter = 0;
 static uint16_t msg_id;
 
+/**
+ * Returns the size of the encoded frame in bits or 0 if the frame didn't fit
+ * into the message buffer
+ */
+static uint32_t frame_size(ax25_t *packet)
+{
+	if(packet->overflow) {
+		TRACE_ERROR("APRS > Frame exceeds message buffer of %d bytes", packet->max_size);
+		return 0;
+	}
+	return packet->size;
+}
+
 /**
  * Transmit APRS position packet. The comments are filled with:
  * - Static comment (can be set in config.h)
@@ -39,13 +52,13 @@ static uint16_t msg_id;
  * - Number of satellites being used
  * - Number of cycles where GPS has been lost (if applicable in cycle)
  */
-uint32_t aprs_encode_position(uint8_t* message, mod_t mod, const aprs_config_t *config, trackPoint_t *trackPoint)
+uint32_t aprs_encode_position(uint8_t* message, size_t size, mod_t mod, const aprs_config_t *config, trackPoint_t *trackPoint)
 {
 	char temp[22];
 	ptime_t date = trackPoint->time;
 	ax25_t packet;
 	packet.data = message;
-	packet.max_size = 512; // TODO: replace 512 with real size
+	packet.max_size = size;
 	packet.mod = mod;
 
 	ax25_send_header(&packet, config->callsign, config->ssid, config->path, config->preamble);
@@ -158,20 +171,18 @@ uint32_t aprs_encode_position(uint8_t* message, mod_t mod, const aprs_config_t *
 	ax25_send_byte(&packet, '|');
 
 	ax25_send_footer(&packet);
-	scramble(&packet);
-	nrzi_encode(&packet);
 
-	return packet.size;
+	return frame_size(&packet);
 }
 
 /**
  * Transmit custom experimental packet
  */
-uint32_t aprs_encode_experimental(char packetType, uint8_t* message, mod_t mod, const aprs_config_t *config, uint8_t *data, size_t size)
+uint32_t aprs_encode_experimental(char packetType, uint8_t* message, size_t size, mod_t mod, const aprs_config_t *config, uint8_t *data, size_t data_size)
 {
 	ax25_t packet;
 	packet.data = message;
-	packet.max_size = 512; // TODO: replace 512 with real size
+	packet.max_size = size;
 	packet.mod = mod;
 
 	// Encode APRS header
@@ -180,25 +191,23 @@ uint32_t aprs_encode_experimental(char packetType, uint8_t* message, mod_t mod,
 	ax25_send_byte(&packet, packetType);
 
 	// Encode message
-	for(uint16_t i=0; i<size; i++)
+	for(uint16_t i=0; i<data_size; i++)
 		ax25_send_byte(&packet, data[i]);
 
 	// Send footer
 	ax25_send_footer(&packet);
-	scramble(&packet);
-	nrzi_encode(&packet);
 
-	return packet.size;
+	return frame_size(&packet);
 }
 
 /**
  * Transmit message packet
  */
-uint32_t aprs_encode_message(uint8_t* message, mod_t mod, const aprs_config_t *config, const char *receiver, const char *text)
+uint32_t aprs_encode_message(uint8_t* message, size_t size, mod_t mod, const aprs_config_t *config, const char *receiver, const char *text)
 {
 	ax25_t packet;
 	packet.data = message;
-	packet.max_size = 512; // TODO: replace 512 with real size
+	packet.max_size = size;
 	packet.mod = mod;
 
 	// Encode APRS header
@@ -218,21 +227,19 @@ uint32_t aprs_encode_message(uint8_t* message, mod_t mod, const aprs_config_t *c
 
 	// Send footer
 	ax25_send_footer(&packet);
-	scramble(&packet);
-	nrzi_encode(&packet);
 
-	return packet.size;
+	return frame_size(&packet);
 }
 
 /**
  * Transmit APRS telemetry configuration
  */
-uint32_t aprs_encode_telemetry_configuration(uint8_t* message, mod_t mod, const aprs_config_t *config, const telemetry_config_t type)
+uint32_t aprs_encode_telemetry_configuration(uint8_t* message, size_t size, mod_t mod, const aprs_config_t *config, const telemetry_config_t type)
 {
 	char temp[4];
 	ax25_t packet;
 	packet.data = message;
-	packet.max_size = 512; // TODO: replace 512 with real size
+	packet.max_size = size;
 	packet.mod = mod;
 
 	ax25_send_header(&packet, config->callsign, config->ssid, config->path, config->preamble); // Header
@@ -367,9 +374,7 @@ uint32_t aprs_encode_telemetry_configuration(uint8_t* message, mod_t mod, const
 	}
 
 	ax25_send_footer(&packet); // Footer
-	scramble(&packet);
-	nrzi_encode(&packet);
 	
-	return packet.size;
+	return frame_size(&packet);
 }
 
@@ -42,10 +42,10 @@
 #define APRS_DEST_CALLSIGN				"APECAN" // APExxx = Pecan device
 #define APRS_DEST_SSID					0
 
-uint32_t aprs_encode_position(uint8_t* message, mod_t mod, const aprs_config_t *config, trackPoint_t *trackPoint);
-uint32_t aprs_encode_telemetry_configuration(uint8_t* message, mod_t mod, const aprs_config_t *config, const telemetry_config_t type);
-uint32_t aprs_encode_message(uint8_t* message, mod_t mod, const aprs_config_t *config, const char *receiver, const char *text);
-uint32_t aprs_encode_experimental(char packetType, uint8_t* message, mod_t mod, const aprs_config_t *config, uint8_t *image, size_t size);
+uint32_t aprs_encode_position(uint8_t* message, size_t size, mod_t mod, const aprs_config_t *config, trackPoint_t *trackPoint);
+uint32_t aprs_encode_telemetry_configuration(uint8_t* message, size_t size, mod_t mod, const aprs_config_t *config, const telemetry_config_t type);
+uint32_t aprs_encode_message(uint8_t* message, size_t size, mod_t mod, const aprs_config_t *config, const char *receiver, const char *text);
+uint32_t aprs_encode_experimental(char packetType, uint8_t* message, size_t size, mod_t mod, const aprs_config_t *config, uint8_t *data, size_t data_size);
 
 #endif
 
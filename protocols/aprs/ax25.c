@@ -21,12 +21,43 @@
 #include "debug.h"
 #include "aprs.h"
 
-#define AX25_WRITE_BIT(data, size) { \
-	data[size >> 3] |= (1 << (size & 7)); \
-}
-#define AX25_CLEAR_BIT(data, size) { \
-	data[size >> 3] &= ~(1 << (size & 7)); \
-}
+/**
+  * CRC-16/X.25 lookup table (reflected polynom 0x8408), one entry per byte
+  */
+static const uint16_t crc_table[256] = {
+	0x0000, 0x1189, 0x2312, 0x329b, 0x4624, 0x57ad, 0x6536, 0x74bf,
+	0x8c48, 0x9dc1, 0xaf5a, 0xbed3, 0xca6c, 0xdbe5, 0xe97e, 0xf8f7,
+	0x1081, 0x0108, 0x3393, 0x221a, 0x56a5, 0x472c, 0x75b7, 0x643e,
+	0x9cc9, 0x8d40, 0xbfdb, 0xae52, 0xdaed, 0xcb64, 0xf9ff, 0xe876,
+	0x2102, 0x308b, 0x0210, 0x1399, 0x6726, 0x76af, 0x4434, 0x55bd,
+	0xad4a, 0xbcc3, 0x8e58, 0x9fd1, 0xeb6e, 0xfae7, 0xc87c, 0xd9f5,
+	0x3183, 0x200a, 0x1291, 0x0318, 0x77a7, 0x662e, 0x54b5, 0x453c,
+	0xbdcb, 0xac42, 0x9ed9, 0x8f50, 0xfbef, 0xea66, 0xd8fd, 0xc974,
+	0x4204, 0x538d, 0x6116, 0x709f, 0x0420, 0x15a9, 0x2732, 0x36bb,
+	0xce4c, 0xdfc5, 0xed5e, 0xfcd7, 0x8868, 0x99e1, 0xab7a, 0xbaf3,
+	0x5285, 0x430c, 0x7197, 0x601e, 0x14a1, 0x0528, 0x37b3, 0x263a,
+	0xdecd, 0xcf44, 0xfddf, 0xec56, 0x98e9, 0x8960, 0xbbfb, 0xaa72,
+	0x6306, 0x728f, 0x4014, 0x519d, 0x2522, 0x34ab, 0x0630, 0x17b9,
+	0xef4e, 0xfec7, 0xcc5c, 0xddd5, 0xa96a, 0xb8e3, 0x8a78, 0x9bf1,
+	0x7387, 0x620e, 0x5095, 0x411c, 0x35a3, 0x242a, 0x16b1, 0x0738,
+	0xffcf, 0xee46, 0xdcdd, 0xcd54, 0xb9eb, 0xa862, 0x9af9, 0x8b70,
+	0x8408, 0x9581, 0xa71a, 0xb693, 0xc22c, 0xd3a5, 0xe13e, 0xf0b7,
+	0x0840, 0x19c9, 0x2b52, 0x3adb, 0x4e64, 0x5fed, 0x6d76, 0x7cff,
+	0x9489, 0x8500, 0xb79b, 0xa612, 0xd2ad, 0xc324, 0xf1bf, 0xe036,
+	0x18c1, 0x0948, 0x3bd3, 0x2a5a, 0x5ee5, 0x4f6c, 0x7df7, 0x6c7e,
+	0xa50a, 0xb483, 0x8618, 0x9791, 0xe32e, 0xf2a7, 0xc03c, 0xd1b5,
+	0x2942, 0x38cb, 0x0a50, 0x1bd9, 0x6f66, 0x7eef, 0x4c74, 0x5dfd,
+	0xb58b, 0xa402, 0x9699, 0x8710, 0xf3af, 0xe226, 0xd0bd, 0xc134,
+	0x39c3, 0x284a, 0x1ad1, 0x0b58, 0x7fe7, 0x6e6e, 0x5cf5, 0x4d7c,
+	0xc60c, 0xd785, 0xe51e, 0xf497, 0x8028, 0x91a1, 0xa33a, 0xb2b3,
+	0x4a44, 0x5bcd, 0x6956, 0x78df, 0x0c60, 0x1de9, 0x2f72, 0x3efb,
+	0xd68d, 0xc704, 0xf59f, 0xe416, 0x90a9, 0x8120, 0xb3bb, 0xa232,
+	0x5ac5, 0x4b4c, 0x79d7, 0x685e, 0x1ce1, 0x0d68, 0x3ff3, 0x2e7a,
+	0xe70e, 0xf687, 0xc41c, 0xd595, 0xa12a, 0xb0a3, 0x8238, 0x93b1,
+	0x6b46, 0x7acf, 0x4854, 0x59dd, 0x2d62, 0x3ceb, 0x0e70, 0x1ff9,
+	0xf78f, 0xe606, 0xd49d, 0xc514, 0xb1ab, 0xa022, 0x92b9, 0x8330,
+	0x7bc7, 0x6a4e, 0x58d5, 0x495c, 0x3de3, 0x2c6a, 0x1ef1, 0x0f78,
+};
 
 static void update_crc(ax25_t *packet, char bit)
 {
@@ -37,39 +68,123 @@ static void update_crc(ax25_t *packet, char bit)
 		packet->crc = packet->crc >> 1;
 }
 
-uint32_t lfsr;
-uint8_t scramble_bit(uint8_t _in) {
-	uint8_t x = (_in ^ (lfsr >> 16) ^ (lfsr >> 11)) & 1;
-	lfsr = (lfsr << 1) | (x & 1);
-	return x;
+static inline void update_crc_byte(ax25_t *packet, uint8_t byte)
+{
+	packet->crc = (packet->crc >> 8) ^ crc_table[(packet->crc ^ byte) & 0xff];
 }
 
-static void send_byte(ax25_t *packet, char byte)
+/**
+  * Output stage. Scrambles (G3RUH, 2GFSK only) and NRZI encodes up to 12
+  * stuffed bits (LSB first) at once and collects them in a 32 bit word,
+  * which is written to the buffer when full. Bits beyond the buffer are
+  * dropped.
+  *
+  * The scrambler keeps the last 17 output bits in chronological order
+  * (oldest in bit 0), so x^-17 and x^-12 of all bits of the chunk can be
+  * taken from the state at once.
+  */
+static inline void emit_bits(ax25_t *packet, uint32_t bits, uint8_t n)
 {
-	int i;
-	for(i=0; i<8; i++) {
+	uint32_t mask = (1 << n) - 1;
+
+	if(packet->size + n > packet->max_size * 8) { // Prevent buffer overrun
+		packet->overflow = true;
+		if(packet->size >= packet->max_size * 8)
+			return;
+		n = packet->max_size * 8 - packet->size;
+		mask = (1 << n) - 1;
+	}
+
+	// Scrambling (x^17 + x^12 + 1)
+	if(packet->mod == MOD_2GFSK) {
+		bits = (bits ^ packet->lfsr ^ (packet->lfsr >> 5)) & mask;
+		packet->lfsr = ((packet->lfsr >> n) | (bits << (17 - n))) & 0x1ffff;
+	}
+
+	// NRZ-I (0: tone change, 1: no tone change), tone is the running parity of the zeros
+	uint32_t tone = ~bits & mask;
+	tone ^= tone << 1;
+	tone ^= tone << 2;
+	tone ^= tone << 4;
+	tone ^= tone << 8;
+	tone = (tone ^ (packet->tone ? 0xffffffff : 0)) & mask;
+	packet->tone = (tone >> (n - 1)) & 1;
+
+	// Collect output word
+	packet->word |= tone << packet->word_bits;
+	packet->word_bits += n;
+	packet->size += n;
+	if(packet->word_bits >= 32) {
+		uint8_t *p = &packet->data[(packet->size - packet->word_bits) >> 3];
+		p[0] = packet->word;
+		p[1] = packet->word >> 8;
+		p[2] = packet->word >> 16;
+		p[3] = packet->word >> 24;
+		packet->word_bits -= 32;
+		packet->word = packet->word_bits ? tone >> (n - packet->word_bits) : 0;
+	}
+}
+
+/**
+  * Writes the bits left in the output word
+  */
+static void flush_bits(ax25_t *packet)
+{
+	uint8_t *p = &packet->data[(packet->size - packet->word_bits) >> 3];
+	for(uint8_t i=0; i<packet->word_bits; i+=8)
+		*p++ = packet->word >> i;
+	packet->word = 0;
+	packet->word_bits = 0;
+}
+
+/**
+  * Per-bit encoder, stuffs a zero after five ones in a row
+  */
+static void send_byte_bitwise(ax25_t *packet, char byte)
+{
+	uint32_t bits = 0;
+	uint8_t n = 0;
+
+	for(uint8_t i=0; i<8; i++) {
 		update_crc(packet, (byte >> i) & 1);
 		if((byte >> i) & 1) {
 			// Next bit is a '1'
-			if(packet->size >= packet->max_size * 8)  // Prevent buffer overrun
-				return;
-
-			AX25_WRITE_BIT(packet->data, packet->size);
-
-			packet->size++;
+			bits |= 1 << n++;
 			packet->ones_in_a_row++;
 			if(packet->ones_in_a_row < 5)
 				continue;
 		}
 		// Next bit is a '0' or a zero padding after 5 ones in a row
-		if(packet->size >= packet->max_size * 8)    // Prevent buffer overrun
-			return;
+		n++;
+		packet->ones_in_a_row = 0;
+	}
 
-		AX25_CLEAR_BIT(packet->data, packet->size);
+	emit_bits(packet, bits, n);
+}
 
-		packet->size++;
-		packet->ones_in_a_row = 0;
+/**
+  * Encodes a byte (LSB first). Bytes which can't produce five ones in a row
+  * (including the ones of the previous byte) need no stuffing and are
+  * passed on as a whole, all others go through the per-bit encoder.
+  */
+static void send_byte(ax25_t *packet, char byte)
+{
+	uint8_t b = byte;
+
+	// Prepend the pending ones and look for a run of five
+	uint32_t run = ((uint32_t)b << 4) | ((0xfu << (4 - packet->ones_in_a_row)) & 0xf);
+	run &= run >> 1;
+	run &= run >> 2;
+	run &= run >> 1;
+
+	if(run) {
+		send_byte_bitwise(packet, byte);
+		return;
 	}
+
+	update_crc_byte(packet, b);
+	emit_bits(packet, b, 8);
+	packet->ones_in_a_row = __builtin_clz(~((uint32_t)b << 24)); // Ones at the end of the byte
 }
 
 void ax25_send_byte(ax25_t *packet, char byte)
@@ -79,30 +194,12 @@ void ax25_send_byte(ax25_t *packet, char byte)
 
 void ax25_send_sync(ax25_t *packet)
 {
-	unsigned char byte = 0x00;
-	int i;
-	for(i=0; i<8; i++, packet->size++) {
-		if(packet->size >= packet->max_size * 8)  // Prevent buffer overrun
-			return;
-		if((byte >> i) & 1)
-			packet->data[packet->size >> 3] |= (1 << (packet->size & 7));
-		else
-			packet->data[packet->size >> 3] &= ~(1 << (packet->size & 7));
-	}
+	emit_bits(packet, 0x00, 8);
 }
 
 void ax25_send_flag(ax25_t *packet)
 {
-  unsigned char byte = 0x7e;
-  int i;
-  for(i=0; i<8; i++, packet->size++) {
-    if(packet->size >= packet->max_size * 8)  // Prevent buffer overrun
-      return;
-    if((byte >> i) & 1)
-      packet->data[packet->size >> 3] |= (1 << (packet->size & 7));
-    else
-      packet->data[packet->size >> 3] &= ~(1 << (packet->size & 7));
-  }
+	emit_bits(packet, 0x7e, 8);
 }
 
 void ax25_send_string(ax25_t *packet, const char *string)
@@ -120,6 +217,11 @@ void ax25_send_header(ax25_t *packet, const char *callsign, uint8_t ssid, const
 	packet->size = 0;
 	packet->ones_in_a_row = 0;
 	packet->crc = 0xffff;
+	packet->overflow = false;
+	packet->word = 0;
+	packet->word_bits = 0;
+	packet->lfsr = 0;
+	packet->tone = 0;
 
 	// Send preamble ("a bunch of 0s")
 	if(packet->mod == MOD_2GFSK) {
@@ -205,40 +307,6 @@ void ax25_send_footer(ax25_t *packet)
 
 	// Signal the end of frame
 	ax25_send_flag(packet);
-}
-
-/**
-  * Scrambling for 2GFSK
-  */
-void scramble(ax25_t *packet) {
-	if(packet->mod != MOD_2GFSK)
-		return; // Scrambling not necessary
-
-	// Scramble
-	lfsr = 0;
-	for(uint32_t i=0; i<packet->size; i++) {
-		uint8_t bit = scramble_bit((packet->data[i >> 3] >> (i & 0x7)) & 0x1);
-		if(bit) {
-			AX25_WRITE_BIT(packet->data, i);
-		} else {
-			AX25_CLEAR_BIT(packet->data, i);
-		}
-	}
-}
-
-/**
-  * NRZ-I tone encoding (0: bit change, 1: no bit change)
-  */
-void nrzi_encode(ax25_t *packet) {
-	uint8_t ctone = 0;
-	for(uint32_t i=0; i<packet->size; i++) {
-		if(((packet->data[i >> 3] >> (i & 0x7)) & 0x1) == 0)
-			ctone = !ctone;
-		if(ctone) {
-			AX25_WRITE_BIT(packet->data, i);
-		} else {
-			AX25_CLEAR_BIT(packet->data, i);
-		}
-	}
+	flush_bits(packet);
 }
 
@@ -30,10 +30,15 @@ typedef struct {
 typedef struct {
 	uint8_t ones_in_a_row;	// Ones in a row (for bitstuffing)
 	uint8_t *data;			// Data
-	uint16_t size;			// Packet size in bits
-	uint16_t max_size;		// Max. Packet size in bits (size of modem packet)
+	uint32_t size;			// Packet size in bits
+	uint32_t max_size;		// Size of data in bytes
+	bool overflow;			// Packet didn't fit into data (truncated)
 	uint16_t crc;			// CRC
 	mod_t mod;				// Modulation type (MOD_AFSK or MOD_2GFSK)
+	uint32_t word;			// Encoded bits not yet written to data
+	uint8_t word_bits;		// Number of bits in word
+	uint32_t lfsr;			// Scrambler state (last 17 bits, 2GFSK only)
+	uint8_t tone;			// NRZ-I tone
 } ax25_t;
 
 void ax25_send_header(ax25_t *packet, const char *callsign, uint8_t ssid, const char *path, uint16_t preamble);
@@ -41,8 +46,6 @@ void ax25_send_path(ax25_t *packet, const char *callsign, uint8_t ssid, bool las
 void ax25_send_byte(ax25_t *packet, char byte);
 void ax25_send_string(ax25_t *packet, const char *string);
 void ax25_send_footer(ax25_t *packet);
-void scramble(ax25_t *packet);
-void nrzi_encode(ax25_t *packet);
 
 #endif
 
@@ -0,0 +1,11 @@
+#ifndef __CRC32_H__
+#define __CRC32_H__
+
+#include <stdint.h>
+#include <stddef.h>
+
+uint32_t crc32_update(uint32_t crc, const uint8_t *data, size_t length);
+uint32_t crc32(void *data, size_t length);
+
+#endif
+
@@ -46,12 +46,6 @@ static const uint8_t INDEX_OF[] = {
 0x2E,0x4B,0xB9,0x60,0x0F,0xED,0x3E,0xE5,0xF6,0x87,0xA5,0x17,0x3A,0xA3,0x3C,0xB7,
 };
 
-static const uint8_t GENPOLY[] = {
-0x00,0xF9,0x3B,0x42,0x04,0x2B,0x7E,0xFB,0x61,0x1E,0x03,0xD5,0x32,0x42,0xAA,0x05,
-0x18,0x05,0xAA,0x42,0x32,0xD5,0x03,0x1E,0x61,0xFB,0x7E,0x2B,0x04,0x42,0x3B,0xF9,
-0x00,
-};
-
 static inline int mod255(int x)
 {
 	while(x >= 255)
@@ -73,48 +67,300 @@ static inline int mod255(int x)
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 #define A0       (NN) /* Special reserved value encoding zero in index form */
 
-/* Portable C version */
+/* Generator multiples: GENTAB[f] is the parity update for feedback symbol f,
+ * shifted by one symbol and packed four symbols per word (first in the LSB) */
+static const uint32_t GENTAB[256][NROOTS / 4] = {
+{0x00000000,0x00000000,0x00000000,0x00000000,0x00000000,0x00000000,0x00000000,0x00000000},
+{0x10567F5B,0x61EB0D1E,0x362A08A5,0x7120AB56,0x3656AB20,0x61A5082A,0x101E0DEB,0x015B7F56},
+{0x20ACFEB6,0xC2511A3C,0x6C5410CD,0xE240D1AC,0x6CACD140,0xC2CD1054,0x203C1A51,0x02B6FEAC},
+{0x30FA81ED,0xA3BA1722,0x5A7E1868,0x93607AFA,0x5AFA7A60,0xA368187E,0x302217BA,0x03ED81FA},
+{0x40DF7BEB,0x03A23478,0xD8A8201D,0x438025DF,0xD8DF2580,0x031D20A8,0x407834A2,0x04EB7BDF},
+{0x508904B0,0x62493966,0xEE8228B8,0x32A08E89,0xEE898EA0,0x62B82882,0x50663949,0x05B00489},
+{0x6073855D,0xC1F32E44,0xB4FC30D0,0xA1C0F473,0xB473F4C0,0xC1D030FC,0x60442EF3,0x065D8573},
+{0x7025FA06,0xA018235A,0x82D63875,0xD0E05F25,0x82255FE0,0xA07538D6,0x705A2318,0x0706FA25},
+{0x8039F651,0x06C368F0,0x37D7403A,0x86874A39,0x37394A87,0x063A40D7,0x80F068C3,0x0851F639},
+{0x906F890A,0x672865EE,0x01FD489F,0xF7A7E16F,0x016FE1A7,0x679F48FD,0x90EE6528,0x090A896F},
+{0xA09508E7,0xC49272CC,0x5B8350F7,0x64C79B95,0x5B959BC7,0xC4F75083,0xA0CC7292,0x0AE70895},
+{0xB0C377BC,0xA5797FD2,0x6DA95852,0x15E730C3,0x6DC330E7,0xA55258A9,0xB0D27F79,0x0BBC77C3},
+{0xC0E68DBA,0x05615C88,0xEF7F6027,0xC5076FE6,0xEFE66F07,0x0527607F,0xC0885C61,0x0CBA8DE6},
+{0xD0B0F2E1,0x648A5196,0xD9556882,0xB427C4B0,0xD9B0C427,0x64826855,0xD096518A,0x0DE1F2B0},
+{0xE04A730C,0xC73046B4,0x832B70EA,0x2747BE4A,0x834ABE47,0xC7EA702B,0xE0B44630,0x0E0C734A},
+{0xF01C0C57,0xA6DB4BAA,0xB501784F,0x5667151C,0xB51C1567,0xA64F7801,0xF0AA4BDB,0x0F570C1C},
+{0x87726BA2,0x0C01D067,0x6E298074,0x8B899472,0x6E729489,0x0C748029,0x8767D001,0x10A26B72},
+{0x972414F9,0x6DEADD79,0x580388D1,0xFAA93F24,0x58243FA9,0x6DD18803,0x9779DDEA,0x11F91424},
+{0xA7DE9514,0xCE50CA5B,0x027D90B9,0x69C945DE,0x02DE45C9,0xCEB9907D,0xA75BCA50,0x121495DE},
+{0xB788EA4F,0xAFBBC745,0x3457981C,0x18E9EE88,0x3488EEE9,0xAF1C9857,0xB745C7BB,0x134FEA88},
+{0xC7AD1049,0x0FA3E41F,0xB681A069,0xC809B1AD,0xB6ADB109,0x0F69A081,0xC71FE4A3,0x144910AD},
+{0xD7FB6F12,0x6E48E901,0x80ABA8CC,0xB9291AFB,0x80FB1A29,0x6ECCA8AB,0xD701E948,0x15126FFB},
+{0xE701EEFF,0xCDF2FE23,0xDAD5B0A4,0x2A496001,0xDA016049,0xCDA4B0D5,0xE723FEF2,0x16FFEE01},
+{0xF75791A4,0xAC19F33D,0xECFFB801,0x5B69CB57,0xEC57CB69,0xAC01B8FF,0xF73DF319,0x17A49157},
+{0x074B9DF3,0x0AC2B897,0x59FEC04E,0x0D0EDE4B,0x594BDE0E,0x0A4EC0FE,0x0797B8C2,0x18F39D4B},
+{0x171DE2A8,0x6B29B589,0x6FD4C8EB,0x7C2E751D,0x6F1D752E,0x6BEBC8D4,0x1789B529,0x19A8E21D},
+{0x27E76345,0xC893A2AB,0x35AAD083,0xEF4E0FE7,0x35E70F4E,0xC883D0AA,0x27ABA293,0x1A4563E7},
+{0x37B11C1E,0xA978AFB5,0x0380D826,0x9E6EA4B1,0x03B1A46E,0xA926D880,0x37B5AF78,0x1B1E1CB1},
+{0x4794E618,0x09608CEF,0x8156E053,0x4E8EFB94,0x8194FB8E,0x0953E056,0x47EF8C60,0x1C18E694},
+{0x57C29943,0x688B81F1,0xB77CE8F6,0x3FAE50C2,0xB7C250AE,0x68F6E87C,0x57F1818B,0x1D4399C2},
+{0x673818AE,0xCB3196D3,0xED02F09E,0xACCE2A38,0xED382ACE,0xCB9EF002,0x67D39631,0x1EAE1838},
+{0x776E67F5,0xAADA9BCD,0xDB28F83B,0xDDEE816E,0xDB6E81EE,0xAA3BF828,0x77CD9BDA,0x1FF5676E},
+{0x89E4D6C3,0x180227CE,0xDC5287E8,0x9195AFE4,0xDCE4AF95,0x18E88752,0x89CE2702,0x20C3D6E4},
+{0x99B2A998,0x79E92AD0,0xEA788F4D,0xE0B504B2,0xEAB204B5,0x794D8F78,0x99D02AE9,0x2198A9B2},
+{0xA9482875,0xDA533DF2,0xB0069725,0x73D57E48,0xB0487ED5,0xDA259706,0xA9F23D53,0x22752848},
+{0xB91E572E,0xBBB830EC,0x862C9F80,0x02F5D51E,0x861ED5F5,0xBB809F2C,0xB9EC30B8,0x232E571E},
+{0xC93BAD28,0x1BA013B6,0x04FAA7F5,0xD2158A3B,0x043B8A15,0x1BF5A7FA,0xC9B613A0,0x2428AD3B},
+{0xD96DD273,0x7A4B1EA8,0x32D0AF50,0xA335216D,0x326D2135,0x7A50AFD0,0xD9A81E4B,0x2573D26D},
+{0xE997539E,0xD9F1098A,0x68AEB738,0x30555B97,0x68975B55,0xD938B7AE,0xE98A09F1,0x269E5397},
+{0xF9C12CC5,0xB81A0494,0x5E84BF9D,0x4175F0C1,0x5EC1F075,0xB89DBF84,0xF994041A,0x27C52CC1},
+{0x09DD2092,0x1EC14F3E,0xEB85C7D2,0x1712E5DD,0xEBDDE512,0x1ED2C785,0x093E4FC1,0x289220DD},
+{0x198B5FC9,0x7F2A4220,0xDDAFCF77,0x66324E8B,0xDD8B4E32,0x7F77CFAF,0x1920422A,0x29C95F8B},
+{0x2971DE24,0xDC905502,0x87D1D71F,0xF5523471,0x87713452,0xDC1FD7D1,0x29025590,0x2A24DE71},
+{0x3927A17F,0xBD7B581C,0xB1FBDFBA,0x84729F27,0xB1279F72,0xBDBADFFB,0x391C587B,0x2B7FA127},
+{0x49025B79,0x1D637B46,0x332DE7CF,0x5492C002,0x3302C092,0x1DCFE72D,0x49467B63,0x2C795B02},
+{0x59542422,0x7C887658,0x0507EF6A,0x25B26B54,0x05546BB2,0x7C6AEF07,0x59587688,0x2D222454},
+{0x69AEA5CF,0xDF32617A,0x5F79F702,0xB6D211AE,0x5FAE11D2,0xDF02F779,0x697A6132,0x2ECFA5AE},
+{0x79F8DA94,0xBED96C64,0x6953FFA7,0xC7F2BAF8,0x69F8BAF2,0xBEA7FF53,0x79646CD9,0x2F94DAF8},
+{0x0E96BD61,0x1403F7A9,0xB27B079C,0x1A1C3B96,0xB2963B1C,0x149C077B,0x0EA9F703,0x3061BD96},
+{0x1EC0C23A,0x75E8FAB7,0x84510F39,0x6B3C90C0,0x84C0903C,0x75390F51,0x1EB7FAE8,0x313AC2C0},
+{0x2E3A43D7,0xD652ED95,0xDE2F1751,0xF85CEA3A,0xDE3AEA5C,0xD651172F,0x2E95ED52,0x32D7433A},
+{0x3E6C3C8C,0xB7B9E08B,0xE8051FF4,0x897C416C,0xE86C417C,0xB7F41F05,0x3E8BE0B9,0x338C3C6C},
+{0x4E49C68A,0x17A1C3D1,0x6AD32781,0x599C1E49,0x6A491E9C,0x178127D3,0x4ED1C3A1,0x348AC649},
+{0x5E1FB9D1,0x764ACECF,0x5CF92F24,0x28BCB51F,0x5C1FB5BC,0x76242FF9,0x5ECFCE4A,0x35D1B91F},
+{0x6EE5383C,0xD5F0D9ED,0x0687374C,0xBBDCCFE5,0x06E5CFDC,0xD54C3787,0x6EEDD9F0,0x363C38E5},
+{0x7EB34767,0xB41BD4F3,0x30AD3FE9,0xCAFC64B3,0x30B364FC,0xB4E93FAD,0x7EF3D41B,0x376747B3},
+{0x8EAF4B30,0x12C09F59,0x85AC47A6,0x9C9B71AF,0x85AF719B,0x12A647AC,0x8E599FC0,0x38304BAF},
+{0x9EF9346B,0x732B9247,0xB3864F03,0xEDBBDAF9,0xB3F9DABB,0x73034F86,0x9E47922B,0x396B34F9},
+{0xAE03B586,0xD0918565,0xE9F8576B,0x7EDBA003,0xE903A0DB,0xD06B57F8,0xAE658591,0x3A86B503},
+{0xBE55CADD,0xB17A887B,0xDFD25FCE,0x0FFB0B55,0xDF550BFB,0xB1CE5FD2,0xBE7B887A,0x3BDDCA55},
+{0xCE7030DB,0x1162AB21,0x5D0467BB,0xDF1B5470,0x5D70541B,0x11BB6704,0xCE21AB62,0x3CDB3070},
+{0xDE264F80,0x7089A63F,0x6B2E6F1E,0xAE3BFF26,0x6B26FF3B,0x701E6F2E,0xDE3FA689,0x3D804F26},
+{0xEEDCCE6D,0xD333B11D,0x31507776,0x3D5B85DC,0x31DC855B,0xD3767750,0xEE1DB133,0x3E6DCEDC},
+{0xFE8AB136,0xB2D8BC03,0x077A7FD3,0x4C7B2E8A,0x078A2E7B,0xB2D37F7A,0xFE03BCD8,0x3F36B18A},
+{0x954F2B01,0x30044E1B,0x3FA48957,0xA5ADD94F,0x3F4FD9AD,0x305789A4,0x951B4E04,0x40012B4F},
+{0x8519545A,0x51EF4305,0x098E81F2,0xD48D7219,0x0919728D,0x51F2818E,0x850543EF,0x415A5419},
+{0xB5E3D5B7,0xF2555427,0x53F0999A,0x47ED08E3,0x53E308ED,0xF29A99F0,0xB5275455,0x42B7D5E3},
+{0xA5B5AAEC,0x93BE5939,0x65DA913F,0x36CDA3B5,0x65B5A3CD,0x933F91DA,0xA53959BE,0x43ECAAB5},
+{0xD59050EA,0x33A67A63,0xE70CA94A,0xE62DFC90,0xE790FC2D,0x334AA90C,0xD5637AA6,0x44EA5090},
+{0xC5C62FB1,0x524D777D,0xD126A1EF,0x970D57C6,0xD1C6570D,0x52EFA126,0xC57D774D,0x45B12FC6},
+{0xF53CAE5C,0xF1F7605F,0x8B58B987,0x046D2D3C,0x8B3C2D6D,0xF187B958,0xF55F60F7,0x465CAE3C},
+{0xE56AD107,0x901C6D41,0xBD72B122,0x754D866A,0xBD6A864D,0x9022B172,0xE5416D1C,0x4707D16A},
+{0x1576DD50,0x36C726EB,0x0873C96D,0x232A9376,0x0876932A,0x366DC973,0x15EB26C7,0x4850DD76},
+{0x0520A20B,0x572C2BF5,0x3E59C1C8,0x520A3820,0x3E20380A,0x57C8C159,0x05F52B2C,0x490BA220},
+{0x35DA23E6,0xF4963CD7,0x6427D9A0,0xC16A42DA,0x64DA426A,0xF4A0D927,0x35D73C96,0x4AE623DA},
+{0x258C5CBD,0x957D31C9,0x520DD105,0xB04AE98C,0x528CE94A,0x9505D10D,0x25C9317D,0x4BBD5C8C},
+{0x55A9A6BB,0x35651293,0xD0DBE970,0x60AAB6A9,0xD0A9B6AA,0x3570E9DB,0x55931265,0x4CBBA6A9},
+{0x45FFD9E0,0x548E1F8D,0xE6F1E1D5,0x118A1DFF,0xE6FF1D8A,0x54D5E1F1,0x458D1F8E,0x4DE0D9FF},
+{0x7505580D,0xF73408AF,0xBC8FF9BD,0x82EA6705,0xBC0567EA,0xF7BDF98F,0x75AF0834,0x4E0D5805},
+{0x65532756,0x96DF05B1,0x8AA5F118,0xF3CACC53,0x8A53CCCA,0x9618F1A5,0x65B105DF,0x4F562753},
+{0x123D40A3,0x3C059E7C,0x518D0923,0x2E244D3D,0x513D4D24,0x3C23098D,0x127C9E05,0x50A3403D},
+{0x026B3FF8,0x5DEE9362,0x67A70186,0x5F04E66B,0x676BE604,0x5D8601A7,0x026293EE,0x51F83F6B},
+{0x3291BE15,0xFE548440,0x3DD919EE,0xCC649C91,0x3D919C64,0xFEEE19D9,0x32408454,0x5215BE91},
+{0x22C7C14E,0x9FBF895E,0x0BF3114B,0xBD4437C7,0x0BC73744,0x9F4B11F3,0x225E89BF,0x534EC1C7},
+{0x52E23B48,0x3FA7AA04,0x8925293E,0x6DA468E2,0x89E268A4,0x3F3E2925,0x5204AAA7,0x54483BE2},
+{0x42B44413,0x5E4CA71A,0xBF0F219B,0x1C84C3B4,0xBFB4C384,0x5E9B210F,0x421AA74C,0x551344B4},
+{0x724EC5FE,0xFDF6B038,0xE57139F3,0x8FE4B94E,0xE54EB9E4,0xFDF33971,0x7238B0F6,0x56FEC54E},
+{0x6218BAA5,0x9C1DBD26,0xD35B3156,0xFEC41218,0xD31812C4,0x9C56315B,0x6226BD1D,0x57A5BA18},
+{0x9204B6F2,0x3AC6F68C,0x665A4919,0xA8A30704,0x660407A3,0x3A19495A,0x928CF6C6,0x58F2B604},
+{0x8252C9A9,0x5B2DFB92,0x507041BC,0xD983AC52,0x5052AC83,0x5BBC4170,0x8292FB2D,0x59A9C952},
+{0xB2A84844,0xF897ECB0,0x0A0E59D4,0x4AE3D6A8,0x0AA8D6E3,0xF8D4590E,0xB2B0EC97,0x5A4448A8},
+{0xA2FE371F,0x997CE1AE,0x3C245171,0x3BC37DFE,0x3CFE7DC3,0x99715124,0xA2AEE17C,0x5B1F37FE},
+{0xD2DBCD19,0x3964C2F4,0xBEF26904,0xEB2322DB,0xBEDB2223,0x390469F2,0xD2F4C264,0x5C19CDDB},
+{0xC28DB242,0x588FCFEA,0x88D861A1,0x9A03898D,0x888D8903,0x58A161D8,0xC2EACF8F,0x5D42B28D},
+{0xF27733AF,0xFB35D8C8,0xD2A679C9,0x0963F377,0xD277F363,0xFBC979A6,0xF2C8D835,0x5EAF3377},
+{0xE2214CF4,0x9ADED5D6,0xE48C716C,0x78435821,0xE4215843,0x9A6C718C,0xE2D6D5DE,0x5FF44C21},
+{0x1CABFDC2,0x280669D5,0xE3F60EBF,0x343876AB,0xE3AB7638,0x28BF0EF6,0x1CD56906,0x60C2FDAB},
+{0x0CFD8299,0x49ED64CB,0xD5DC061A,0x4518DDFD,0xD5FDDD18,0x491A06DC,0x0CCB64ED,0x619982FD},
+{0x3C070374,0xEA5773E9,0x8FA21E72,0xD678A707,0x8F07A778,0xEA721EA2,0x3CE97357,0x62740307},
+{0x2C517C2F,0x8BBC7EF7,0xB98816D7,0xA7580C51,0xB9510C58,0x8BD71688,0x2CF77EBC,0x632F7C51},
+{0x5C748629,0x2BA45DAD,0x3B5E2EA2,0x77B85374,0x3B7453B8,0x2BA22E5E,0x5CAD5DA4,0x64298674},
+{0x4C22F972,0x4A4F50B3,0x0D742607,0x0698F822,0x0D22F898,0x4A072674,0x4CB3504F,0x6572F922},
+{0x7CD8789F,0xE9F54791,0x570A3E6F,0x95F882D8,0x57D882F8,0xE96F3E0A,0x7C9147F5,0x669F78D8},
+{0x6C8E07C4,0x881E4A8F,0x612036CA,0xE4D8298E,0x618E29D8,0x88CA3620,0x6C8F4A1E,0x67C4078E},
+{0x9C920B93,0x2EC50125,0xD4214E85,0xB2BF3C92,0xD4923CBF,0x2E854E21,0x9C2501C5,0x68930B92},
+{0x8CC474C8,0x4F2E0C3B,0xE20B4620,0xC39F97C4,0xE2C4979F,0x4F20460B,0x8C3B0C2E,0x69C874C4},
+{0xBC3EF525,0xEC941B19,0xB8755E48,0x50FFED3E,0xB83EEDFF,0xEC485E75,0xBC191B94,0x6A25F53E},
+{0xAC688A7E,0x8D7F1607,0x8E5F56ED,0x21DF4668,0x8E6846DF,0x8DED565F,0xAC07167F,0x6B7E8A68},
+{0xDC4D7078,0x2D67355D,0x0C896E98,0xF13F194D,0x0C4D193F,0x2D986E89,0xDC5D3567,0x6C78704D},
+{0xCC1B0F23,0x4C8C3843,0x3AA3663D,0x801FB21B,0x3A1BB21F,0x4C3D66A3,0xCC43388C,0x6D230F1B},
+{0xFCE18ECE,0xEF362F61,0x60DD7E55,0x137FC8E1,0x60E1C87F,0xEF557EDD,0xFC612F36,0x6ECE8EE1},
+{0xECB7F195,0x8EDD227F,0x56F776F0,0x625F63B7,0x56B7635F,0x8EF076F7,0xEC7F22DD,0x6F95F1B7},
+{0x9BD99660,0x2407B9B2,0x8DDF8ECB,0xBFB1E2D9,0x8DD9E2B1,0x24CB8EDF,0x9BB2B907,0x706096D9},
+{0x8B8FE93B,0x45ECB4AC,0xBBF5866E,0xCE91498F,0xBB8F4991,0x456E86F5,0x8BACB4EC,0x713BE98F},
+{0xBB7568D6,0xE656A38E,0xE18B9E06,0x5DF13375,0xE17533F1,0xE6069E8B,0xBB8EA356,0x72D66875},
+{0xAB23178D,0x87BDAE90,0xD7A196A3,0x2CD19823,0xD72398D1,0x87A396A1,0xAB90AEBD,0x738D1723},
+{0xDB06ED8B,0x27A58DCA,0x5577AED6,0xFC31C706,0x5506C731,0x27D6AE77,0xDBCA8DA5,0x748BED06},
+{0xCB5092D0,0x464E80D4,0x635DA673,0x8D116C50,0x63506C11,0x4673A65D,0xCBD4804E,0x75D09250},
+{0xFBAA133D,0xE5F497F6,0x3923BE1B,0x1E7116AA,0x39AA1671,0xE51BBE23,0xFBF697F4,0x763D13AA},
+{0xEBFC6C66,0x841F9AE8,0x0F09B6BE,0x6F51BDFC,0x0FFCBD51,0x84BEB609,0xEBE89A1F,0x77666CFC},
+{0x1BE06031,0x22C4D142,0xBA08CEF1,0x3936A8E0,0xBAE0A836,0x22F1CE08,0x1B42D1C4,0x783160E0},
+{0x0BB61F6A,0x432FDC5C,0x8C22C654,0x481603B6,0x8CB60316,0x4354C622,0x0B5CDC2F,0x796A1FB6},
+{0x3B4C9E87,0xE095CB7E,0xD65CDE3C,0xDB76794C,0xD64C7976,0xE03CDE5C,0x3B7ECB95,0x7A879E4C},
+{0x2B1AE1DC,0x817EC660,0xE076D699,0xAA56D21A,0xE01AD256,0x8199D676,0x2B60C67E,0x7BDCE11A},
+{0x5B3F1BDA,0x2166E53A,0x62A0EEEC,0x7AB68D3F,0x623F8DB6,0x21ECEEA0,0x5B3AE566,0x7CDA1B3F},
+{0x4B696481,0x408DE824,0x548AE649,0x0B962669,0x54692696,0x4049E68A,0x4B24E88D,0x7D816469},
+{0x7B93E56C,0xE337FF06,0x0EF4FE21,0x98F65C93,0x0E935CF6,0xE321FEF4,0x7B06FF37,0x7E6CE593},
+{0x6BC59A37,0x82DCF218,0x38DEF684,0xE9D6F7C5,0x38C5F7D6,0x8284F6DE,0x6B18F2DC,0x7F379AC5},
+{0xAD9E5602,0x60089C36,0x7ECF95AE,0xCDDD359E,0x7E9E35DD,0x60AE95CF,0xAD369C08,0x8002569E},
+{0xBDC82959,0x01E39128,0x48E59D0B,0xBCFD9EC8,0x48C89EFD,0x010B9DE5,0xBD2891E3,0x815929C8},
+{0x8D32A8B4,0xA259860A,0x129B8563,0x2F9DE432,0x1232E49D,0xA263859B,0x8D0A8659,0x82B4A832},
+{0x9D64D7EF,0xC3B28B14,0x24B18DC6,0x5EBD4F64,0x24644FBD,0xC3C68DB1,0x9D148BB2,0x83EFD764},
+{0xED412DE9,0x63AAA84E,0xA667B5B3,0x8E5D1041,0xA641105D,0x63B3B567,0xED4EA8AA,0x84E92D41},
+{0xFD1752B2,0x0241A550,0x904DBD16,0xFF7DBB17,0x9017BB7D,0x0216BD4D,0xFD50A541,0x85B25217},
+{0xCDEDD35F,0xA1FBB272,0xCA33A57E,0x6C1DC1ED,0xCAEDC11D,0xA17EA533,0xCD72B2FB,0x865FD3ED},
+{0xDDBBAC04,0xC010BF6C,0xFC19ADDB,0x1D3D6ABB,0xFCBB6A3D,0xC0DBAD19,0xDD6CBF10,0x8704ACBB},
+{0x2DA7A053,0x66CBF4C6,0x4918D594,0x4B5A7FA7,0x49A77F5A,0x6694D518,0x2DC6F4CB,0x8853A0A7},
+{0x3DF1DF08,0x0720F9D8,0x7F32DD31,0x3A7AD4F1,0x7FF1D47A,0x0731DD32,0x3DD8F920,0x8908DFF1},
+{0x0D0B5EE5,0xA49AEEFA,0x254CC559,0xA91AAE0B,0x250BAE1A,0xA459C54C,0x0DFAEE9A,0x8AE55E0B},
+{0x1D5D21BE,0xC571E3E4,0x1366CDFC,0xD83A055D,0x135D053A,0xC5FCCD66,0x1DE4E371,0x8BBE215D},
+{0x6D78DBB8,0x6569C0BE,0x91B0F589,0x08DA5A78,0x91785ADA,0x6589F5B0,0x6DBEC069,0x8CB8DB78},
+{0x7D2EA4E3,0x0482CDA0,0xA79AFD2C,0x79FAF12E,0xA72EF1FA,0x042CFD9A,0x7DA0CD82,0x8DE3A42E},
+{0x4DD4250E,0xA738DA82,0xFDE4E544,0xEA9A8BD4,0xFDD48B9A,0xA744E5E4,0x4D82DA38,0x8E0E25D4},
+{0x5D825A55,0xC6D3D79C,0xCBCEEDE1,0x9BBA2082,0xCB8220BA,0xC6E1EDCE,0x5D9CD7D3,0x8F555A82},
+{0x2AEC3DA0,0x6C094C51,0x10E615DA,0x4654A1EC,0x10ECA154,0x6CDA15E6,0x2A514C09,0x90A03DEC},
+{0x3ABA42FB,0x0DE2414F,0x26CC1D7F,0x37740ABA,0x26BA0A74,0x0D7F1DCC,0x3A4F41E2,0x91FB42BA},
+{0x0A40C316,0xAE58566D,0x7CB20517,0xA4147040,0x7C407014,0xAE1705B2,0x0A6D5658,0x9216C340},
+{0x1A16BC4D,0xCFB35B73,0x4A980DB2,0xD534DB16,0x4A16DB34,0xCFB20D98,0x1A735BB3,0x934DBC16},
+{0x6A33464B,0x6FAB7829,0xC84E35C7,0x05D48433,0xC83384D4,0x6FC7354E,0x6A2978AB,0x944B4633},
+{0x7A653910,0x0E407537,0xFE643D62,0x74F42F65,0xFE652FF4,0x0E623D64,0x7A377540,0x95103965},
+{0x4A9FB8FD,0xADFA6215,0xA41A250A,0xE794559F,0xA49F5594,0xAD0A251A,0x4A1562FA,0x96FDB89F},
+{0x5AC9C7A6,0xCC116F0B,0x92302DAF,0x96B4FEC9,0x92C9FEB4,0xCCAF2D30,0x5A0B6F11,0x97A6C7C9},
+{0xAAD5CBF1,0x6ACA24A1,0x273155E0,0xC0D3EBD5,0x27D5EBD3,0x6AE05531,0xAAA124CA,0x98F1CBD5},
+{0xBA83B4AA,0x0B2129BF,0x111B5D45,0xB1F34083,0x118340F3,0x0B455D1B,0xBABF2921,0x99AAB483},
+{0x8A793547,0xA89B3E9D,0x4B65452D,0x22933A79,0x4B793A93,0xA82D4565,0x8A9D3E9B,0x9A473579},
+{0x9A2F4A1C,0xC9703383,0x7D4F4D88,0x53B3912F,0x7D2F91B3,0xC9884D4F,0x9A833370,0x9B1C4A2F},
+{0xEA0AB01A,0x696810D9,0xFF9975FD,0x8353CE0A,0xFF0ACE53,0x69FD7599,0xEAD91068,0x9C1AB00A},
+{0xFA5CCF41,0x08831DC7,0xC9B37D58,0xF273655C,0xC95C6573,0x08587DB3,0xFAC71D83,0x9D41CF5C},
+{0xCAA64EAC,0xAB390AE5,0x93CD6530,0x61131FA6,0x93A61F13,0xAB3065CD,0xCAE50A39,0x9EAC4EA6},
+{0xDAF031F7,0xCAD207FB,0xA5E76D95,0x1033B4F0,0xA5F0B433,0xCA956DE7,0xDAFB07D2,0x9FF731F0},
+{0x247A80C1,0x780ABBF8,0xA29D1246,0x5C489A7A,0xA27A9A48,0x7846129D,0x24F8BB0A,0xA0C1807A},
+{0x342CFF9A,0x19E1B6E6,0x94B71AE3,0x2D68312C,0x942C3168,0x19E31AB7,0x34E6B6E1,0xA19AFF2C},
+{0x04D67E77,0xBA5BA1C4,0xCEC9028B,0xBE084BD6,0xCED64B08,0xBA8B02C9,0x04C4A15B,0xA2777ED6},
+{0x1480012C,0xDBB0ACDA,0xF8E30A2E,0xCF28E080,0xF880E028,0xDB2E0AE3,0x14DAACB0,0xA32C0180},
+{0x64A5FB2A,0x7BA88F80,0x7A35325B,0x1FC8BFA5,0x7AA5BFC8,0x7B5B3235,0x64808FA8,0xA42AFBA5},
+{0x74F38471,0x1A43829E,0x4C1F3AFE,0x6EE814F3,0x4CF314E8,0x1AFE3A1F,0x749E8243,0xA57184F3},
+{0x4409059C,0xB9F995BC,0x16612296,0xFD886E09,0x16096E88,0xB9962261,0x44BC95F9,0xA69C0509},
+{0x545F7AC7,0xD81298A2,0x204B2A33,0x8CA8C55F,0x205FC5A8,0xD8332A4B,0x54A29812,0xA7C77A5F},
+{0xA4437690,0x7EC9D308,0x954A527C,0xDACFD043,0x9543D0CF,0x7E7C524A,0xA408D3C9,0xA8907643},
+{0xB41509CB,0x1F22DE16,0xA3605AD9,0xABEF7B15,0xA3157BEF,0x1FD95A60,0xB416DE22,0xA9CB0915},
+{0x84EF8826,0xBC98C934,0xF91E42B1,0x388F01EF,0xF9EF018F,0xBCB1421E,0x8434C998,0xAA2688EF},
+{0x94B9F77D,0xDD73C42A,0xCF344A14,0x49AFAAB9,0xCFB9AAAF,0xDD144A34,0x942AC473,0xAB7DF7B9},
+{0xE49C0D7B,0x7D6BE770,0x4DE27261,0x994FF59C,0x4D9CF54F,0x7D6172E2,0xE470E76B,0xAC7B0D9C},
+{0xF4CA7220,0x1C80EA6E,0x7BC87AC4,0xE86F5ECA,0x7BCA5E6F,0x1CC47AC8,0xF46EEA80,0xAD2072CA},
+{0xC430F3CD,0xBF3AFD4C,0x21B662AC,0x7B0F2430,0x2130240F,0xBFAC62B6,0xC44CFD3A,0xAECDF330},
+{0xD4668C96,0xDED1F052,0x179C6A09,0x0A2F8F66,0x17668F2F,0xDE096A9C,0xD452F0D1,0xAF968C66},
+{0xA308EB63,0x740B6B9F,0xCCB49232,0xD7C10E08,0xCC080EC1,0x743292B4,0xA39F6B0B,0xB063EB08},
+{0xB35E9438,0x15E06681,0xFA9E9A97,0xA6E1A55E,0xFA5EA5E1,0x15979A9E,0xB38166E0,0xB138945E},
+{0x83A415D5,0xB65A71A3,0xA0E082FF,0x3581DFA4,0xA0A4DF81,0xB6FF82E0,0x83A3715A,0xB2D515A4},
+{0x93F26A8E,0xD7B17CBD,0x96CA8A5A,0x44A174F2,0x96F274A1,0xD75A8ACA,0x93BD7CB1,0xB38E6AF2},
+{0xE3D79088,0x77A95FE7,0x141CB22F,0x94412BD7,0x14D72B41,0x772FB21C,0xE3E75FA9,0xB48890D7},
+{0xF381EFD3,0x164252F9,0x2236BA8A,0xE5618081,0x22818061,0x168ABA36,0xF3F95242,0xB5D3EF81},
+{0xC37B6E3E,0xB5F845DB,0x7848A2E2,0x7601FA7B,0x787BFA01,0xB5E2A248,0xC3DB45F8,0xB63E6E7B},
+{0xD32D1165,0xD41348C5,0x4E62AA47,0x0721512D,0x4E2D5121,0xD447AA62,0xD3C54813,0xB765112D},
+{0x23311D32,0x72C8036F,0xFB63D208,0x51464431,0xFB314446,0x7208D263,0x236F03C8,0xB8321D31},
+{0x33676269,0x13230E71,0xCD49DAAD,0x2066EF67,0xCD67EF66,0x13ADDA49,0x33710E23,0xB9696267},
+{0x039DE384,0xB0991953,0x9737C2C5,0xB306959D,0x979D9506,0xB0C5C237,0x03531999,0xBA84E39D},
+{0x13CB9CDF,0xD172144D,0xA11DCA60,0xC2263ECB,0xA1CB3E26,0xD160CA1D,0x134D1472,0xBBDF9CCB},
+{0x63EE66D9,0x716A3717,0x23CBF215,0x12C661EE,0x23EE61C6,0x7115F2CB,0x6317376A,0xBCD966EE},
+{0x73B81982,0x10813A09,0x15E1FAB0,0x63E6CAB8,0x15B8CAE6,0x10B0FAE1,0x73093A81,0xBD8219B8},
+{0x4342986F,0xB33B2D2B,0x4F9FE2D8,0xF086B042,0x4F42B086,0xB3D8E29F,0x432B2D3B,0xBE6F9842},
+{0x5314E734,0xD2D02035,0x79B5EA7D,0x81A61B14,0x79141BA6,0xD27DEAB5,0x533520D0,0xBF34E714},
+{0x38D17D03,0x500CD22D,0x416B1CF9,0x6870ECD1,0x41D1EC70,0x50F91C6B,0x382DD20C,0xC0037DD1},
+{0x28870258,0x31E7DF33,0x7741145C,0x19504787,0x77874750,0x315C1441,0x2833DFE7,0xC1580287},
+{0x187D83B5,0x925DC811,0x2D3F0C34,0x8A303D7D,0x2D7D3D30,0x92340C3F,0x1811C85D,0xC2B5837D},
+{0x082BFCEE,0xF3B6C50F,0x1B150491,0xFB10962B,0x1B2B9610,0xF3910415,0x080FC5B6,0xC3EEFC2B},
+{0x780E06E8,0x53AEE655,0x99C33CE4,0x2BF0C90E,0x990EC9F0,0x53E43CC3,0x7855E6AE,0xC4E8060E},
+{0x685879B3,0x3245EB4B,0xAFE93441,0x5AD06258,0xAF5862D0,0x324134E9,0x684BEB45,0xC5B37958},
+{0x58A2F85E,0x91FFFC69,0xF5972C29,0xC9B018A2,0xF5A218B0,0x91292C97,0x5869FCFF,0xC65EF8A2},
+{0x48F48705,0xF014F177,0xC3BD248C,0xB890B3F4,0xC3F4B390,0xF08C24BD,0x4877F114,0xC70587F4},
+{0xB8E88B52,0x56CFBADD,0x76BC5CC3,0xEEF7A6E8,0x76E8A6F7,0x56C35CBC,0xB8DDBACF,0xC8528BE8},
+{0xA8BEF409,0x3724B7C3,0x40965466,0x9FD70DBE,0x40BE0DD7,0x37665496,0xA8C3B724,0xC909F4BE},
+{0x984475E4,0x949EA0E1,0x1AE84C0E,0x0CB77744,0x1A4477B7,0x940E4CE8,0x98E1A09E,0xCAE47544},
+{0x88120ABF,0xF575ADFF,0x2CC244AB,0x7D97DC12,0x2C12DC97,0xF5AB44C2,0x88FFAD75,0xCBBF0A12},
+{0xF837F0B9,0x556D8EA5,0xAE147CDE,0xAD778337,0xAE378377,0x55DE7C14,0xF8A58E6D,0xCCB9F037},
+{0xE8618FE2,0x348683BB,0x983E747B,0xDC572861,0x98612857,0x347B743E,0xE8BB8386,0xCDE28F61},
+{0xD89B0E0F,0x973C9499,0xC2406C13,0x4F37529B,0xC29B5237,0x97136C40,0xD899943C,0xCE0F0E9B},
+{0xC8CD7154,0xF6D79987,0xF46A64B6,0x3E17F9CD,0xF4CDF917,0xF6B6646A,0xC88799D7,0xCF5471CD},
+{0xBFA316A1,0x5C0D024A,0x2F429C8D,0xE3F978A3,0x2FA378F9,0x5C8D9C42,0xBF4A020D,0xD0A116A3},
+{0xAFF569FA,0x3DE60F54,0x19689428,0x92D9D3F5,0x19F5D3D9,0x3D289468,0xAF540FE6,0xD1FA69F5},
+{0x9F0FE817,0x9E5C1876,0x43168C40,0x01B9A90F,0x430FA9B9,0x9E408C16,0x9F76185C,0xD217E80F},
+{0x8F59974C,0xFFB71568,0x753C84E5,0x70990259,0x75590299,0xFFE5843C,0x8F6815B7,0xD34C9759},
+{0xFF7C6D4A,0x5FAF3632,0xF7EABC90,0xA0795D7C,0xF77C5D79,0x5F90BCEA,0xFF3236AF,0xD44A6D7C},
+{0xEF2A1211,0x3E443B2C,0xC1C0B435,0xD159F62A,0xC12AF659,0x3E35B4C0,0xEF2C3B44,0xD511122A},
+{0xDFD093FC,0x9DFE2C0E,0x9BBEAC5D,0x42398CD0,0x9BD08C39,0x9D5DACBE,0xDF0E2CFE,0xD6FC93D0},
+{0xCF86ECA7,0xFC152110,0xAD94A4F8,0x33192786,0xAD862719,0xFCF8A494,0xCF102115,0xD7A7EC86},
+{0x3F9AE0F0,0x5ACE6ABA,0x1895DCB7,0x657E329A,0x189A327E,0x5AB7DC95,0x3FBA6ACE,0xD8F0E09A},
+{0x2FCC9FAB,0x3B2567A4,0x2EBFD412,0x145E99CC,0x2ECC995E,0x3B12D4BF,0x2FA46725,0xD9AB9FCC},
+{0x1F361E46,0x989F7086,0x74C1CC7A,0x873EE336,0x7436E33E,0x987ACCC1,0x1F86709F,0xDA461E36},
+{0x0F60611D,0xF9747D98,0x42EBC4DF,0xF61E4860,0x4260481E,0xF9DFC4EB,0x0F987D74,0xDB1D6160},
+{0x7F459B1B,0x596C5EC2,0xC03DFCAA,0x26FE1745,0xC04517FE,0x59AAFC3D,0x7FC25E6C,0xDC1B9B45},
+{0x6F13E440,0x388753DC,0xF617F40F,0x57DEBC13,0xF613BCDE,0x380FF417,0x6FDC5387,0xDD40E413},
+{0x5FE965AD,0x9B3D44FE,0xAC69EC67,0xC4BEC6E9,0xACE9C6BE,0x9B67EC69,0x5FFE443D,0xDEAD65E9},
+{0x4FBF1AF6,0xFAD649E0,0x9A43E4C2,0xB59E6DBF,0x9ABF6D9E,0xFAC2E443,0x4FE049D6,0xDFF61ABF},
+{0xB135ABC0,0x480EF5E3,0x9D399B11,0xF9E54335,0x9D3543E5,0x48119B39,0xB1E3F50E,0xE0C0AB35},
+{0xA163D49B,0x29E5F8FD,0xAB1393B4,0x88C5E863,0xAB63E8C5,0x29B49313,0xA1FDF8E5,0xE19BD463},
+{0x91995576,0x8A5FEFDF,0xF16D8BDC,0x1BA59299,0xF19992A5,0x8ADC8B6D,0x91DFEF5F,0xE2765599},
+{0x81CF2A2D,0xEBB4E2C1,0xC7478379,0x6A8539CF,0xC7CF3985,0xEB798347,0x81C1E2B4,0xE32D2ACF},
+{0xF1EAD02B,0x4BACC19B,0x4591BB0C,0xBA6566EA,0x45EA6665,0x4B0CBB91,0xF19BC1AC,0xE42BD0EA},
+{0xE1BCAF70,0x2A47CC85,0x73BBB3A9,0xCB45CDBC,0x73BCCD45,0x2AA9B3BB,0xE185CC47,0xE570AFBC},
+{0xD1462E9D,0x89FDDBA7,0x29C5ABC1,0x5825B746,0x2946B725,0x89C1ABC5,0xD1A7DBFD,0xE69D2E46},
+{0xC11051C6,0xE816D6B9,0x1FEFA364,0x29051C10,0x1F101C05,0xE864A3EF,0xC1B9D616,0xE7C65110},
+{0x310C5D91,0x4ECD9D13,0xAAEEDB2B,0x7F62090C,0xAA0C0962,0x4E2BDBEE,0x31139DCD,0xE8915D0C},
+{0x215A22CA,0x2F26900D,0x9CC4D38E,0x0E42A25A,0x9C5AA242,0x2F8ED3C4,0x210D9026,0xE9CA225A},
+{0x11A0A327,0x8C9C872F,0xC6BACBE6,0x9D22D8A0,0xC6A0D822,0x8CE6CBBA,0x112F879C,0xEA27A3A0},
+{0x01F6DC7C,0xED778A31,0xF090C343,0xEC0273F6,0xF0F67302,0xED43C390,0x01318A77,0xEB7CDCF6},
+{0x71D3267A,0x4D6FA96B,0x7246FB36,0x3CE22CD3,0x72D32CE2,0x4D36FB46,0x716BA96F,0xEC7A26D3},
+{0x61855921,0x2C84A475,0x446CF393,0x4DC28785,0x448587C2,0x2C93F36C,0x6175A484,0xED215985},
+{0x517FD8CC,0x8F3EB357,0x1E12EBFB,0xDEA2FD7F,0x1E7FFDA2,0x8FFBEB12,0x5157B33E,0xEECCD87F},
+{0x4129A797,0xEED5BE49,0x2838E35E,0xAF825629,0x28295682,0xEE5EE338,0x4149BED5,0xEF97A729},
+{0x3647C062,0x440F2584,0xF3101B65,0x726CD747,0xF347D76C,0x44651B10,0x3684250F,0xF062C047},
+{0x2611BF39,0x25E4289A,0xC53A13C0,0x034C7C11,0xC5117C4C,0x25C0133A,0x269A28E4,0xF139BF11},
+{0x16EB3ED4,0x865E3FB8,0x9F440BA8,0x902C06EB,0x9FEB062C,0x86A80B44,0x16B83F5E,0xF2D43EEB},
+{0x06BD418F,0xE7B532A6,0xA96E030D,0xE10CADBD,0xA9BDAD0C,0xE70D036E,0x06A632B5,0xF38F41BD},
+{0x7698BB89,0x47AD11FC,0x2BB83B78,0x31ECF298,0x2B98F2EC,0x47783BB8,0x76FC11AD,0xF489BB98},
+{0x66CEC4D2,0x26461CE2,0x1D9233DD,0x40CC59CE,0x1DCE59CC,0x26DD3392,0x66E21C46,0xF5D2C4CE},
+{0x5634453F,0x85FC0BC0,0x47EC2BB5,0xD3AC2334,0x473423AC,0x85B52BEC,0x56C00BFC,0xF63F4534},
+{0x46623A64,0xE41706DE,0x71C62310,0xA28C8862,0x7162888C,0xE41023C6,0x46DE0617,0xF7643A62},
+{0xB67E3633,0x42CC4D74,0xC4C75B5F,0xF4EB9D7E,0xC47E9DEB,0x425F5BC7,0xB6744DCC,0xF833367E},
+{0xA6284968,0x2327406A,0xF2ED53FA,0x85CB3628,0xF22836CB,0x23FA53ED,0xA66A4027,0xF9684928},
+{0x96D2C885,0x809D5748,0xA8934B92,0x16AB4CD2,0xA8D24CAB,0x80924B93,0x9648579D,0xFA85C8D2},
+{0x8684B7DE,0xE1765A56,0x9EB94337,0x678BE784,0x9E84E78B,0xE13743B9,0x86565A76,0xFBDEB784},
+{0xF6A14DD8,0x416E790C,0x1C6F7B42,0xB76BB8A1,0x1CA1B86B,0x41427B6F,0xF60C796E,0xFCD84DA1},
+{0xE6F73283,0x20857412,0x2A4573E7,0xC64B13F7,0x2AF7134B,0x20E77345,0xE6127485,0xFD8332F7},
+{0xD60DB36E,0x833F6330,0x703B6B8F,0x552B690D,0x700D692B,0x838F6B3B,0xD630633F,0xFE6EB30D},
+{0xC65BCC35,0xE2D46E2E,0x4611632A,0x240BC25B,0x465BC20B,0xE22A6311,0xC62E6ED4,0xFF35CC5B},
+};
+
+/* Table driven version, the parity register is shifted and updated a word
+ * (four symbols) at a time */
 void encode_rs_8(uint8_t *data, uint8_t *parity, int pad)
 {
-	int i, j;
-	uint8_t feedback;
-	
-	memset(parity, 0, NROOTS * sizeof(uint8_t));
+	uint32_t p[NROOTS / 4] = {0};
+	const uint32_t *g;
+	int i;
 	
 	for(i = 0; i < NN - NROOTS - pad; i++)
 	{
-		feedback = INDEX_OF[data[i] ^ parity[0]];
-		if(feedback != A0) /* feedback term is non-zero */
-		{
-			for(j = 1; j < NROOTS; j++)
-				parity[j] ^= ALPHA_TO[mod255(feedback + GENPOLY[NROOTS - j])];
-		}
-		
-		/* Shift */
-		memmove(&parity[0], &parity[1], sizeof(uint8_t) * (NROOTS - 1));
-		if(feedback != A0)
-			parity[NROOTS - 1] = ALPHA_TO[mod255(feedback + GENPOLY[0])];
-		else
-			parity[NROOTS - 1] = 0;
+		g = GENTAB[data[i] ^ (p[0] & 0xFF)];
+		p[0] = (p[0] >> 8 | p[1] << 24) ^ g[0];
+		p[1] = (p[1] >> 8 | p[2] << 24) ^ g[1];
+		p[2] = (p[2] >> 8 | p[3] << 24) ^ g[2];
+		p[3] = (p[3] >> 8 | p[4] << 24) ^ g[3];
+		p[4] = (p[4] >> 8 | p[5] << 24) ^ g[4];
+		p[5] = (p[5] >> 8 | p[6] << 24) ^ g[5];
+		p[6] = (p[6] >> 8 | p[7] << 24) ^ g[6];
+		p[7] = (p[7] >> 8) ^ g[7];
 	}
+	
+	for(i = 0; i < NROOTS; i++)
+		parity[i] = p[i / 4] >> (8 * (i % 4));
 }
 
-int decode_rs_8(uint8_t *data, int *eras_pos, int no_eras, int pad)
+/* Syndromes, s[i] is data(x) at the root i of g(x) in index form.
+ * Returns nonzero if any syndrome is nonzero. */
+static int syndromes_scalar(const uint8_t *data, uint8_t *s, int pad)
 {
-	int deg_lambda, el, deg_omega;
-	int i, j, r, k;
-	uint8_t u, q, tmp, num1, num2, den, discr_r;
-	uint8_t lambda[NROOTS + 1], s[NROOTS]; /* Err+Eras Locator poly
-	                                        * and syndrome poly */
-	uint8_t b[NROOTS + 1], t[NROOTS + 1], omega[NROOTS + 1];
-	uint8_t root[NROOTS], reg[NROOTS + 1], loc[NROOTS];
-	int syn_error, count;
-	
-	if(pad < 0 || pad > 222) return(-1);
-	
-	/* form the syndromes; i.e., evaluate data(x) at roots of g(x) */
+	int i, j, syn_error;
+
 	for(i = 0; i < NROOTS; i++) s[i] = data[0];
-	
+
 	for(j = 1; j < NN - pad; j++)
 	{
 		for(i = 0; i < NROOTS; i++)
@@ -123,7 +369,7 @@ int decode_rs_8(uint8_t *data, int *eras_pos, int no_eras, int pad)
 			else s[i] = data[j] ^ ALPHA_TO[MODNN(INDEX_OF[s[i]] + (FCR + i) * PRIM)];
 		}
 	}
-	
+
 	/* Convert syndromes to index form, checking for nonzero condition */
 	syn_error = 0;
 	for(i = 0; i < NROOTS; i++)
@@ -131,6 +377,372 @@ int decode_rs_8(uint8_t *data, int *eras_pos, int no_eras, int pad)
 		syn_error |= s[i];
 		s[i] = INDEX_OF[s[i]];
 	}
+
+	return(syn_error);
+}
+
+/* Chien search, finds the roots of lambda(x) (index form) in ascending
+ * order and their error locations. Returns the number of roots. */
+static int chien_scalar(const uint8_t *lambda, int deg_lambda, uint8_t *root, uint8_t *loc)
+{
+	uint8_t q, reg[NROOTS + 1];
+	int i, j, k, count;
+
+	memcpy(&reg[1], &lambda[1], NROOTS * sizeof(reg[0]));
+	count = 0; /* Number of roots of lambda(x) */
+	for(i = 1, k = IPRIM - 1; i <= NN; i++, k = MODNN(k + IPRIM))
+	{
+		q = 1; /* lambda[0] is always 0 */
+		for(j = deg_lambda; j > 0; j--)
+		{
+			if(reg[j] != A0)
+			{
+				reg[j] = MODNN(reg[j] + j);
+				q ^= ALPHA_TO[reg[j]];
+			}
+		}
+
+		if (q != 0) continue; /* Not a root */
+
+		/* store root (index-form) and error location number */
+		root[count] = i;
+		loc[count] = k;
+		/* If we've already found max possible roots,
+		 * abort the search to save time
+		 */
+		if(++count == deg_lambda) break;
+	}
+
+	return(count);
+}
+
+static int (*syndromes)(const uint8_t *data, uint8_t *s, int pad) = syndromes_scalar;
+static int (*chien)(const uint8_t *lambda, int deg_lambda, uint8_t *root, uint8_t *loc) = chien_scalar;
+static rs8_impl_t impl = RS8_SCALAR;
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+
+/* Vectorized syndromes and Chien search for x86 hosts (ground stations).
+ * Constant GF(256) multiplications are done with two 16 entry nibble
+ * tables and PSHUFB: x*c = LO_c[x & 15] ^ HI_c[x >> 4].
+ *
+ * Syndromes: The block is zero extended at the front to whole rows of 16
+ * symbols and each column is evaluated by Horner's rule with beta^16,
+ * beta being the root of the syndrome. The 16 columns are then folded with
+ * beta^8, beta^4, beta^2 and beta. AVX2 evaluates two syndromes at once,
+ * one per 128 bit lane.
+ *
+ * Chien search: lambda(x) is evaluated at 16 (32) points at once with a
+ * table of the powers alpha^(j*i), multiplied by the coefficients lambda[j].
+ */
+
+#define SYN_STEPS (5) /* beta^16, beta^8, beta^4, beta^2, beta */
+
+/* SYN_TAB[i/2][step][lo/hi][i%2]: nibble tables of the syndrome pairs */
+static uint8_t SYN_TAB[NROOTS / 2][SYN_STEPS][2][2][16] __attribute__((aligned(32)));
+
+/* CHIEN_POW[j][t] = alpha^(j*(t+1)) */
+static uint8_t CHIEN_POW[NROOTS + 1][256] __attribute__((aligned(32)));
+
+static uint8_t gf_mul(uint8_t a, uint8_t b)
+{
+	if(a == 0 || b == 0) return(0);
+	return(ALPHA_TO[MODNN(INDEX_OF[a] + INDEX_OF[b])]);
+}
+
+/* Nibble tables of the multiplication with c, lo[16] followed by hi[16] */
+static void mul_tab(uint8_t *tab, uint8_t c)
+{
+	int n;
+
+	for(n = 0; n < 16; n++)
+	{
+		tab[n] = gf_mul(n, c);
+		tab[16 + n] = gf_mul(n << 4, c);
+	}
+}
+
+__attribute__((target("ssse3")))
+static inline __m128i mul_ssse3(__m128i x, __m128i lo, __m128i hi)
+{
+	const __m128i mask = _mm_set1_epi8(0x0F);
+
+	lo = _mm_shuffle_epi8(lo, _mm_and_si128(x, mask));
+	hi = _mm_shuffle_epi8(hi, _mm_and_si128(_mm_srli_epi64(x, 4), mask));
+	return(_mm_xor_si128(lo, hi));
+}
+
+__attribute__((target("avx2")))
+static inline __m256i mul_avx2(__m256i x, __m256i lo, __m256i hi)
+{
+	const __m256i mask = _mm256_set1_epi8(0x0F);
+
+	lo = _mm256_shuffle_epi8(lo, _mm256_and_si256(x, mask));
+	hi = _mm256_shuffle_epi8(hi, _mm256_and_si256(_mm256_srli_epi64(x, 4), mask));
+	return(_mm256_xor_si256(lo, hi));
+}
+
+/* Copies the block behind zeros, so it ends with a whole row. Returns the
+ * number of rows. */
+static int syndrome_rows(uint8_t *buf, const uint8_t *data, int pad)
+{
+	int n = NN - pad;
+	int rows = (n + 15) / 16;
+
+	memset(buf, 0, 16);
+	memcpy(&buf[rows * 16 - n], data, n);
+	return(rows);
+}
+
+__attribute__((target("ssse3")))
+static int syndromes_ssse3(const uint8_t *data, uint8_t *s, int pad)
+{
+	uint8_t buf[256] __attribute__((aligned(16)));
+	const __m128i *row = (const __m128i*)buf;
+	int i, r, step, rows, syn_error = 0;
+
+	rows = syndrome_rows(buf, data, pad);
+
+	for(i = 0; i < NROOTS; i++)
+	{
+		const uint8_t (*tab)[2][2][16] = SYN_TAB[i / 2];
+		__m128i lo = _mm_load_si128((const __m128i*)tab[0][0][i % 2]);
+		__m128i hi = _mm_load_si128((const __m128i*)tab[0][1][i % 2]);
+		__m128i acc = _mm_load_si128(&row[0]), mul;
+
+		for(r = 1; r < rows; r++)
+			acc = _mm_xor_si128(mul_ssse3(acc, lo, hi), _mm_load_si128(&row[r]));
+
+		for(step = 1; step < SYN_STEPS; step++)
+		{
+			lo = _mm_load_si128((const __m128i*)tab[step][0][i % 2]);
+			hi = _mm_load_si128((const __m128i*)tab[step][1][i % 2]);
+			mul = mul_ssse3(acc, lo, hi);
+			switch(step)
+			{
+			case 1: acc = _mm_xor_si128(mul, _mm_srli_si128(acc, 8)); break;
+			case 2: acc = _mm_xor_si128(mul, _mm_srli_si128(acc, 4)); break;
+			case 3: acc = _mm_xor_si128(mul, _mm_srli_si128(acc, 2)); break;
+			default: acc = _mm_xor_si128(mul, _mm_srli_si128(acc, 1)); break;
+			}
+		}
+
+		s[i] = _mm_cvtsi128_si32(acc);
+		syn_error |= s[i];
+		s[i] = INDEX_OF[s[i]];
+	}
+
+	return(syn_error);
+}
+
+__attribute__((target("avx2")))
+static int syndromes_avx2(const uint8_t *data, uint8_t *s, int pad)
+{
+	uint8_t buf[256] __attribute__((aligned(16)));
+	const __m128i *row = (const __m128i*)buf;
+	int i, r, step, rows, syn_error = 0;
+
+	rows = syndrome_rows(buf, data, pad);
+
+	for(i = 0; i < NROOTS; i += 2)
+	{
+		const uint8_t (*tab)[2][2][16] = SYN_TAB[i / 2];
+		__m256i lo = _mm256_load_si256((const __m256i*)tab[0][0]);
+		__m256i hi = _mm256_load_si256((const __m256i*)tab[0][1]);
+		__m256i acc = _mm256_broadcastsi128_si256(_mm_load_si128(&row[0])), mul;
+
+		for(r = 1; r < rows; r++)
+			acc = _mm256_xor_si256(mul_avx2(acc, lo, hi), _mm256_broadcastsi128_si256(_mm_load_si128(&row[r])));
+
+		for(step = 1; step < SYN_STEPS; step++)
+		{
+			lo = _mm256_load_si256((const __m256i*)tab[step][0]);
+			hi = _mm256_load_si256((const __m256i*)tab[step][1]);
+			mul = mul_avx2(acc, lo, hi);
+			switch(step)
+			{
+			case 1: acc = _mm256_xor_si256(mul, _mm256_srli_si256(acc, 8)); break;
+			case 2: acc = _mm256_xor_si256(mul, _mm256_srli_si256(acc, 4)); break;
+			case 3: acc = _mm256_xor_si256(mul, _mm256_srli_si256(acc, 2)); break;
+			default: acc = _mm256_xor_si256(mul, _mm256_srli_si256(acc, 1)); break;
+			}
+		}
+
+		s[i] = _mm256_extract_epi8(acc, 0);
+		s[i + 1] = _mm256_extract_epi8(acc, 16);
+		syn_error |= s[i] | s[i + 1];
+		s[i] = INDEX_OF[s[i]];
+		s[i + 1] = INDEX_OF[s[i + 1]];
+	}
+
+	return(syn_error);
+}
+
+/* Nibble tables of the nonzero coefficients of lambda(x), returns their
+ * number, the powers they belong to in pow[] */
+static int chien_tabs(const uint8_t *lambda, int deg_lambda, uint8_t (*tab)[32], int *pow)
+{
+	int j, n = 0;
+
+	for(j = 1; j <= deg_lambda; j++)
+	{
+		if(lambda[j] == A0) continue;
+		mul_tab(tab[n], ALPHA_TO[lambda[j]]);
+		pow[n++] = j;
+	}
+
+	return(n);
+}
+
+/* Stores the roots of a block of points (bit t of mask: point t + first) */
+static int chien_roots(uint32_t mask, int first, int deg_lambda, uint8_t *root, uint8_t *loc, int count)
+{
+	int i;
+
+	while(mask)
+	{
+		i = first + __builtin_ctz(mask) + 1;
+		mask &= mask - 1;
+		if(i > NN) break;
+		root[count] = i;
+		loc[count] = MODNN(i * IPRIM - 1);
+		if(++count == deg_lambda) break;
+	}
+
+	return(count);
+}
+
+__attribute__((target("ssse3")))
+static int chien_ssse3(const uint8_t *lambda, int deg_lambda, uint8_t *root, uint8_t *loc)
+{
+	uint8_t tab[NROOTS][32] __attribute__((aligned(16)));
+	int pow[NROOTS];
+	int t, j, n, count = 0;
+
+	n = chien_tabs(lambda, deg_lambda, tab, pow);
+
+	for(t = 0; t < 256 && count < deg_lambda; t += 16)
+	{
+		__m128i q = _mm_set1_epi8(1); /* lambda[0] is always 0 */
+		for(j = 0; j < n; j++)
+		{
+			__m128i x = _mm_load_si128((const __m128i*)&CHIEN_POW[pow[j]][t]);
+			q = _mm_xor_si128(q, mul_ssse3(x, _mm_load_si128((const __m128i*)tab[j]), _mm_load_si128((const __m128i*)&tab[j][16])));
+		}
+		count = chien_roots(_mm_movemask_epi8(_mm_cmpeq_epi8(q, _mm_setzero_si128())), t, deg_lambda, root, loc, count);
+	}
+
+	return(count);
+}
+
+__attribute__((target("avx2")))
+static int chien_avx2(const uint8_t *lambda, int deg_lambda, uint8_t *root, uint8_t *loc)
+{
+	uint8_t tab[NROOTS][32] __attribute__((aligned(16)));
+	int pow[NROOTS];
+	int t, j, n, count = 0;
+
+	n = chien_tabs(lambda, deg_lambda, tab, pow);
+
+	for(t = 0; t < 256 && count < deg_lambda; t += 32)
+	{
+		__m256i q = _mm256_set1_epi8(1); /* lambda[0] is always 0 */
+		for(j = 0; j < n; j++)
+		{
+			__m256i x = _mm256_load_si256((const __m256i*)&CHIEN_POW[pow[j]][t]);
+			__m256i lo = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)tab[j]));
+			__m256i hi = _mm256_broadcastsi128_si256(_mm_load_si128((const __m128i*)&tab[j][16]));
+			q = _mm256_xor_si256(q, mul_avx2(x, lo, hi));
+		}
+		count = chien_roots(_mm256_movemask_epi8(_mm256_cmpeq_epi8(q, _mm256_setzero_si256())), t, deg_lambda, root, loc, count);
+	}
+
+	return(count);
+}
+
+/* Builds the tables and selects the best implementation the CPU supports */
+__attribute__((constructor))
+static void init_rs_8(void)
+{
+	int i, j, t, step;
+	uint8_t tab[32];
+
+	for(i = 0; i < NROOTS; i++)
+	{
+		for(step = 0; step < SYN_STEPS; step++)
+		{
+			/* beta^(16 >> step), beta = alpha^((FCR + i) * PRIM) */
+			mul_tab(tab, ALPHA_TO[MODNN((16 >> step) * MODNN((FCR + i) * PRIM))]);
+			memcpy(SYN_TAB[i / 2][step][0][i % 2], &tab[0], 16);
+			memcpy(SYN_TAB[i / 2][step][1][i % 2], &tab[16], 16);
+		}
+	}
+
+	for(j = 0; j <= NROOTS; j++)
+		for(t = 0; t < 256; t++)
+			CHIEN_POW[j][t] = ALPHA_TO[MODNN(j * MODNN(t + 1))];
+
+	__builtin_cpu_init();
+	if(select_rs_8(RS8_AVX2) != 0)
+		select_rs_8(RS8_SSSE3);
+}
+
+int select_rs_8(rs8_impl_t i)
+{
+	switch(i)
+	{
+	case RS8_SCALAR:
+		syndromes = syndromes_scalar;
+		chien = chien_scalar;
+		break;
+	case RS8_SSSE3:
+		if(!__builtin_cpu_supports("ssse3")) return(-1);
+		syndromes = syndromes_ssse3;
+		chien = chien_ssse3;
+		break;
+	case RS8_AVX2:
+		if(!__builtin_cpu_supports("avx2")) return(-1);
+		syndromes = syndromes_avx2;
+		chien = chien_avx2;
+		break;
+	default:
+		return(-1);
+	}
+
+	impl = i;
+	return(0);
+}
+
+#else
+
+int select_rs_8(rs8_impl_t i)
+{
+	return(i == RS8_SCALAR ? 0 : -1);
+}
+
+#endif
+
+rs8_impl_t get_rs_8(void)
+{
+	return(impl);
+}
+
+int decode_rs_8(uint8_t *data, int *eras_pos, int no_eras, int pad)
+{
+	int deg_lambda, el, deg_omega;
+	int i, j, r;
+	uint8_t u, tmp, num1, num2, den, discr_r;
+	uint8_t lambda[NROOTS + 1], s[NROOTS]; /* Err+Eras Locator poly
+	                                        * and syndrome poly */
+	uint8_t b[NROOTS + 1], t[NROOTS + 1], omega[NROOTS + 1];
+	uint8_t root[NROOTS], loc[NROOTS];
+	int syn_error, count;
+	
+	if(pad < 0 || pad > 222) return(-1);
+	
+	/* form the syndromes; i.e., evaluate data(x) at roots of g(x) */
+	syn_error = syndromes(data, s, pad);
 	
 	if(!syn_error)
 	{
@@ -229,30 +841,7 @@ int decode_rs_8(uint8_t *data, int *eras_pos, int no_eras, int pad)
 	}
 	
 	/* Find roots of the error+erasure locator polynomial by Chien search */
-	memcpy(&reg[1], &lambda[1], NROOTS * sizeof(reg[0]));
-	count = 0; /* Number of roots of lambda(x) */
-	for(i = 1, k = IPRIM - 1; i <= NN; i++, k = MODNN(k + IPRIM))
-	{
-		q = 1; /* lambda[0] is always 0 */
-		for(j = deg_lambda; j > 0; j--)
-		{
-			if(reg[j] != A0)
-			{
-				reg[j] = MODNN(reg[j] + j);
-				q ^= ALPHA_TO[reg[j]];
-			}
-		}
-		
-		if (q != 0) continue; /* Not a root */
-		
-		/* store root (index-form) and error location number */
-		root[count] = i;
-		loc[count] = k;
-		/* If we've already found max possible roots,
-		 * abort the search to save time
-		 */
-		if(++count == deg_lambda) break;
-	}
+	count = chien(lambda, deg_lambda, root, loc);
 	
 	if(deg_lambda != count)
 	{
@@ -13,8 +13,18 @@ extern "C" {
 
 #include <stdint.h>
 
+/* Decoder implementations, the best one the CPU supports is selected at
+ * startup (x86 hosts, scalar elsewhere) */
+typedef enum {
+	RS8_SCALAR,
+	RS8_SSSE3,
+	RS8_AVX2
+} rs8_impl_t;
+
 extern void encode_rs_8(uint8_t *data, uint8_t *parity, int pad);
 extern int decode_rs_8(uint8_t *data, int *eras_pos, int no_eras, int pad);
+extern int select_rs_8(rs8_impl_t impl);
+extern rs8_impl_t get_rs_8(void);
 
 #ifdef __cplusplus
 }
@@ -21,6 +21,7 @@
 #include <string.h>
 #include "ssdv.h"
 #include "rs8.h"
+#include "crc32.h"
 #include "debug.h"
 
 /* Recognised JPEG markers */
@@ -104,10 +105,97 @@ static const uint8_t std_dht11[179] = {
 0xF8,0xF9,0xFA,
 };
 
+/* Huffman codes of the standard tables by symbol: width << 16 | code, 0 if
+ * the symbol has no code. The output tables are always the standard ones. */
+static const uint32_t STD_HUFF_DC[2][16] = {
+{
+0x020000,0x030002,0x030003,0x030004,0x030005,0x030006,0x04000E,0x05001E,
+0x06003E,0x07007E,0x0800FE,0x0901FE,0x000000,0x000000,0x000000,0x000000,
+},
+{
+0x020000,0x020001,0x020002,0x030006,0x04000E,0x05001E,0x06003E,0x07007E,
+0x0800FE,0x0901FE,0x0A03FE,0x0B07FE,0x000000,0x000000,0x000000,0x000000,
+},
+};
+
+static const uint32_t STD_HUFF_AC[2][256] = {
+{
+0x04000A,0x020000,0x020001,0x030004,0x04000B,0x05001A,0x070078,0x0800F8,
+0x0A03F6,0x10FF82,0x10FF83,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x04000C,0x05001B,0x070079,0x0901F6,0x0B07F6,0x10FF84,0x10FF85,
+0x10FF86,0x10FF87,0x10FF88,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x05001C,0x0800F9,0x0A03F7,0x0C0FF4,0x10FF89,0x10FF8A,0x10FF8B,
+0x10FF8C,0x10FF8D,0x10FF8E,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x06003A,0x0901F7,0x0C0FF5,0x10FF8F,0x10FF90,0x10FF91,0x10FF92,
+0x10FF93,0x10FF94,0x10FF95,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x06003B,0x0A03F8,0x10FF96,0x10FF97,0x10FF98,0x10FF99,0x10FF9A,
+0x10FF9B,0x10FF9C,0x10FF9D,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x07007A,0x0B07F7,0x10FF9E,0x10FF9F,0x10FFA0,0x10FFA1,0x10FFA2,
+0x10FFA3,0x10FFA4,0x10FFA5,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x07007B,0x0C0FF6,0x10FFA6,0x10FFA7,0x10FFA8,0x10FFA9,0x10FFAA,
+0x10FFAB,0x10FFAC,0x10FFAD,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0800FA,0x0C0FF7,0x10FFAE,0x10FFAF,0x10FFB0,0x10FFB1,0x10FFB2,
+0x10FFB3,0x10FFB4,0x10FFB5,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0901F8,0x0F7FC0,0x10FFB6,0x10FFB7,0x10FFB8,0x10FFB9,0x10FFBA,
+0x10FFBB,0x10FFBC,0x10FFBD,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0901F9,0x10FFBE,0x10FFBF,0x10FFC0,0x10FFC1,0x10FFC2,0x10FFC3,
+0x10FFC4,0x10FFC5,0x10FFC6,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0901FA,0x10FFC7,0x10FFC8,0x10FFC9,0x10FFCA,0x10FFCB,0x10FFCC,
+0x10FFCD,0x10FFCE,0x10FFCF,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0A03F9,0x10FFD0,0x10FFD1,0x10FFD2,0x10FFD3,0x10FFD4,0x10FFD5,
+0x10FFD6,0x10FFD7,0x10FFD8,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0A03FA,0x10FFD9,0x10FFDA,0x10FFDB,0x10FFDC,0x10FFDD,0x10FFDE,
+0x10FFDF,0x10FFE0,0x10FFE1,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0B07F8,0x10FFE2,0x10FFE3,0x10FFE4,0x10FFE5,0x10FFE6,0x10FFE7,
+0x10FFE8,0x10FFE9,0x10FFEA,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x10FFEB,0x10FFEC,0x10FFED,0x10FFEE,0x10FFEF,0x10FFF0,0x10FFF1,
+0x10FFF2,0x10FFF3,0x10FFF4,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x0B07F9,0x10FFF5,0x10FFF6,0x10FFF7,0x10FFF8,0x10FFF9,0x10FFFA,0x10FFFB,
+0x10FFFC,0x10FFFD,0x10FFFE,0x000000,0x000000,0x000000,0x000000,0x000000,
+},
+{
+0x020000,0x020001,0x030004,0x04000A,0x050018,0x050019,0x060038,0x070078,
+0x0901F4,0x0A03F6,0x0C0FF4,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x04000B,0x060039,0x0800F6,0x0901F5,0x0B07F6,0x0C0FF5,0x10FF88,
+0x10FF89,0x10FF8A,0x10FF8B,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x05001A,0x0800F7,0x0A03F7,0x0C0FF6,0x0F7FC2,0x10FF8C,0x10FF8D,
+0x10FF8E,0x10FF8F,0x10FF90,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x05001B,0x0800F8,0x0A03F8,0x0C0FF7,0x10FF91,0x10FF92,0x10FF93,
+0x10FF94,0x10FF95,0x10FF96,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x06003A,0x0901F6,0x10FF97,0x10FF98,0x10FF99,0x10FF9A,0x10FF9B,
+0x10FF9C,0x10FF9D,0x10FF9E,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x06003B,0x0A03F9,0x10FF9F,0x10FFA0,0x10FFA1,0x10FFA2,0x10FFA3,
+0x10FFA4,0x10FFA5,0x10FFA6,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x070079,0x0B07F7,0x10FFA7,0x10FFA8,0x10FFA9,0x10FFAA,0x10FFAB,
+0x10FFAC,0x10FFAD,0x10FFAE,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x07007A,0x0B07F8,0x10FFAF,0x10FFB0,0x10FFB1,0x10FFB2,0x10FFB3,
+0x10FFB4,0x10FFB5,0x10FFB6,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0800F9,0x10FFB7,0x10FFB8,0x10FFB9,0x10FFBA,0x10FFBB,0x10FFBC,
+0x10FFBD,0x10FFBE,0x10FFBF,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0901F7,0x10FFC0,0x10FFC1,0x10FFC2,0x10FFC3,0x10FFC4,0x10FFC5,
+0x10FFC6,0x10FFC7,0x10FFC8,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0901F8,0x10FFC9,0x10FFCA,0x10FFCB,0x10FFCC,0x10FFCD,0x10FFCE,
+0x10FFCF,0x10FFD0,0x10FFD1,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0901F9,0x10FFD2,0x10FFD3,0x10FFD4,0x10FFD5,0x10FFD6,0x10FFD7,
+0x10FFD8,0x10FFD9,0x10FFDA,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0901FA,0x10FFDB,0x10FFDC,0x10FFDD,0x10FFDE,0x10FFDF,0x10FFE0,
+0x10FFE1,0x10FFE2,0x10FFE3,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0B07F9,0x10FFE4,0x10FFE5,0x10FFE6,0x10FFE7,0x10FFE8,0x10FFE9,
+0x10FFEA,0x10FFEB,0x10FFEC,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x000000,0x0E3FE0,0x10FFED,0x10FFEE,0x10FFEF,0x10FFF0,0x10FFF1,0x10FFF2,
+0x10FFF3,0x10FFF4,0x10FFF5,0x000000,0x000000,0x000000,0x000000,0x000000,
+0x0A03FA,0x0F7FC3,0x10FFF6,0x10FFF7,0x10FFF8,0x10FFF9,0x10FFFA,0x10FFFB,
+0x10FFFC,0x10FFFD,0x10FFFE,0x000000,0x000000,0x000000,0x000000,0x000000,
+},
+};
+
 /* Helper for returning the current DHT table */
 #define SDHT (s->sdht[s->acpart ? 1 : 0][s->component ? 1 : 0])
 #define DDHT (s->ddht[s->acpart ? 1 : 0][s->component ? 1 : 0])
 
+/* Helper for returning the current Huffman decoding table */
+#define HUFF(x) (s->x[s->acpart ? 1 : 0][s->component ? 1 : 0])
+
 /* Helpers for looking up the current DQT value */
 #define SDQT (s->sdqt[s->component ? 1 : 0][1 + s->acpart])
 #define DDQT (s->ddqt[s->component ? 1 : 0][1 + s->acpart])
@@ -154,25 +242,6 @@ static void *dtblcpy(ssdv_t *s, const void *src, size_t n)
 	return(r);
 }
 
-static uint32_t crc32(void *data, size_t length)
-{
-	uint32_t crc, x;
-	uint8_t i, *d;
-	
-	for(d = data, crc = 0xFFFFFFFF; length; length--)
-	{
-		x = (crc ^ *(d++)) & 0xFF;
-		for(i = 8; i > 0; i--)
-		{
-			if(x & 1) x = (x >> 1) ^ 0xEDB88320;
-			else x >>= 1;
-		}
-		crc = (crc >> 8) ^ x;
-	}
-	
-	return(crc ^ 0xFFFFFFFF);
-}
-
 static uint32_t encode_callsign(char *callsign)
 {
 	uint32_t x;
@@ -217,17 +286,74 @@ static char *decode_callsign(char *callsign, uint32_t code)
 	return(callsign);
 }
 
+/* Builds the decoding table of a source DHT table: Each entry of a code
+ * up to HUFF_BITS wide is the code followed by all combinations of the
+ * remaining bits. Shorter codes win, like in the search of the DHT table. */
+static void jpeg_dht_build(ssdv_t *s, int ac, int component)
+{
+	uint16_t code = 0, idx = 0, i, end;
+	uint8_t cw, n;
+	uint8_t *dht = s->sdht[ac][component];
+	uint16_t *huff = s->shuff[ac][component];
+	
+	memset(huff, 0, sizeof(s->shuff[0][0]));
+	
+	for(cw = 1; cw <= HUFF_BITS; cw++)
+	{
+		for(n = dht[cw]; n > 0; n--, idx++, code++)
+		{
+			/* Codes overflowing their width never match */
+			if(code >= 1 << cw) continue;
+			
+			end = (code + 1) << (HUFF_BITS - cw);
+			for(i = code << (HUFF_BITS - cw); i < end; i++)
+				if(!huff[i]) huff[i] = cw << 8 | dht[17 + idx];
+		}
+		
+		code <<= 1;
+	}
+	
+	s->shuff_code[ac][component] = code;
+	s->shuff_idx[ac][component] = idx;
+}
+
+static void jpeg_dht_build_all(ssdv_t *s)
+{
+	int ac, component;
+	
+	for(ac = 0; ac < 2; ac++)
+		for(component = 0; component < 2; component++)
+			if(s->sdht[ac][component]) jpeg_dht_build(s, ac, component);
+}
+
 static inline char jpeg_dht_lookup(ssdv_t *s, uint8_t *symbol, uint8_t *width)
 {
-	uint16_t code = 0;
+	uint16_t code, e;
 	uint8_t cw, n;
 	uint8_t *dht, *ss;
 	
-	/* Select the appropriate huffman table */
+	/* Look up the next HUFF_BITS bits (zero padded if there are less) */
+	if(s->worklen >= HUFF_BITS)
+		e = HUFF(shuff)[(s->workbits >> (s->worklen - HUFF_BITS)) & ((1 << HUFF_BITS) - 1)];
+	else
+		e = HUFF(shuff)[s->workbits << (HUFF_BITS - s->worklen)];
+	
+	if(e)
+	{
+		/* Got enough bits? */
+		if((e >> 8) > s->worklen) return(SSDV_FEED_ME);
+		
+		*symbol = e & 0xFF;
+		*width = e >> 8;
+		return(SSDV_OK);
+	}
+	
+	/* Not a code up to HUFF_BITS wide, search the wider ones */
 	dht = SDHT;
-	ss = &dht[17];
+	ss = &dht[17 + HUFF(shuff_idx)];
+	code = HUFF(shuff_code);
 	
-	for(cw = 1; cw <= 16; cw++)
+	for(cw = HUFF_BITS + 1; cw <= 16; cw++)
 	{
 		/* Got enough bits? */
 		if(cw > s->worklen) return(SSDV_FEED_ME);
@@ -254,32 +380,17 @@ static inline char jpeg_dht_lookup(ssdv_t *s, uint8_t *symbol, uint8_t *width)
 
 static inline char jpeg_dht_lookup_symbol(ssdv_t *s, uint8_t symbol, uint16_t *bits, uint8_t *width)
 {
-	uint16_t code = 0;
-	uint8_t cw, n;
-	uint8_t *dht, *ss;
+	uint32_t c;
 	
-	dht = DDHT;
-	ss = &dht[17];
-	
-	for(cw = 1; cw <= 16; cw++)
-	{
-		for(n = dht[cw]; n > 0; n--)
-		{
-			if(*ss == symbol)
-			{
-				/* Found a match */
-				*bits = code;
-				*width = cw;
-				return(SSDV_OK);
-			}
-			ss++; code++;
-		}
-		
-		code <<= 1;
-	}
+	if(s->acpart) c = STD_HUFF_AC[s->component ? 1 : 0][symbol];
+	else c = symbol < 16 ? STD_HUFF_DC[s->component ? 1 : 0][symbol] : 0;
 	
 	/* No match found - error */
-	return(SSDV_ERROR);
+	if(!c) return(SSDV_ERROR);
+	
+	*bits = c & 0xFFFF;
+	*width = c >> 16;
+	return(SSDV_OK);
 }
 
 static inline int jpeg_int(int bits, int width)
@@ -303,15 +414,28 @@ static inline void jpeg_encode_int(int value, int *bits, uint8_t *width)
 
 /*****************************************************************************/
 
-static char ssdv_outbits(ssdv_t *s, uint16_t bits, uint8_t length)
+/* Tests a word for 0xFF bytes */
+#define HAS_FF(w) (((~(w)) - 0x01010101) & (w) & 0x80808080)
+
+/* Writes the whole bytes of the output bit buffer, a word at a time while
+ * no stuffing byte is needed */
+static void ssdv_outbits_flush(ssdv_t *s)
 {
+	uint32_t w;
 	uint8_t b;
 	
-	if(length)
+	while(s->outlen >= 32 && s->out_len >= 4)
 	{
-		s->outbits <<= length;
-		s->outbits |= bits & ((1 << length) - 1);
-		s->outlen += length;
+		w = s->outbits >> (s->outlen - 32);
+		if(s->out_stuff && HAS_FF(w)) break;
+		
+		s->outp[0] = w >> 24;
+		s->outp[1] = w >> 16;
+		s->outp[2] = w >> 8;
+		s->outp[3] = w;
+		s->outp += 4;
+		s->outlen -= 32;
+		s->out_len -= 4;
 	}
 	
 	while(s->outlen >= 8 && s->out_len > 0)
@@ -326,19 +450,44 @@ static char ssdv_outbits(ssdv_t *s, uint16_t bits, uint8_t length)
 		/* Insert stuffing byte if needed */
 		if(s->out_stuff && b == 0xFF)
 		{
-			s->outbits &= (1 << s->outlen) - 1;
+			s->outbits &= ((uint64_t) 1 << s->outlen) - 1;
 			s->outlen += 8;
 		}
 	}
+}
+
+/* Adds bits to the output bit buffer, which is written out once it holds
+ * a word. A length of 0 writes out all whole bytes. */
+static char ssdv_outbits(ssdv_t *s, uint16_t bits, uint8_t length)
+{
+	if(length)
+	{
+		s->outbits <<= length;
+		s->outbits |= bits & ((1 << length) - 1);
+		s->outlen += length;
+		
+		if(s->outlen < 32) return(SSDV_OK);
+	}
+	
+	ssdv_outbits_flush(s);
 	
 	return(s->out_len ? SSDV_OK : SSDV_BUFFER_FULL);
 }
 
+/* Pads to a whole byte and writes out the output bit buffer */
 static char ssdv_outbits_sync(ssdv_t *s)
 {
 	uint8_t b = s->outlen % 8;
-	if(b) return(ssdv_outbits(s, 0xFF, 8 - b));
-	return(SSDV_OK);
+	if(b) ssdv_outbits(s, 0xFF, 8 - b);
+	return(ssdv_outbits(s, 0, 0));
+}
+
+/* Tests if the output buffer is full. The bits are written out only if
+ * they might fill it (with stuffing bytes a byte takes up to two). */
+static inline char ssdv_out_full(ssdv_t *s)
+{
+	if((s->outlen / 8) * 2 < s->out_len) return(0);
+	return(ssdv_outbits(s, 0, 0) == SSDV_BUFFER_FULL);
 }
 
 static char ssdv_out_jpeg_int(ssdv_t *s, uint8_t rle, int value)
@@ -423,7 +572,7 @@ static char ssdv_process(ssdv_t *s)
 		
 		/* Clear processed bits */
 		s->worklen -= width;
-		s->workbits &= (1 << s->worklen) - 1;
+		s->workbits &= ((uint64_t) 1 << s->worklen) - 1;
 	}
 	else if(s->state == S_INT)
 	{
@@ -505,7 +654,7 @@ static char ssdv_process(ssdv_t *s)
 		
 		/* Clear processed bits */
 		s->worklen -= s->needbits;
-		s->workbits &= (1 << s->worklen) - 1;
+		s->workbits &= ((uint64_t) 1 << s->worklen) - 1;
 	}
 	
 	if(s->acpart >= 64)
@@ -535,8 +684,13 @@ static char ssdv_process(ssdv_t *s)
 				s->packet_mcu_offset = s->pkt_size_payload - s->out_len;
 			}
 			
+			/* Drop the rest of the current byte, later bytes may be in
+			 * the work area already */
 			if(s->mode == S_DECODING && s->mcu_id == s->reset_mcu)
-				s->workbits = s->worklen = 0;
+			{
+				s->worklen -= s->worklen % 8;
+				s->workbits &= ((uint64_t) 1 << s->worklen) - 1;
+			}
 			
 			/* Test for a reset marker */
 			if(s->dri > 0 && s->mcu_id > 0 && s->mcu_id % s->dri == 0)
@@ -553,7 +707,7 @@ static char ssdv_process(ssdv_t *s)
 		s->accrle = 0;
 	}
 	
-	if(s->out_len == 0) return(SSDV_BUFFER_FULL);
+	if(ssdv_out_full(s)) return(SSDV_BUFFER_FULL);
 	
 	return(SSDV_OK);
 }
@@ -791,10 +945,10 @@ static char ssdv_have_marker_data(ssdv_t *s)
 			
 			switch(d[0])
 			{
-			case 0x00: s->sdht[0][0] = d; break;
-			case 0x01: s->sdht[0][1] = d; break;
-			case 0x10: s->sdht[1][0] = d; break;
-			case 0x11: s->sdht[1][1] = d; break;
+			case 0x00: s->sdht[0][0] = d; jpeg_dht_build(s, 0, 0); break;
+			case 0x01: s->sdht[0][1] = d; jpeg_dht_build(s, 0, 1); break;
+			case 0x10: s->sdht[1][0] = d; jpeg_dht_build(s, 1, 0); break;
+			case 0x11: s->sdht[1][1] = d; jpeg_dht_build(s, 1, 1); break;
 			}
 			
 			/* Skip to the next DHT table */
@@ -867,6 +1021,57 @@ char ssdv_enc_set_buffer(ssdv_t *s, uint8_t *buffer)
 	return(SSDV_OK);
 }
 
+/* Refills the work area from the JPEG input, a word at a time while it
+ * contains no 0xFF. The stuffing byte following a 0xFF is skipped. The
+ * work area isn't filled beyond a marker (or a 0xFF at the end of the
+ * input), its data is only taken if nothing else is left to process. */
+static void ssdv_refill(ssdv_t *s)
+{
+	uint32_t w;
+	uint8_t b, added = 0;
+	
+	while(s->worklen <= 48 && s->in_len > 0)
+	{
+		/* Skip bytes if necessary */
+		if(s->in_skip)
+		{
+			s->inp++;
+			s->in_len--;
+			s->in_skip--;
+			continue;
+		}
+		
+		if(s->worklen <= 32 && s->in_len >= 4)
+		{
+			w = ((uint32_t) s->inp[0] << 24) | (s->inp[1] << 16) | (s->inp[2] << 8) | s->inp[3];
+			if(!HAS_FF(w))
+			{
+				s->workbits = (s->workbits << 32) | w;
+				s->worklen += 32;
+				s->inp += 4;
+				s->in_len -= 4;
+				added = 1;
+				continue;
+			}
+		}
+		
+		b = *s->inp;
+		if(b == 0xFF)
+		{
+			if(added && (s->in_len < 2 || s->inp[1] != 0x00)) break;
+			
+			/* Skip the stuffing byte */
+			s->in_skip++;
+		}
+		
+		s->workbits = (s->workbits << 8) | b;
+		s->worklen += 8;
+		s->inp++;
+		s->in_len--;
+		added = 1;
+	}
+}
+
 char ssdv_enc_get_packet(ssdv_t *s)
 {
 	int r;
@@ -880,62 +1085,10 @@ char ssdv_enc_get_packet(ssdv_t *s)
 	
 	while(s->in_len)
 	{
-		b = *(s->inp++);
-		s->in_len--;
-		
-		/* Skip bytes if necessary */
-		if(s->in_skip) { s->in_skip--; continue; }
-		
-		switch(s->state)
+		if(s->state == S_HUFF || s->state == S_INT)
 		{
-		case S_MARKER:
-			s->marker = (s->marker << 8) | b;
-			
-			if(s->marker == J_TEM ||
-			   (s->marker >= J_RST0 && s->marker <= J_EOI))
-			{
-				/* Marker without data */
-				s->marker_len = 0;
-				r = ssdv_have_marker(s);
-				if(r != SSDV_OK) return(r);
-			}
-			else if(s->marker >= J_SOF0 && s->marker <= J_COM)
-			{
-				/* All other markers are followed by data */
-				s->marker_len = 0;
-				s->state = S_MARKER_LEN;
-				s->needbits = 16;
-			}
-			break;
-		
-		case S_MARKER_LEN:
-			s->marker_len = (s->marker_len << 8) | b;
-			if((s->needbits -= 8) == 0)
-			{
-				s->marker_len -= 2;
-				r = ssdv_have_marker(s);
-				if(r != SSDV_OK) return(r);
-			}
-			break;
-		
-		case S_MARKER_DATA:
-			s->marker_data[s->marker_data_len++] = b;
-			if(s->marker_data_len == s->marker_len)
-			{
-				r = ssdv_have_marker_data(s);
-				if(r != SSDV_OK) return(r);
-			}
-			break;
-		
-		case S_HUFF:
-		case S_INT:
-			/* Is the next byte a stuffing byte? Skip it */
-			/* TODO: Test the next byte is actually 0x00 */
-			if(b == 0xFF) s->in_skip++;
-			
-			/* Add the new byte to the work area */
-			s->workbits = (s->workbits << 8) | b;
-			s->worklen += 8;
+			/* Add the new bytes to the work area */
+			ssdv_refill(s);
 			
 			/* Process the new data until more needed, or an error occurs */
 			while((r = ssdv_process(s)) == SSDV_OK);
@@ -1008,8 +1161,58 @@ char ssdv_enc_get_packet(ssdv_t *s)
 				TRACE_ERROR("SSDV > ssdv_process() failed: %i", r);
 				return(SSDV_ERROR);
 			}
+			continue;
+		}
+		
+		b = *(s->inp++);
+		s->in_len--;
+		
+		/* Skip bytes if necessary */
+		if(s->in_skip) { s->in_skip--; continue; }
+		
+		switch(s->state)
+		{
+		case S_MARKER:
+			s->marker = (s->marker << 8) | b;
+			
+			if(s->marker == J_TEM ||
+			   (s->marker >= J_RST0 && s->marker <= J_EOI))
+			{
+				/* Marker without data */
+				s->marker_len = 0;
+				r = ssdv_have_marker(s);
+				if(r != SSDV_OK) return(r);
+			}
+			else if(s->marker >= J_SOF0 && s->marker <= J_COM)
+			{
+				/* All other markers are followed by data */
+				s->marker_len = 0;
+				s->state = S_MARKER_LEN;
+				s->needbits = 16;
+			}
 			break;
 		
+		case S_MARKER_LEN:
+			s->marker_len = (s->marker_len << 8) | b;
+			if((s->needbits -= 8) == 0)
+			{
+				s->marker_len -= 2;
+				r = ssdv_have_marker(s);
+				if(r != SSDV_OK) return(r);
+			}
+			break;
+		
+		case S_MARKER_DATA:
+			s->marker_data[s->marker_data_len++] = b;
+			if(s->marker_data_len == s->marker_len)
+			{
+				r = ssdv_have_marker_data(s);
+				if(r != SSDV_OK) return(r);
+			}
+			break;
+		
+		case S_HUFF:
+		case S_INT:
 		case S_EOI:
 			/* Shouldn't reach this point */
 			break;
@@ -1037,6 +1240,9 @@ static void ssdv_write_marker(ssdv_t *s, uint16_t id, uint16_t length, const uin
 		ssdv_outbits(s, length + 2, 16);
 		while(length--) ssdv_outbits(s, *(data++), 8);
 	}
+	
+	/* Write out the marker before stuffing is switched */
+	ssdv_outbits(s, 0, 0);
 }
 
 static void ssdv_out_headers(ssdv_t *s)
@@ -1140,6 +1346,9 @@ char ssdv_dec_init(ssdv_t *s)
 	s->ddht[1][0] = dtblcpy(s, std_dht10, sizeof(std_dht10));
 	s->ddht[1][1] = dtblcpy(s, std_dht11, sizeof(std_dht11));
 	
+	/* Build the Huffman decoding tables */
+	jpeg_dht_build_all(s);
+	
 	return(SSDV_OK);
 }
 
@@ -1160,7 +1369,7 @@ char ssdv_dec_set_buffer(ssdv_t *s, uint8_t *buffer, size_t length)
 char ssdv_dec_feed(ssdv_t *s, uint8_t *packet)
 {
 	int i = 0, r;
-	uint8_t b;
+	uint8_t *b;
 	uint16_t packet_id;
 	
 	/* Read the packet header */
@@ -1237,13 +1446,25 @@ char ssdv_dec_feed(ssdv_t *s, uint8_t *packet)
 	}
 	
 	/* Feed the JPEG data into the processor */
-	for(; i < s->pkt_size_payload; i++)
+	while(i < s->pkt_size_payload)
 	{
-		b = packet[SSDV_PKT_SIZE_HEADER + i];
-		
-		/* Add the new byte to the work area */
-		s->workbits = (s->workbits << 8) | b;
-		s->worklen += 8;
+		/* Add the new bytes to the work area, a word at a time */
+		while(s->worklen <= 48 && i < s->pkt_size_payload)
+		{
+			b = packet + SSDV_PKT_SIZE_HEADER + i;
+			if(s->worklen <= 32 && i + 4 <= s->pkt_size_payload)
+			{
+				s->workbits = (s->workbits << 32) | ((uint32_t) b[0] << 24) | (b[1] << 16) | (b[2] << 8) | b[3];
+				s->worklen += 32;
+				i += 4;
+			}
+			else
+			{
+				s->workbits = (s->workbits << 8) | b[0];
+				s->worklen += 8;
+				i++;
+			}
+		}
 		
 		/* Process the new data until more needed, or an error occurs */
 		while((r = ssdv_process(s)) == SSDV_OK);
@@ -39,6 +39,8 @@ extern "C" {
 
 #define TBL_LEN (546) /* Maximum size of the DQT and DHT tables */
 #define HBUFF_LEN (16) /* Extra space for reading marker data */
+#define HUFF_BITS (9) /* Code prefix bits of the Huffman decoding tables,
+                         RAM: 4 * 2^HUFF_BITS * 2 bytes */
 
 #define SSDV_MAX_CALLSIGN (6) /* Maximum number of characters in a callsign */
 
@@ -71,7 +73,7 @@ typedef struct
 	size_t in_skip;    /* Number of input bytes to skip                 */
 	
 	/* Source bits */
-	uint32_t workbits; /* Input bits currently being worked on          */
+	uint64_t workbits; /* Input bits currently being worked on          */
 	uint8_t worklen;   /* Number of bits in the input bit buffer        */
 	
 	/* JPEG / Packet output buffer */
@@ -81,7 +83,7 @@ typedef struct
 	char out_stuff;    /* Flag to add stuffing bytes to output          */
 	
 	/* Output bits */
-	uint32_t outbits;  /* Output bit buffer                             */
+	uint64_t outbits;  /* Output bit buffer                             */
 	uint8_t outlen;    /* Number of bits in the output bit buffer       */
 	
 	/* JPEG decoder state */
@@ -118,6 +120,12 @@ typedef struct
 	uint8_t *sdht[2][2], *sdqt[2];
 	uint16_t stbl_len;
 	
+	/* Huffman decoding tables: code prefix -> width << 8 | symbol, and
+	 * the first code wider than HUFF_BITS and its symbol index */
+	uint16_t shuff[2][2][1 << HUFF_BITS];
+	uint16_t shuff_code[2][2];
+	uint16_t shuff_idx[2][2];
+	
 	/* The same for output */
 	uint8_t dtbls[TBL_LEN];
 	uint8_t *ddht[2][2], *ddqt[2];
@@ -6,115 +6,123 @@
 #include "si4464.h"
 #include "geofence.h"
 #include "pi2c.h"
+#include "afsk.h"
 #include <string.h>
 
-#define PLAYBACK_RATE		129000									/* Samples per second (SYSCLK = 45MHz) */
-#define BAUD_RATE			1200									/* APRS AFSK baudrate */
-#define SAMPLES_PER_BAUD	(PLAYBACK_RATE / BAUD_RATE)				/* Samples per baud */
-#define PHASE_DELTA_1200	(((2 * 1200) << 16) / PLAYBACK_RATE)	/* Delta-phase per sample for 1200Hz tone */
-#define PHASE_DELTA_2200	(((2 * 2200) << 16) / PLAYBACK_RATE)	/* Delta-phase per sample for 2200Hz tone */
+#define AFSK_DMA_STREAM		STM32_DMA_STREAM_ID(2, 5)				/* TIM1_UP */
+#define AFSK_DMA_CHANNEL	6
+#define AFSK_DMA_PRIORITY	3
+#define AFSK_DMA_BITS		8										/* Bits per half buffer */
+#define AFSK_NO_END			0xFF
+
+#define FSK_TIM_CLOCK		STM32_TIMCLK1							/* TIM7 */
+#define FSK_IRQ_PRIORITY	2										/* Highest priority allowed to call the kernel */
+#define FSK_MAX_FRAME		11										/* Max. bits per character (start, 8 data, 2 stop) */
 
 mutex_t radio_mtx;                             // Radio mutex
 
+static guarded_memory_pool_t msg_pool;
+static semaphore_t image_sem;	// Limits the buffers taken by image messages
+static uint8_t msg_buffers[RADIO_MSG_BUFFERS][RADIO_MSG_BUFFER_SIZE] __attribute__((aligned(4)));
+
 void initAFSK(radio_t radio, radioMSG_t *msg) {
 	// Initialize radio and tune
 	Si4464_Init(radio, MOD_AFSK);
 	radioTune(radio, msg->freq, 0, msg->power, 0);
 }
 
-// Initialize variables for AFSK
-static uint32_t phase_delta = PHASE_DELTA_1200;	// 1200/2200 for standard AX.25
-static uint32_t phase = 0;						// Fixed point 9.7 (2PI = TABLE_SIZE)
-static uint32_t packet_pos = 0;					// Next bit to be sent out
-static uint32_t current_sample_in_baud = 0;		// 1 bit = SAMPLES_PER_BAUD samples
-static uint8_t current_byte = 0;
-static radioMSG_t *tim_msg;
-static radio_t tim_radio;
-static uint32_t gfsk_bit = 0;
-
-void sendAFSK(radio_t radio, radioMSG_t *msg) {
-	tim_msg = msg;
-	tim_radio = radio;
+// AFSK samples (BSRR words) played by DMA, TIM1 update requests one per sample
+static uint32_t afsk_buffer[2][AFSK_DMA_BITS * AFSK_SAMPLES_PER_BAUD];
+static afsk_t afsk;
+static uint8_t afsk_end;				// Half buffer containing the last sample
+static binary_semaphore_t afsk_done;
 
-	phase_delta = PHASE_DELTA_1200;
-	phase = 0;
-	packet_pos = 0;
-	current_sample_in_baud = 0;
-	current_byte = 0;
+// 2GFSK is sent from the Si4464 TX FIFO, GPIO0 signals FIFO almost empty
+static binary_semaphore_t fifo_sem;
+static void fifo_cb(EXTDriver *extp, expchannel_t channel);
+static const EXTConfig extcfg = {{
+	[PIN(RADIO2_GPIO0)] = {EXT_CH_MODE_RISING_EDGE | EXT_MODE_GPIOG, fifo_cb},
+	[PIN(RADIO1_GPIO0)] = {EXT_CH_MODE_RISING_EDGE | EXT_MODE_GPIOD, fifo_cb}
+}};
 
-	uint32_t initial_interval = 100; // in timer ticks
-	RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
-	nvicEnableVector(TIM7_IRQn, 1/*priority*/);
-	TIM7->ARR = initial_interval; /* Timer's period */
-	TIM7->PSC = 1;
-	TIM7->CR1 &= ~STM32_TIM_CR1_ARPE; /* ARR register is NOT buffered, allows to update timer's period on-fly. */
-	TIM7->DIER |= STM32_TIM_DIER_UIE; /* Interrupt enable */
-	TIM7->CR1 |= STM32_TIM_CR1_CEN; /* Counter enable */
-
-	// Block execution while timer is running
-	while(TIM7->CR1 & STM32_TIM_CR1_CEN)
-		chThdSleepMilliseconds(10);
+/**
+  * Fills a half buffer and remembers the half playing the last sample
+  */
+static void fillAFSK(uint8_t half) {
+	uint32_t n = afsk_fill(&afsk, afsk_buffer[half], AFSK_DMA_BITS);
+	if(n < AFSK_DMA_BITS && afsk_end == AFSK_NO_END)
+		afsk_end = n ? half : half ^ 1;
 }
 
-
 /**
-  * Fast interrupt handler for AFSK (1200baud) modulation. It has has the
-  * highest priority in order to provide an accurate low jitter modulation.
+  * DMA interrupt for AFSK, raised after each half of the buffer has been
+  * played (1200/AFSK_DMA_BITS times per second). Refills the played half or
+  * stops the timer after the last sample.
   */
-CH_FAST_IRQ_HANDLER(STM32_TIM7_HANDLER)
-{
-	if(tim_msg->mod == MOD_AFSK) {
-
-		if(packet_pos == tim_msg->bin_len) { // Packet transmission finished
-			TIM7->CR1 &= ~STM32_TIM_CR1_CEN;	// Disable timer
-			TIM7->SR &= ~STM32_TIM_SR_UIF;		// Reset interrupt flag
-			return;
-		}
-
-		if(current_sample_in_baud == 0) {
-			if((packet_pos & 7) == 0) { // Load up next byte
-				current_byte = tim_msg->msg[packet_pos >> 3];
-			} else { // Load up next bit
-				current_byte = current_byte / 2;
-			}
-		}
-
-		// Toggle tone (1200 <> 2200)
-		phase_delta = (current_byte & 1) ? PHASE_DELTA_1200 : PHASE_DELTA_2200;
-
-		phase += phase_delta;								// Add delta-phase (delta-phase tone dependent)
-		MOD_GPIO_SET(tim_radio, (phase >> 16) & 1);		// Set modulaton pin (connected to Si4464)
+static void afsk_dma_isr(void *p, uint32_t flags) {
+	(void)p;
 
-		current_sample_in_baud++;
+	uint8_t half = (flags & STM32_DMA_ISR_TCIF) ? 1 : 0;
+	if(!(flags & (STM32_DMA_ISR_HTIF | STM32_DMA_ISR_TCIF)))
+		return;
 
-		if(current_sample_in_baud == SAMPLES_PER_BAUD) {	// Old bit consumed, load next bit
-			//palTogglePad(PORT(LED_2YELLOW), PIN(LED_2YELLOW));
-			current_sample_in_baud = 0;
-			packet_pos++;
-		}
-
-	} else if(tim_msg->mod == MOD_2GFSK) {
-
-		if(gfsk_bit >= tim_msg->bin_len) { // Packet transmission finished
-			TIM7->CR1 &= ~STM32_TIM_CR1_CEN;	// Disable timer
-			TIM7->SR &= ~STM32_TIM_SR_UIF;		// Reset interrupt flag
-			return;
-		}
-
-		if((gfsk_bit & 7) == 0) { // Load up next byte
-			current_byte = tim_msg->msg[gfsk_bit >> 3];
-		} else {
-			current_byte = current_byte / 2; // Load next bit
-		}
-
-		MOD_GPIO_SET(tim_radio, current_byte & 0x1);
-		gfsk_bit++;
-
-		//palTogglePad(PORT(LED_2YELLOW), PIN(LED_2YELLOW));
+	if(half == afsk_end) { // Packet transmission finished
+		TIM1->CR1 &= ~STM32_TIM_CR1_CEN;
+		TIM1->DIER = 0;
+		dmaStreamDisable(STM32_DMA_STREAM(AFSK_DMA_STREAM));
 
+		chSysLockFromISR();
+		chBSemSignalI(&afsk_done);
+		chSysUnlockFromISR();
+		return;
 	}
 
-	TIM7->SR &= ~STM32_TIM_SR_UIF;						// Reset interrupt flag
+	fillAFSK(half);
+}
+
+/**
+  * Transmits the message by AFSK. The samples are precomputed into a double
+  * buffer and written to the modulation pin by DMA, so the CPU is idle
+  * during transmission except for refilling the buffer.
+  */
+void sendAFSK(radio_t radio, radioMSG_t *msg) {
+	ioportid_t port = radio == RADIO_2M ? PORT(RADIO1_GPIO0) : PORT(RADIO2_GPIO0);
+	uint32_t pad = radio == RADIO_2M ? PIN(RADIO1_GPIO0) : PIN(RADIO2_GPIO0);
+
+	// Precompute first samples
+	afsk_init(&afsk, msg->msg, msg->bin_len, 1 << pad, 1 << (pad + 16));
+	afsk_end = AFSK_NO_END;
+	fillAFSK(0);
+	fillAFSK(1);
+	chBSemObjectInit(&afsk_done, true);
+
+	// Circular DMA from buffer to port
+	const stm32_dma_stream_t *stream = STM32_DMA_STREAM(AFSK_DMA_STREAM);
+	dmaStreamAllocate(stream, AFSK_DMA_PRIORITY, afsk_dma_isr, NULL);
+	dmaStreamSetPeripheral(stream, &port->BSRR.W);
+	dmaStreamSetMemory0(stream, afsk_buffer);
+	dmaStreamSetTransactionSize(stream, sizeof(afsk_buffer) / sizeof(uint32_t));
+	dmaStreamSetMode(stream, STM32_DMA_CR_CHSEL(AFSK_DMA_CHANNEL) | STM32_DMA_CR_DIR_M2P |
+							 STM32_DMA_CR_MINC | STM32_DMA_CR_PSIZE_WORD |
+							 STM32_DMA_CR_MSIZE_WORD | STM32_DMA_CR_CIRC |
+							 STM32_DMA_CR_HTIE | STM32_DMA_CR_TCIE |
+							 STM32_DMA_CR_PL(3));
+	dmaStreamSetFIFO(stream, STM32_DMA_FCR_DMDIS);
+	dmaStreamEnable(stream);
+
+	// Sample clock (one DMA request per update)
+	RCC->APB2ENR |= RCC_APB2ENR_TIM1EN;
+	TIM1->CR1 = 0;
+	TIM1->PSC = 1;
+	TIM1->ARR = 100; // in timer ticks
+	TIM1->EGR = STM32_TIM_EGR_UG; /* Load prescaler */
+	TIM1->SR = 0;
+	TIM1->DIER = STM32_TIM_DIER_UDE; /* DMA request on update */
+	TIM1->CR1 = STM32_TIM_CR1_CEN; /* Counter enable */
+
+	// Block execution while DMA is running
+	chBSemWait(&afsk_done);
+	dmaStreamRelease(stream);
 }
 
 void initOOK(radio_t radio, radioMSG_t *msg) {
@@ -138,117 +146,182 @@ void sendOOK(radio_t radio, radioMSG_t *msg) {
 	}
 }
 
-// Transmit data (Software UART)
-static uint8_t txs;			// Serial maschine state
-static uint8_t txc;			// Current byte
-static uint32_t txi;		// Bitcounter of current byte
-static uint32_t txj;		// Bytecounter
-static radio_t fsk_radio;	// Current radio
-static radioMSG_t *fsk_msg;	// Current message
-static virtual_timer_t vt;
+// 2FSK UART frames (start bit, data bits, stop bits) sent bit by bit from TIM7
+static uint8_t fsk_bits[(RADIO_MSG_BUFFER_SIZE * FSK_MAX_FRAME + 7) / 8];
+static uint32_t fsk_len;		// Number of bits in fsk_bits
+static uint32_t fsk_bit;		// Next bit to be sent
+static radio_t fsk_radio;		// Current radio
+static binary_semaphore_t fsk_done;
 
-static void serial_cb(void *arg) {
-	(void)arg;
-
-	switch(txs)
-	{
-		case 6: // TX-delay
-			txj++;
-			if(txj > (uint32_t)(fsk_msg->fsk_config->predelay * fsk_msg->fsk_config->baud / 1000)) {
-				txj = 0;
-				txs = 7;
-			}
-			break;
+/**
+  * Precomputes the UART frames of the message into fsk_bits. Each character
+  * is sent as a start bit (space), the data bits LSB first and the stop bits
+  * (mark).
+  */
+static void encodeUART(radioMSG_t *msg) {
+	uint8_t bits = msg->fsk_config->bits;
+	uint8_t stopbits = msg->fsk_config->stopbits;
+	uint32_t frame = 1 + bits + stopbits;
+	uint32_t chars = msg->bin_len / 8;
+
+	if(chars * frame > sizeof(fsk_bits) * 8) {
+		TRACE_ERROR("RAD  > 2FSK message too long (%d chars), truncated", chars);
+		chars = sizeof(fsk_bits) * 8 / frame;
+	}
 
-		case 7: // Transmit a single char
-			if(txj < fsk_msg->bin_len/8) {
-				txc = fsk_msg->msg[txj]; // Select char
-				txj++;
-				MOD_GPIO_SET(fsk_radio, LOW); // Start Bit (Synchronizing)
-				txi = 0;
-				txs = 8;
-			} else {
-				txj = 0;
-				txs = 0; // Finished to transmit string
-				MOD_GPIO_SET(fsk_radio, HIGH);
-			}
-			break;
+	memset(fsk_bits, 0, sizeof(fsk_bits));
+	fsk_len = 0;
+	for(uint32_t i=0; i<chars; i++) {
+		uint32_t word = (((1 << stopbits) - 1) << (bits + 1)) | ((msg->msg[i] & ((1 << bits) - 1)) << 1);
+		for(uint32_t b=0; b<frame; b++, fsk_len++)
+			fsk_bits[fsk_len >> 3] |= ((word >> b) & 1) << (fsk_len & 7);
+	}
+}
 
-		case 8:
-			if(txi < fsk_msg->fsk_config->bits) {
-				txi++;
-				MOD_GPIO_SET(fsk_radio, txc & 1);
-				txc = txc >> 1;
-			} else {
-				MOD_GPIO_SET(fsk_radio, HIGH); // Stop Bit
-				txi = 0;
-				txs = 9;
-			}
-			break;
+/**
+  * Bit clock interrupt for 2FSK. Sends the next bit and signals the sending
+  * thread after the last stop bit.
+  */
+CH_IRQ_HANDLER(STM32_TIM7_HANDLER) {
+	CH_IRQ_PROLOGUE();
 
-		case 9:
-			if(fsk_msg->fsk_config->stopbits == 2)
-				MOD_GPIO_SET(fsk_radio, HIGH); // Stop Bit
-			txs = 7;
-	}
+	if(fsk_bit < fsk_len) {
+		MOD_GPIO_SET(fsk_radio, (fsk_bits[fsk_bit >> 3] >> (fsk_bit & 7)) & 1);
+		fsk_bit++;
+	} else { // Last bit sent
+		TIM7->CR1 &= ~STM32_TIM_CR1_CEN;
+		MOD_GPIO_SET(fsk_radio, HIGH);
 
-	// Reload timer
-	if(txs) {
 		chSysLockFromISR();
-		uint32_t delay = US2ST(1000000/fsk_msg->fsk_config->baud);
-		chVTSetI(&vt, delay, serial_cb, NULL);
+		chBSemSignalI(&fsk_done);
 		chSysUnlockFromISR();
 	}
+
+	TIM7->SR &= ~STM32_TIM_SR_UIF;
+	CH_IRQ_EPILOGUE();
 }
 
 void init2FSK(radio_t radio, radioMSG_t *msg) {
-	// Initialize virtual timer
-	chVTObjectInit(&vt);
-
 	// Initialize radio and tune
 	Si4464_Init(radio, MOD_2FSK);
 	MOD_GPIO_SET(radio, HIGH);
 	radioTune(radio, msg->freq, msg->fsk_config->shift, msg->power, 0);
 }
 
+/**
+  * Transmits the message by 2FSK (RTTY). The UART frames are precomputed,
+  * TIM7 clocks them out at the baudrate. The baudrate is derived from the
+  * timer clock (prescaler only used below 397 baud), so the bit period is
+  * accurate to a fraction of a microsecond.
+  */
 void send2FSK(radio_t radio, radioMSG_t *msg) {
-	// Prepare serial machine states
-	txs = 6;
-	txc = 0;
-	txi = 0;
-	txj = 0;
-	fsk_msg = msg;
+	encodeUART(msg);
 	fsk_radio = radio;
+	chBSemObjectInit(&fsk_done, true);
 
-	// Modulate
-	chVTSet(&vt, 1, serial_cb, NULL);	// Start timer
-	while(txs)
-		chThdSleepMilliseconds(1);		// Wait for routine to finish
-}
+	// Continuous carrier before the actual transmission
+	MOD_GPIO_SET(radio, HIGH);
+	chThdSleepMilliseconds(msg->fsk_config->predelay);
+	if(!fsk_len)
+		return;
 
-void send2GFSK(radio_t radio, radioMSG_t *msg) {
-	tim_msg = msg;
-	tim_radio = radio;
-	gfsk_bit = 0;
-	current_byte = 0;
+	// Bit clock
+	uint32_t ticks = (FSK_TIM_CLOCK + msg->fsk_config->baud / 2) / msg->fsk_config->baud;
+	uint32_t psc = (ticks - 1) >> 16;
+	RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
+	nvicEnableVector(TIM7_IRQn, FSK_IRQ_PRIORITY);
+	TIM7->CR1 = 0;
+	TIM7->PSC = psc;
+	TIM7->ARR = (ticks + (psc + 1) / 2) / (psc + 1) - 1;
+	TIM7->EGR = STM32_TIM_EGR_UG; /* Load prescaler */
+	TIM7->SR = 0;
+
+	// First bit sent now, the following ones on each update
+	MOD_GPIO_SET(radio, fsk_bits[0] & 1);
+	fsk_bit = 1;
+	TIM7->DIER = STM32_TIM_DIER_UIE; /* Interrupt enable */
+	TIM7->CR1 = STM32_TIM_CR1_CEN; /* Counter enable */
+
+	// Block execution until the last bit has been sent
+	chBSemWait(&fsk_done);
+	TIM7->DIER = 0;
+	nvicDisableVector(TIM7_IRQn);
+}
 
+void init2GFSK(radio_t radio, radioMSG_t *msg) {
 	// Initialize radio and tune
 	Si4464_Init(radio, MOD_2GFSK);
 	radioTune(radio, msg->freq, 0, msg->power, 0);
-	chThdSleepMilliseconds(30);
+}
 
-	uint32_t initial_interval = 1355; // in timer ticks
-	RCC->APB1ENR |= RCC_APB1ENR_TIM7EN;
-	nvicEnableVector(TIM7_IRQn, 1/*priority*/);
-	TIM7->ARR = initial_interval; /* Timer's period */
-	TIM7->PSC = 1;
-	TIM7->CR1 &= ~STM32_TIM_CR1_ARPE; /* ARR register is NOT buffered, allows to update timer's period on-fly. */
-	TIM7->DIER |= STM32_TIM_DIER_UIE; /* Interrupt enable */
-	TIM7->CR1 |= STM32_TIM_CR1_CEN; /* Counter enable */
-
-	// Block execution while timer is running
-	while(TIM7->CR1 & STM32_TIM_CR1_CEN)
-		chThdSleepMilliseconds(10);
+/**
+  * Interrupt on the rising edge of GPIO0 (TX FIFO almost empty)
+  */
+static void fifo_cb(EXTDriver *extp, expchannel_t channel) {
+	(void)extp;
+	(void)channel;
+
+	chSysLockFromISR();
+	chBSemSignalI(&fifo_sem);
+	chSysUnlockFromISR();
+}
+
+/**
+  * Transmits the message by 2GFSK. The packet handler of the Si4464 sends the
+  * bytes from its TX FIFO, which is refilled whenever it runs almost empty.
+  * The thread sleeps in between.
+  */
+void send2GFSK(radio_t radio, radioMSG_t *msg) {
+	uint32_t rate = msg->gfsk_config && msg->gfsk_config->speed ? msg->gfsk_config->speed : SI4464_2GFSK_RATE;
+	uint32_t len = (msg->bin_len + 7) / 8;
+	expchannel_t channel = radio == RADIO_2M ? PIN(RADIO1_GPIO0) : PIN(RADIO2_GPIO0);
+	systime_t refill = MS2ST(SI4464_FIFO_THRESHOLD * 8000 / rate + 1); // Time to send the threshold
+
+	setDataRate(radio, rate);
+
+	// Prefill FIFO (cleared first, an aborted packet may have left bytes in it)
+	uint32_t sent = len < SI4464_FIFO_SIZE ? len : SI4464_FIFO_SIZE;
+	Si4464_resetFIFO(radio);
+	Si4464_writeFIFO(radio, msg->msg, sent);
+
+	static bool ext_started;
+	if(!ext_started) {
+		extStart(&EXTD1, &extcfg);
+		ext_started = true;
+	}
+	chBSemObjectInit(&fifo_sem, true);
+	extChannelEnable(&EXTD1, channel);
+
+	systime_t start = chVTGetSystemTimeX();
+	systime_t end = start + MS2ST(len * 8000 / rate);
+	startTx(radio, len);
+
+	// Refill FIFO (polled as well in case an edge has been missed)
+	systime_t deadline = end + MS2ST(100);
+	while(sent < len) {
+		if(!chVTIsSystemTimeWithinX(start, deadline)) { // Chip stopped draining the FIFO
+			TRACE_ERROR("RAD  > 2GFSK FIFO refill timed out (%d of %d bytes sent)", sent, len);
+			extChannelDisable(&EXTD1, channel);
+			stopTx(radio);
+			return;
+		}
+		chBSemWaitTimeout(&fifo_sem, refill);
+		uint32_t n = Si4464_freeFIFO(radio);
+		if(n > len - sent)
+			n = len - sent;
+		if(n) {
+			Si4464_writeFIFO(radio, &msg->msg[sent], n);
+			sent += n;
+		}
+	}
+	extChannelDisable(&EXTD1, channel);
+
+	// Wait until the last byte has been sent and the radio returned to READY
+	if(chVTIsSystemTimeWithinX(start, end))
+		chThdSleepUntil(end);
+	systime_t timeout = chVTGetSystemTimeX() + MS2ST(100);
+	while(Si4464_getState(radio) == 7 && chVTIsSystemTimeWithinX(start, timeout))
+		chThdSleepMilliseconds(1);
 }
 
 /**
@@ -259,123 +332,373 @@ void send2GFSK(radio_t radio, radioMSG_t *msg) {
 uint32_t getAPRSRegionFrequency2m(void) {
 	trackPoint_t *point = getLastTrackPoint();
 
-	// Use this frequency for the rest of the world (unset regions, 144.800 MHz)
-	uint32_t freq = APRS_FREQ_OTHER;
-
 	// Position unknown
 	if(!point->gps_lat && !point->gps_lon)
-		freq = 0; // Use default frequency set in config file
-	
-	// America 144.390 MHz
-	if(isPointInAmerica(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_AMERICA;
+		return 0; // Use default frequency set in config file
+
+	region_t region = getLayerRegionCached(LAYER_APRS, point);
+
+	switch(region) {
+		case REGION_AMERICA:		return APRS_FREQ_AMERICA;		// America 144.390 MHz
+		case REGION_CHINA:			return APRS_FREQ_CHINA;			// China 144.640 MHz
+		case REGION_JAPAN:			return APRS_FREQ_JAPAN;			// Japan 144.660 MHz
+		case REGION_SOUTHKOREA:		return APRS_FREQ_SOUTHKOREA;	// Southkorea 144.620 MHz
+		case REGION_SOUTHEASTASIA:	return APRS_FREQ_SOUTHEASTASIA;	// Southeast Asia 144.390 MHz
+		case REGION_AUSTRALIA:		return APRS_FREQ_AUSTRALIA;		// Australia 145.175 MHz
+		case REGION_NEWZEALAND:		return APRS_FREQ_NEWZEALAND;	// New Zealand 144.525 MHz
+		case REGION_ARGENTINA:		return APRS_FREQ_ARGENTINA;		// Argentina/Paraguay/Uruguay 144.930 MHz
+		case REGION_BRAZIL:			return APRS_FREQ_BRAZIL;		// Brazil 145.575 MHz
+		default:					return APRS_FREQ_OTHER;			// Rest of the world 144.800 MHz
+	}
+}
+uint32_t getAPRSRegionFrequency70cm(void) {
+	return 432500000;
+}
+uint32_t getAPRSISSFrequency(void) {
+	return 145825000;
+}
 
-	// China 144.640 MHz
-	if(isPointInChina(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_CHINA;
+/**
+  * Transmit queue entry
+  */
+typedef struct {
+	radioMSG_t				msg;		// Copy of the message
+	binary_semaphore_t		*done;		// Signaled after transmission (external buffers only)
+	bool					*sent;		// Transmission result (external buffers only)
+} radioTX_t;
 
-	// Japan 144.660 MHz
-	if(isPointInJapan(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_JAPAN;
+static guarded_memory_pool_t tx_pool;
+static radioTX_t tx_entries[RADIO_QUEUE_SIZE];
+static msg_t tx_mb_buffer[RADIO_QUEUE_SIZE];
+static mailbox_t tx_mb;
 
-	// Southkorea 144.620 MHz
-	if(isPointInSouthkorea(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_SOUTHKOREA;
+/**
+  * Initializes the message buffer pool and the transmit queue
+  */
+void initRadio(void) {
+	chGuardedPoolObjectInit(&msg_pool, RADIO_MSG_BUFFER_SIZE);
+	chGuardedPoolLoadArray(&msg_pool, msg_buffers, RADIO_MSG_BUFFERS);
+	chSemObjectInit(&image_sem, RADIO_MSG_BUFFERS - RADIO_MSG_RESERVED);
+	chGuardedPoolObjectInit(&tx_pool, sizeof(radioTX_t));
+	chGuardedPoolLoadArray(&tx_pool, tx_entries, RADIO_QUEUE_SIZE);
+	chMBObjectInit(&tx_mb, tx_mb_buffer, RADIO_QUEUE_SIZE);
+}
 
-	// Southkorea 144.620 MHz
-	if(isPointInSoutheastAsia(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_SOUTHEASTASIA;
+/**
+  * Assigns a message buffer of the pool to the radio message (set priority
+  * first). Blocks until a buffer is available, image messages leave
+  * RADIO_MSG_RESERVED buffers to the others. Messages can point to an
+  * external buffer instead (set msg and msg_size).
+  */
+void radioAllocMSG(radioMSG_t *msg) {
+	if(msg->priority <= RADIO_PRIO_IMAGE)
+		chSemWait(&image_sem);
+	msg->msg = chGuardedPoolAllocTimeout(&msg_pool, TIME_INFINITE);
+	msg->msg_size = RADIO_MSG_BUFFER_SIZE;
+	msg->bin_len = 0;
+}
 
-	// Australia 145.175 MHz
-	if(isPointInAustralia(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_AUSTRALIA;
+/**
+  * Like radioAllocMSG() but returns false instead of blocking if no buffer
+  * is available
+  */
+bool radioTryAllocMSG(radioMSG_t *msg) {
+	if(msg->priority <= RADIO_PRIO_IMAGE && chSemWaitTimeout(&image_sem, TIME_IMMEDIATE) != MSG_OK)
+		return false;
+	msg->msg = chGuardedPoolAllocTimeout(&msg_pool, TIME_IMMEDIATE);
+	if(!msg->msg) {
+		if(msg->priority <= RADIO_PRIO_IMAGE)
+			chSemSignal(&image_sem);
+		return false;
+	}
+	msg->msg_size = RADIO_MSG_BUFFER_SIZE;
+	msg->bin_len = 0;
+	return true;
+}
 
-	// Australia 144.525 MHz
-	if(isPointInNewZealand(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_NEWZEALAND;
+static bool isPoolBuffer(uint8_t *buffer) {
+	return buffer >= &msg_buffers[0][0] && buffer < &msg_buffers[0][0] + sizeof(msg_buffers);
+}
 
-	// Argentina/Paraguay/Uruguay 144.930 MHz
-	if(isPointInArgentina(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_ARGENTINA;
+/**
+  * Returns the message buffer to the pool
+  */
+void radioFreeMSG(radioMSG_t *msg) {
+	if(isPoolBuffer(msg->msg)) {
+		chGuardedPoolFree(&msg_pool, msg->msg);
+		if(msg->priority <= RADIO_PRIO_IMAGE)
+			chSemSignal(&image_sem);
+	}
+	msg->msg = NULL;
+	msg->msg_size = 0;
+}
 
-	// Brazil 145.575 MHz
-	if(isPointInBrazil(point->gps_lat, point->gps_lon))
-		freq = APRS_FREQ_BRAZIL;
+/**
+  * Queues a message for the radio thread. Messages in a pool buffer are
+  * handed over to the radio thread (the buffer is freed after transmission)
+  * and the function returns immediately. Messages in external buffers are
+  * transmitted before the function returns.
+  * Returns false if the message couldn't be transmitted (external buffers
+  * only, queued messages always return true).
+  */
+bool transmitOnRadio(radioMSG_t *msg) {
+	if(!msg->bin_len) { // Nothing to transmit (e.g. encoding failed)
+		radioFreeMSG(msg);
+		return false;
+	}
 
-	return freq;
-}
-uint32_t getAPRSRegionFrequency70cm(void) {
-	return 432500000;
+	bool pooled = isPoolBuffer(msg->msg);
+	binary_semaphore_t done;
+	bool sent = false;
+
+	radioTX_t *tx = chGuardedPoolAllocTimeout(&tx_pool, TIME_INFINITE);
+	tx->msg = *msg;
+	if(pooled) {
+		tx->done = NULL;
+		tx->sent = NULL;
+		msg->msg = NULL; // Buffer belongs to the radio thread now
+		msg->msg_size = 0;
+	} else {
+		chBSemObjectInit(&done, true);
+		tx->done = &done;
+		tx->sent = &sent;
+	}
+
+	chMBPost(&tx_mb, (msg_t)tx, TIME_INFINITE);
+
+	if(pooled)
+		return true;
+
+	chBSemWait(&done);
+	return sent;
 }
-uint32_t getAPRSISSFrequency(void) {
-	return 145825000;
+
+/**
+  * Returns the radio for the frequency or 0 if no radio is available
+  */
+static radio_t getRadio(uint32_t freq) {
+	if(inRadio1band(freq))
+		return RADIO_2M;
+	if(inRadio2band(freq))
+		return RADIO_70CM;
+	return 0;
 }
 
+static radioStats_t stats[RADIO_PRIO_POSITION+1];	// Indexed by message priority
+static uint64_t setup_st[RADIO_PRIO_POSITION+1];	// Setup time in system ticks
+static uint64_t saved_st[RADIO_PRIO_POSITION+1];	// Saved setup time in system ticks
+static uint64_t air_st[RADIO_PRIO_POSITION+1];		// Sending time in system ticks
+static systime_t cold_setup[3];						// Last full initialization time, indexed by radio
+
 /**
-  * Sends radio message into message box. This method will return false if message box is full.
+  * Accounts the time spent on setting up the radio before a message. Messages
+  * sent on a running radio are credited with the time the last full
+  * initialization of this radio took.
   */
-bool transmitOnRadio(radioMSG_t *msg) {
-	// Lock radio
-	chMtxLock(&radio_mtx);
-
-	// Determine suitable radio
-	radio_t radio = 0;
-	if(inRadio1band(msg->freq)) {
-		radio = RADIO_2M;
-	} else if(inRadio2band(msg->freq)) {
-		radio = RADIO_70CM;
+static void countSetup(radioMSG_t *msg, radio_t radio, bool cold, bool tuned, systime_t setup) {
+	uint8_t p = msg->priority <= RADIO_PRIO_POSITION ? msg->priority : 0;
+
+	chSysLock();
+	stats[p].frames++;
+	setup_st[p] += setup;
+	if(cold) {
+		stats[p].cold_starts++;
+		cold_setup[radio] = setup;
+	} else {
+		if(!tuned)
+			stats[p].retunes++;
+		if(cold_setup[radio] > setup)
+			saved_st[p] += cold_setup[radio] - setup;
 	}
+	stats[p].setup_ms = setup_st[p] * 1000 / CH_CFG_ST_FREQUENCY;
+	stats[p].saved_ms = saved_st[p] * 1000 / CH_CFG_ST_FREQUENCY;
+	chSysUnlock();
+}
+
+static void countAir(radioMSG_t *msg, systime_t air) {
+	uint8_t p = msg->priority <= RADIO_PRIO_POSITION ? msg->priority : 0;
 
-	if(radio) { // Radio found
+	chSysLock();
+	air_st[p] += air;
+	stats[p].air_ms = air_st[p] * 1000 / CH_CFG_ST_FREQUENCY;
+	chSysUnlock();
+}
+
+/**
+  * Returns the radio setup counters of messages with the given priority
+  */
+void radioGetStats(uint8_t priority, radioStats_t *st) {
+	chSysLock();
+	*st = stats[priority <= RADIO_PRIO_POSITION ? priority : 0];
+	chSysUnlock();
+}
 
-		// Lock interference mutex
-		chMtxLock(&interference_mtx);
+/**
+  * Transmits a message, the radio is left running
+  */
+static bool transmit(radioMSG_t *msg) {
+	radio_t radio = getRadio(msg->freq);
 
-		TRACE_INFO(	"RAD  > Transmit radio %d, %d.%03d MHz, %d dBm (%d), %s, %d bits",
-					radio, msg->freq/1000000, (msg->freq%1000000)/1000, msg->power,
+	if(!radio) {
+		TRACE_ERROR("RAD  > No radio available for this frequency, %d.%03d MHz, %d dBm (%d), %s, %d bits",
+					msg->freq/1000000, (msg->freq%1000000)/1000, msg->power,
 					dBm2powerLvl(msg->power), VAL2MOULATION(msg->mod), msg->bin_len
 		);
-		
+		return false;
+	}
+
+	// Lock interference mutex
+	chMtxLock(&interference_mtx);
+
+	TRACE_INFO(	"RAD  > Transmit radio %d, %d.%03d MHz, %d dBm (%d), %s, %d bits",
+				radio, msg->freq/1000000, (msg->freq%1000000)/1000, msg->power,
+				dBm2powerLvl(msg->power), VAL2MOULATION(msg->mod), msg->bin_len
+	);
+
+	// Initialize and tune radio, skipped if it's still running with this configuration
+	uint16_t shift = msg->mod == MOD_2FSK ? msg->fsk_config->shift : 0;
+	bool tuned = isRadioTuned(radio, msg->mod, msg->freq, shift, msg->power);
+	bool cold = !isRadioInitialized(radio);
+	systime_t setup = chVTGetSystemTimeX();
+
+	if(!tuned) {
 		switch(msg->mod) {
 			case MOD_2FSK:
-				if(!isRadioInitialized(radio))
-					init2FSK(radio, msg);
-				send2FSK(radio, msg);
+				init2FSK(radio, msg);
 				break;
 			case MOD_2GFSK:
-				send2GFSK(radio, msg);
+				init2GFSK(radio, msg);
 				break;
 			case MOD_AFSK:
-				if(!isRadioInitialized(radio))
-					initAFSK(radio, msg);
-				sendAFSK(radio, msg);
+				initAFSK(radio, msg);
 				break;
 			case MOD_OOK:
-				if(!isRadioInitialized(radio))
-					initOOK(radio, msg);
-				sendOOK(radio, msg);
+				initOOK(radio, msg);
 				break;
 			case MOD_DOMINOEX16:
-				TRACE_ERROR("RAD  > Unimplemented modulation DominoEX16"); // TODO: Implement this
 				break;
 		}
+	}
+	countSetup(msg, radio, cold, tuned, chVTGetSystemTimeX() - setup);
 
-		radioShutdown(radio); // Shutdown radio for reinitialization
-		chMtxUnlock(&interference_mtx); // Heavy interference finished (HF)
-
-	} else { // Error
+	systime_t air = chVTGetSystemTimeX();
+	switch(msg->mod) {
+		case MOD_2FSK:
+			send2FSK(radio, msg);
+			break;
+		case MOD_2GFSK:
+			send2GFSK(radio, msg);
+			break;
+		case MOD_AFSK:
+			sendAFSK(radio, msg);
+			break;
+		case MOD_OOK:
+			sendOOK(radio, msg);
+			break;
+		case MOD_DOMINOEX16:
+			TRACE_ERROR("RAD  > Unimplemented modulation DominoEX16"); // TODO: Implement this
+			break;
+	}
+	countAir(msg, chVTGetSystemTimeX() - air);
 
-		TRACE_ERROR("RAD  > No radio available for this frequency, %d.%03d MHz, %d dBm (%d), %s, %d bits",
-					radio, msg->freq/1000000, (msg->freq%1000000)/1000, msg->power,
-					dBm2powerLvl(msg->power), VAL2MOULATION(msg->mod), msg->bin_len
-		);
+	chMtxUnlock(&interference_mtx); // Heavy interference finished (HF)
+	return true;
+}
 
+/**
+  * Removes the next message to be transmitted from the pending list. That is
+  * the oldest message of the highest priority. Messages which missed their
+  * deadline are dropped.
+  */
+static radioTX_t* selectNext(radioTX_t **pending, uint8_t *cnt) {
+	uint8_t n = 0;
+
+	// Drop expired messages, arrival order kept
+	for(uint8_t i=0; i<*cnt; i++) {
+		radioTX_t *tx = pending[i];
+		if(tx->msg.deadline && (int32_t)(chVTGetSystemTimeX() - tx->msg.deadline) > 0) {
+			TRACE_WARN("RAD  > Message dropped, deadline missed by %d ms", ST2MS(chVTGetSystemTimeX() - tx->msg.deadline));
+			radioFreeMSG(&tx->msg);
+			if(tx->done) {
+				*tx->sent = false;
+				chBSemSignal(tx->done);
+			}
+			chGuardedPoolFree(&tx_pool, tx);
+			continue;
+		}
+		pending[n++] = tx;
+	}
+	if(!n) {
+		*cnt = 0;
+		return NULL;
 	}
 
-	// Unlock radio
-	chMtxUnlock(&radio_mtx);
+	// First (oldest) message of the highest priority
+	uint8_t best = 0;
+	for(uint8_t i=1; i<n; i++)
+		if(pending[i]->msg.priority > pending[best]->msg.priority)
+			best = i;
 
-	return true;
+	radioTX_t *next = pending[best];
+	for(uint8_t i=best; i+1<n; i++)
+		pending[i] = pending[i+1];
+
+	*cnt = n - 1;
+	return next;
+}
+
+/**
+  * Radio thread. Transmits the queued messages by priority. The radio is kept
+  * running (hot) as long as queued messages use the same band, transmit()
+  * only reprograms the settings which changed.
+  */
+THD_FUNCTION(moduleRADIO, arg) {
+	(void)arg;
+
+	radioTX_t *pending[RADIO_QUEUE_SIZE];
+	uint8_t cnt = 0;
+	radio_t hot = 0;	// Radio left running after the last message
+
+	while(true)
+	{
+		// Collect queued messages, wait if there is nothing to do. A running
+		// radio waits a moment for the next message of a producer which is
+		// still encoding it. The carrier is stopped meanwhile, only the
+		// tuning is kept.
+		if(hot && !cnt) {
+			chMtxLock(&radio_mtx);
+			stopTx(hot);
+			chMtxUnlock(&radio_mtx);
+		}
+		msg_t m;
+		while(chMBFetch(&tx_mb, &m, cnt ? TIME_IMMEDIATE : hot ? MS2ST(RADIO_HOT_TIMEOUT) : TIME_INFINITE) == MSG_OK)
+			pending[cnt++] = (radioTX_t*)m;
+
+		radioTX_t *tx = selectNext(pending, &cnt);
+
+		// Shutdown radio if it isn't needed anymore or the next message uses the other band
+		if(hot && (!tx || getRadio(tx->msg.freq) != hot)) {
+			radioShutdown(hot);
+			hot = 0;
+		}
+		if(!tx)
+			continue;
+
+		// Transmit
+		chMtxLock(&radio_mtx);
+		bool sent = transmit(&tx->msg);
+		chMtxUnlock(&radio_mtx);
+
+		hot = getRadio(tx->msg.freq);
+
+		// Release message
+		radioFreeMSG(&tx->msg);
+		if(tx->done) {
+			*tx->sent = sent;
+			chBSemSignal(tx->done);
+		}
+		chGuardedPoolFree(&tx_pool, tx);
+	}
 }
 
 uint32_t getFrequency(freuquency_config_t *config)
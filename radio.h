@@ -24,12 +24,44 @@
 #define APRS_FREQ_ARGENTINA			144930000
 #define APRS_FREQ_BRAZIL			145575000
 
+// Radio message buffer pool and transmit queue
+#define RADIO_MSG_BUFFERS			4		/* Number of pooled message buffers */
+#define RADIO_MSG_BUFFER_SIZE		1024	/* Size of a pooled message buffer in bytes */
+#define RADIO_MSG_RESERVED			1		/* Pooled buffers not available to image messages */
+#define RADIO_QUEUE_SIZE			8		/* Max. number of queued messages */
+#define RADIO_HOT_TIMEOUT			50		/* Time in ms a running radio waits for the next message before it's shut down */
+
+// Transmit priorities (higher values are transmitted first)
+#define RADIO_PRIO_IMAGE			1
+#define RADIO_PRIO_LOG				2
+#define RADIO_PRIO_ERROR			3
+#define RADIO_PRIO_POSITION			4
+
+/**
+  * Radio setup counters. Setup is the dead air between queuing and the first
+  * bit of a message spent on powering up and tuning the radio. Air is the
+  * time spent on sending the messages.
+  */
+typedef struct {
+	uint32_t frames;		// Messages transmitted
+	uint32_t cold_starts;	// Messages which required a full radio initialization
+	uint32_t retunes;		// Messages which reprogrammed a running radio
+	uint32_t setup_ms;		// Time spent on setting up the radio
+	uint32_t saved_ms;		// Setup time saved by sending on a running radio
+	uint32_t air_ms;		// Time spent on sending
+} radioStats_t;
+
 extern mutex_t radio_mtx;
 
 uint32_t getAPRSRegionFrequency2m(void);
 uint32_t getAPRSRegionFrequency70cm(void);
 uint32_t getAPRSISSFrequency(void);
 bool transmitOnRadio(radioMSG_t *msg);
+void initRadio(void);
+void radioAllocMSG(radioMSG_t *msg);
+bool radioTryAllocMSG(radioMSG_t *msg);
+void radioFreeMSG(radioMSG_t *msg);
+void radioGetStats(uint8_t priority, radioStats_t *st);
 uint32_t getFrequency(freuquency_config_t *config);
 
 THD_FUNCTION(moduleRADIO, arg);
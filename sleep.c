@@ -5,31 +5,48 @@
 #include "tracking.h"
 #include "debug.h"
 #include "padc.h"
+#include "geofence.h"
 
 /**
-  * Sleeping method. Returns true if sleeping condition are given.
+  * Sleeping method. Returns true if sleeping condition are given. The
+  * conditions are evaluated on the last track point (voltages, PAC1720
+  * averages of the last cycle, position), the ADC is only sampled if
+  * moduleTRACKING hasn't measured yet.
   */
 bool p_sleep(const sleep_config_t *config)
 {
+	trackPoint_t *point = getLastTrackPoint();
+	bool measured = point->adc_battery != 0;
+
 	switch(config->type)
 	{
 		case SLEEP_WHEN_VBAT_BELOW_THRES:
-			return getBatteryVoltageMV() < config->vbat_thres;
+			return (measured ? point->adc_battery : getBatteryVoltageMV()) < config->vbat_thres;
 
 		case SLEEP_WHEN_VSOL_BELOW_THRES:
-			return getSolarVoltageMV() < config->vsol_thres;
+			return (measured ? point->adc_solar : getSolarVoltageMV()) < config->vsol_thres;
 
 		case SLEEP_WHEN_VBAT_ABOVE_THRES:
-			return getBatteryVoltageMV() > config->vbat_thres;
+			return (measured ? point->adc_battery : getBatteryVoltageMV()) > config->vbat_thres;
 
 		case SLEEP_WHEN_VSOL_ABOVE_THRES:
-			return getSolarVoltageMV() > config->vsol_thres;
+			return (measured ? point->adc_solar : getSolarVoltageMV()) > config->vsol_thres;
 
 		case SLEEP_WHEN_DISCHARGING:
+			return point->adc_discharge > point->adc_charge;
+
 		case SLEEP_WHEN_CHARGING:
+			return point->adc_charge > point->adc_discharge;
+
 		case SLEEP_WHEN_INSIDE_ITU1:
+			return getLayerRegionCached(LAYER_ITU, point) == REGION_ITU1;
+
 		case SLEEP_WHEN_INSIDE_ITU2:
+			return getLayerRegionCached(LAYER_ITU, point) == REGION_ITU2;
+
 		case SLEEP_WHEN_INSIDE_ITU3:
+			return getLayerRegionCached(LAYER_ITU, point) == REGION_ITU3;
+
 		case SLEEP_WHEN_SAT_NOT_VIS:
 			TRACE_WARN("Sleeping method not implemented");
 			return false;
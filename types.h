@@ -90,15 +90,18 @@ typedef struct {
 } afsk_config_t;
 
 typedef struct {
-	uint8_t dummy; // Not used yet
+	uint32_t speed; // Data rate in bps (0: 9600)
 } gfsk_config_t;
 
 typedef struct { // Radio message type
-	uint8_t 		msg[512];		// Message (data)
+	uint8_t*		msg;			// Message (data), pool buffer (see radioAllocMSG) or external buffer
+	uint32_t		msg_size;		// Size of msg in bytes
 	uint32_t		bin_len;		// Binary length
 	uint32_t		freq;			// Frequency
 	int8_t			power;			// Power in dBm
 	mod_t			mod;			// Modulation
+	uint8_t			priority;		// Transmit priority (RADIO_PRIO_*)
+	systime_t		deadline;		// Latest start of transmission, dropped afterwards (0: none)
 
 	ook_config_t*	ook_config;		// OOK config
 	fsk_config_t*	fsk_config;		// 2FSK config
@@ -118,10 +121,20 @@ typedef enum {
 typedef struct {
 	char callsign[8];		// Callsign
 	resolution_t res;		// Camera resolution
-	uint8_t quality;		// JPEG quality
+	uint8_t quality;		// JPEG quality 1..100 (0: chosen by imgctrl)
+	uint8_t fill;			// Target buffer fill in percent (0: 80%)
+	uint16_t packets;		// Target number of SSDV packets per image (0: no limit)
 	uint8_t *ram_buffer;	// Camera Buffer (do not set in config)
 	size_t ram_size;		// Size of buffer (do not set in config)
 	bool no_camera;			// Camera disabled
+	bool stream;			// Encode while capturing (ram_buffer used as ring buffer)
+	uint8_t qs;				// OV2640 quantization scale of the capture (do not set in config)
+	uint16_t complexity;	// Size statistics of the last images, see imgctrl.h (do not set in config)
+	uint8_t *hist_buffer;	// Buffer of the images kept for resending, see imgsched.h (NULL: no resending)
+	size_t hist_size;		// Size of the history buffer
+	uint8_t interleave;		// New packets between two resent packets (0: IMGSCHED_INTERLEAVE)
+	uint16_t resend;		// Early packets resent per pass (0: no early pass, e.g. IMGSCHED_EARLY)
+	struct imgsched *sched;	// Resend scheduler (do not set in config)
 } ssdv_config_t;
 
 typedef enum {